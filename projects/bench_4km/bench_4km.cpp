@@ -0,0 +1,356 @@
+//
+// bench_4km - throughput-benchmark for baking, saving and loading '.4km' asset-bundles,
+// using procedurally generated models (see model_generator.hpp). CPU-only, no Vulkan device required.
+// optional measurements:
+// - concurrent loading, while bundles are saved into the same archive ('--contention-readers')
+// - decoding textures on 1, 2, 4, ... threads ('--decode-textures')
+// - reading zip-entries with small and large records, seeking back after large reads ('--zip-stream-mb')
+// - baking models concurrently on 1, 2, 4, ... jobs, optionally within a memory-budget ('--bake-models')
+// - loading and migrating bundles of the oldest supported schema-version ('--check-schema')
+// - bulk-serialization in binary archives ('--archive-elements')
+// - scene-json loading with sparse and dense nodes, streamed and as DOM, time and peak memory ('--scene-nodes')
+// scenarios are implemented in bench_scenario.cpp, optional measurements in bench_<name>.cpp (see benchmarks.hpp).
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <map>
+#include <span>
+#include <thread>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <crocore/ThreadPoolClassic.hpp>
+#include <cxxopts.hpp>
+#include <spdlog/spdlog.h>
+
+#include "bench_scenario.hpp"
+#include "benchmarks.hpp"
+
+//! predefined scenarios: entries, vertices per entry, textures, texture-size, animations, skinning
+static const std::map<std::string, model_params_t> g_presets = {
+        {"small", {16, 1024, 4, 256, 0, false}},      {"medium", {256, 4096, 16, 1024, 0, false}},
+        {"large", {1024, 16384, 32, 2048, 0, false}}, {"many_entries", {8192, 256, 1, 256, 0, false}},
+        {"animated", {64, 4096, 4, 512, 16, true}}};
+
+static int process_id()
+{
+#if defined(_WIN32)
+    return _getpid();
+#else
+    return getpid();
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    cxxopts::Options options(argv[0], "benchmark baking, saving and loading of '.4km' asset-bundles\n");
+    // clang-format off
+    options.add_options()
+        ("p,preset", "scenario-presets (small, medium, large, many_entries, animated)", cxxopts::value<std::vector<std::string>>()->default_value("small,medium"))
+        ("entries", "custom scenario: number of mesh-entries", cxxopts::value<uint32_t>())
+        ("vertices", "custom scenario: vertices per entry", cxxopts::value<uint32_t>()->default_value("4096"))
+        ("textures", "custom scenario: number of textures", cxxopts::value<uint32_t>()->default_value("4"))
+        ("texture-size", "custom scenario: texture-resolution in px", cxxopts::value<uint32_t>()->default_value("512"))
+        ("animations", "custom scenario: number of animations", cxxopts::value<uint32_t>()->default_value("0"))
+        ("skinning", "custom scenario: skinned entries")
+        ("texture-codec", "codecs for uncompressed textures, each scenario runs per codec (png, qoi, zstd)", cxxopts::value<std::vector<std::string>>()->default_value("qoi"))
+        ("geometry-codec", "codecs for geometry, each scenario runs per codec (meshopt, zstd)", cxxopts::value<std::vector<std::string>>()->default_value("meshopt"))
+        ("c,compress", "block-compress (BC7/BC5) textures while baking")
+        ("lods", "generate level-of-detail meshes")
+        ("meshlets", "generate meshlets")
+        ("scene-nodes", "measure loading scene-json with this many sparse and dense nodes (0: skip)", cxxopts::value<uint32_t>()->default_value("0"))
+        ("contention-readers", "measure bundle-loads from this many threads, while another thread saves bundles (0: skip)", cxxopts::value<uint32_t>()->default_value("0"))
+        ("decode-textures", "measure decoding this many textures ('texture-size') for 1, 2, 4, ... threads (0: skip)", cxxopts::value<uint32_t>()->default_value("0"))
+        ("zip-stream-mb", "measure reading zstd-compressed and stored zip-entries of this size in MiB (0: skip)", cxxopts::value<uint32_t>()->default_value("0"))
+        ("bake-models", "measure baking this many models ('entries' or first preset) on 1, 2, 4, ... jobs (0: skip)", cxxopts::value<uint32_t>()->default_value("0"))
+        ("J,jobs", "maximum number of concurrent bake-jobs for 'bake-models' (default: threads / 4)", cxxopts::value<uint32_t>())
+        ("max-memory", "estimated memory-budget in MiB for concurrent bake-jobs, as in cache_4km (0: unlimited)", cxxopts::value<uint64_t>()->default_value("0"))
+        ("check-schema", "check loading and migrating a bundle written with the oldest supported schema-version")
+        ("archive-elements", "compare bulk- and element-wise binary serialization of this many glm::vec3 (0: skip)", cxxopts::value<uint32_t>()->default_value("0"))
+        ("i,iterations", "iterations per scenario, the fastest one is reported", cxxopts::value<uint32_t>()->default_value("3"))
+        ("j,threads", "number of worker-threads", cxxopts::value<uint32_t>())
+        ("work-dir", "parent-directory for generated models and bundles, written into a new 'bench_4km.<pid>' subdirectory (default: <tmp>)", cxxopts::value<std::string>())
+        ("o,output", "write results as json", cxxopts::value<std::string>())
+        ("baseline", "compare against a previously written json-report", cxxopts::value<std::string>())
+        ("max-regression", "fail, if an operation is slower than the baseline by more than this percentage (0: never fail)", cxxopts::value<double>()->default_value("0"))
+        ("v,verbose", "verbose logging")
+        ("h,help", "print this help message");
+    // clang-format on
+
+    cxxopts::ParseResult result;
+    try
+    {
+        result = options.parse(argc, argv);
+    } catch(const std::exception &e)
+    {
+        spdlog::error(e.what());
+        return EXIT_FAILURE;
+    }
+
+    if(result.count("help"))
+    {
+        spdlog::set_pattern("%v");
+        spdlog::info("\n{}", options.help());
+        return EXIT_SUCCESS;
+    }
+    spdlog::set_level(result.count("verbose") ? spdlog::level::debug : spdlog::level::info);
+
+    // scenarios: custom parameters or presets
+    std::vector<std::pair<std::string, model_params_t>> scenarios;
+    if(result.count("entries"))
+    {
+        model_params_t params;
+        params.num_entries = result["entries"].as<uint32_t>();
+        params.num_vertices = result["vertices"].as<uint32_t>();
+        params.num_textures = result["textures"].as<uint32_t>();
+        params.texture_size = result["texture-size"].as<uint32_t>();
+        params.num_animations = result["animations"].as<uint32_t>();
+        params.skinning = result.count("skinning") > 0;
+        scenarios.emplace_back("custom", params);
+    }
+    else
+    {
+        for(const auto &preset: result["preset"].as<std::vector<std::string>>())
+        {
+            auto it = g_presets.find(preset);
+            if(it == g_presets.end())
+            {
+                spdlog::error("unknown preset '{}'", preset);
+                return EXIT_FAILURE;
+            }
+            scenarios.emplace_back(*it);
+        }
+    }
+
+    const auto texture_codecs = result["texture-codec"].as<std::vector<std::string>>();
+    for(const auto &codec: texture_codecs)
+    {
+        if(!g_texture_codecs.contains(codec))
+        {
+            spdlog::error("unknown texture-codec '{}'", codec);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto geometry_codecs = result["geometry-codec"].as<std::vector<std::string>>();
+    for(const auto &codec: geometry_codecs)
+    {
+        auto it = g_geometry_codecs.find(codec);
+        if(it == g_geometry_codecs.end())
+        {
+            spdlog::error("unknown geometry-codec '{}'", codec);
+            return EXIT_FAILURE;
+        }
+        if(!vierkant_cereal::geometry_codec_supported(it->second))
+        {
+            spdlog::error("geometry-codec '{}' not supported in this build", codec);
+            return EXIT_FAILURE;
+        }
+    }
+
+    uint32_t num_threads =
+            result.count("threads") ? result["threads"].as<uint32_t>() : std::thread::hardware_concurrency();
+    crocore::ThreadPoolClassic pool(num_threads);
+
+    // bake-parameters mirror cache_4km
+    vierkant_cereal::bundle_params_t bundle_params = {};
+    bundle_params.mesh_buffer_params.optimize_vertex_cache = true;
+    bundle_params.mesh_buffer_params.pack_vertices = true;
+    bundle_params.mesh_buffer_params.generate_lods = result.count("lods") > 0;
+    bundle_params.mesh_buffer_params.generate_meshlets = result.count("meshlets") > 0;
+    bundle_params.compress_textures = result.count("compress") > 0;
+    bundle_params.pool = &pool;
+
+    // generated files go into a dedicated subdirectory, created here and the only one removed afterwards.
+    // it's left behind on failure, for inspection
+    std::filesystem::path work_dir = std::filesystem::temp_directory_path();
+    if(result.count("work-dir")) { work_dir = result["work-dir"].as<std::string>(); }
+    work_dir /= std::format("bench_4km.{}", process_id());
+    std::error_code ec;
+    if(!std::filesystem::create_directories(work_dir, ec))
+    {
+        spdlog::error("could not create work-directory '{}': {}", work_dir.string(),
+                      ec ? ec.message() : "exists already");
+        return EXIT_FAILURE;
+    }
+
+    bench_report_t report;
+    report.num_threads = num_threads;
+    report.num_iterations = std::max<uint32_t>(result["iterations"].as<uint32_t>(), 1);
+    report.compress_textures = bundle_params.compress_textures;
+
+    for(const auto &[name, params]: scenarios)
+    {
+        try
+        {
+            spdlog::info("{}: {} entries x {} vertices, {} textures ({}px), {} animations, skinning: {}", name,
+                         params.num_entries, params.num_vertices, params.num_textures, params.texture_size,
+                         params.num_animations, params.skinning);
+            for(const auto &texture_codec: texture_codecs)
+            {
+                auto first = report.scenarios.size();
+                for(const auto &geometry_codec: geometry_codecs)
+                {
+                    auto scenario = run_scenario(name, params, texture_codec, geometry_codec, work_dir,
+                                                 report.num_iterations, bundle_params, &pool);
+                    spdlog::info("{} ({}, {}): bake {:.1f} MB/s ({:.0f} entries/s) - save {:.1f} MB/s - "
+                                 "load {:.1f} MB/s - zip save {:.1f} MB/s - zip load {:.1f} MB/s - "
+                                 "geometry load {:.3f}s - bundle {:.2f} MB",
+                                 name, texture_codec, geometry_codec, scenario.bake.mb_per_s,
+                                 scenario.bake.entries_per_s, scenario.save.mb_per_s, scenario.load.mb_per_s,
+                                 scenario.save_zip.mb_per_s, scenario.load_zip.mb_per_s,
+                                 scenario.load_geometry.seconds, scenario.bundle_bytes / (1024.0 * 1024.0));
+                    report.scenarios.push_back(std::move(scenario));
+                }
+
+                // other geometry-codecs relative to zstd-only
+                std::span<const scenario_result_t> runs(report.scenarios.begin() + first, report.scenarios.end());
+                auto zstd_it = std::ranges::find(runs, std::string("zstd"), &scenario_result_t::geometry_codec);
+                if(zstd_it == runs.end()) { continue; }
+                for(const auto &scenario: runs)
+                {
+                    if(&scenario == &*zstd_it) { continue; }
+                    spdlog::info("{} ({}, {} vs. zstd): bundle {:.2f} MB vs. {:.2f} MB ({:+.1f}%) - "
+                                 "geometry load {:.3f}s vs. {:.3f}s ({:+.1f}%)",
+                                 name, texture_codec, scenario.geometry_codec,
+                                 scenario.bundle_bytes / (1024.0 * 1024.0), zstd_it->bundle_bytes / (1024.0 * 1024.0),
+                                 (double(scenario.bundle_bytes) / zstd_it->bundle_bytes - 1.0) * 100.0,
+                                 scenario.load_geometry.seconds, zstd_it->load_geometry.seconds,
+                                 (scenario.load_geometry.seconds / zstd_it->load_geometry.seconds - 1.0) * 100.0);
+                }
+            }
+        } catch(const std::exception &e)
+        {
+            spdlog::error("{}: {}", name, e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(auto num_readers = result["contention-readers"].as<uint32_t>())
+    {
+        try
+        {
+            run_contention_benchmark(num_readers, g_presets.at("small"), work_dir, report.num_iterations,
+                                     bundle_params);
+        } catch(const std::exception &e)
+        {
+            spdlog::error("contention: {}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+    if(auto num_textures = result["decode-textures"].as<uint32_t>())
+    {
+        try
+        {
+            run_decode_benchmark(num_textures, result["texture-size"].as<uint32_t>(), num_threads,
+                                 report.num_iterations);
+        } catch(const std::exception &e)
+        {
+            spdlog::error("decode: {}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(auto num_megabytes = result["zip-stream-mb"].as<uint32_t>())
+    {
+        try
+        {
+            run_zip_stream_benchmark(num_megabytes, work_dir, report.num_iterations);
+        } catch(const std::exception &e)
+        {
+            spdlog::error("zip-stream: {}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+    if(auto num_models = result["bake-models"].as<uint32_t>())
+    {
+        try
+        {
+            uint32_t max_jobs = result.count("jobs") ? result["jobs"].as<uint32_t>() : num_threads / 4;
+            run_jobs_benchmark(num_models, max_jobs, result["max-memory"].as<uint64_t>() << 20,
+                               scenarios.front().second, work_dir, report.num_iterations, bundle_params);
+        } catch(const std::exception &e)
+        {
+            spdlog::error("jobs: {}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+    if(result.count("check-schema"))
+    {
+        try
+        {
+            run_schema_check(g_presets.at("small"), work_dir, bundle_params);
+        } catch(const std::exception &e)
+        {
+            spdlog::error("schema: {}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+    std::filesystem::remove_all(work_dir, ec);
+
+    if(auto num_elements = result["archive-elements"].as<uint32_t>())
+    {
+        try
+        {
+            run_archive_benchmark(num_elements, report.num_iterations);
+        } catch(const std::exception &e)
+        {
+            spdlog::error("archive: {}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(auto num_nodes = result["scene-nodes"].as<uint32_t>())
+    {
+        try
+        {
+            run_scene_benchmark(num_nodes, report.num_iterations);
+        } catch(const std::exception &e)
+        {
+            spdlog::error("scene: {}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(result.count("output"))
+    {
+        std::ofstream ofs(result["output"].as<std::string>());
+        cereal::JSONOutputArchive archive(ofs);
+        archive(cereal::make_nvp("bench_4km", report));
+    }
+
+    if(result.count("baseline"))
+    {
+        bench_report_t baseline;
+        try
+        {
+            std::ifstream ifs(result["baseline"].as<std::string>());
+            cereal::JSONInputArchive archive(ifs);
+            archive(cereal::make_nvp("bench_4km", baseline));
+        } catch(const std::exception &e)
+        {
+            spdlog::error("could not read baseline '{}': {}", result["baseline"].as<std::string>(), e.what());
+            return EXIT_FAILURE;
+        }
+        if(baseline.version != bench_report_t::current_version)
+        {
+            spdlog::error("baseline has version {}, expected {}", baseline.version, bench_report_t::current_version);
+            return EXIT_FAILURE;
+        }
+        if(!compare_to_baseline(report, baseline, result["max-regression"].as<double>() / 100.0))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
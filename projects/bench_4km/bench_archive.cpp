@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/vector.hpp>
+#include <spdlog/spdlog.h>
+#include <spdlog/stopwatch.h>
+
+#include <vierkant_cereal/glm_cereal.hpp>
+
+#include "benchmarks.hpp"
+
+void run_archive_benchmark(size_t num_elements, uint32_t num_iterations)
+{
+    std::vector<glm::vec3> positions(num_elements);
+    for(size_t i = 0; i < num_elements; ++i) { positions[i] = glm::vec3(i, 2 * i, 3 * i) * 0.5f; }
+    const uint64_t num_bytes = num_elements * sizeof(glm::vec3);
+
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    double save_bulk_s = inf, save_elements_s = inf, load_bulk_s = inf, load_elements_s = inf;
+    std::string bulk_bytes, element_bytes;
+
+    for(uint32_t i = 0; i < num_iterations; ++i)
+    {
+        std::ostringstream bulk_stream, element_stream;
+        spdlog::stopwatch sw;
+        {
+            cereal::BinaryOutputArchive archive(bulk_stream);
+            archive(positions);
+        }
+        save_bulk_s = std::min(save_bulk_s, sw.elapsed().count());
+
+        sw.reset();
+        {
+            cereal::BinaryOutputArchive archive(element_stream);
+            archive(cereal::make_size_tag(static_cast<cereal::size_type>(positions.size())));
+            for(const auto &p: positions) { archive(p); }
+        }
+        save_elements_s = std::min(save_elements_s, sw.elapsed().count());
+        bulk_bytes = std::move(bulk_stream).str();
+        element_bytes = std::move(element_stream).str();
+        if(bulk_bytes != element_bytes) { throw std::runtime_error("bulk- and element-wise serialization differ"); }
+
+        std::vector<glm::vec3> loaded;
+        std::istringstream bulk_in(bulk_bytes), element_in(element_bytes);
+        sw.reset();
+        {
+            cereal::BinaryInputArchive archive(bulk_in);
+            archive(loaded);
+        }
+        load_bulk_s = std::min(load_bulk_s, sw.elapsed().count());
+        if(loaded != positions) { throw std::runtime_error("bulk-deserialization failed"); }
+
+        sw.reset();
+        {
+            cereal::BinaryInputArchive archive(element_in);
+            cereal::size_type size;
+            archive(cereal::make_size_tag(size));
+            loaded.resize(size);
+            for(auto &p: loaded) { archive(p); }
+        }
+        load_elements_s = std::min(load_elements_s, sw.elapsed().count());
+        if(loaded != positions) { throw std::runtime_error("element-wise deserialization failed"); }
+    }
+
+    auto save_bulk = throughput(save_bulk_s, num_bytes, 1), save_elements = throughput(save_elements_s, num_bytes, 1);
+    auto load_bulk = throughput(load_bulk_s, num_bytes, 1), load_elements = throughput(load_elements_s, num_bytes, 1);
+    spdlog::info("archive: {} x glm::vec3 - save {:.1f} MB/s (element-wise {:.1f} MB/s, x{:.1f}) - "
+                 "load {:.1f} MB/s (element-wise {:.1f} MB/s, x{:.1f})",
+                 num_elements, save_bulk.mb_per_s, save_elements.mb_per_s, save_elements_s / save_bulk_s,
+                 load_bulk.mb_per_s, load_elements.mb_per_s, load_elements_s / load_bulk_s);
+}
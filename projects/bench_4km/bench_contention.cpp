@@ -0,0 +1,105 @@
+#include <atomic>
+#include <format>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/stopwatch.h>
+
+#include "benchmarks.hpp"
+
+void run_contention_benchmark(uint32_t num_readers, const model_params_t &params, const std::filesystem::path &work_dir,
+                              uint32_t num_iterations, const vierkant_cereal::bundle_params_t &bundle_params)
+{
+    constexpr uint32_t num_bundles = 8;
+    constexpr uint32_t loads_per_reader = 32;
+
+    auto model_path = generate_model(work_dir / "models" / "contention", "contention", params);
+    auto assets = vierkant_cereal::create_model_bundle(model_path, bundle_params);
+    if(!assets) { throw std::runtime_error("baking failed: " + model_path.string()); }
+
+    auto zip_path = work_dir / "contention.zip";
+    std::vector<std::filesystem::path> zip_bundles, plain_bundles;
+    for(uint32_t i = 0; i < num_bundles; ++i)
+    {
+        auto filename = std::format("contention_{}.{}", i, vierkant_cereal::bundle_file_suffix);
+        zip_bundles.push_back(work_dir / "zip" / filename);
+        plain_bundles.push_back(work_dir / "bundles" / filename);
+        vierkant_cereal::save_bundle_file(*assets, zip_bundles.back(), zip_path);
+        vierkant_cereal::save_bundle_file(*assets, plain_bundles.back());
+    }
+
+    //! emulates the former process-wide g_bundle_rw_mutex
+    std::shared_mutex global_mutex;
+
+    struct phase_result_t
+    {
+        double loads_per_s = 0.0;
+        uint32_t num_commits = 0;
+    };
+
+    auto run_phase = [&](bool writer, bool global_lock) {
+        std::atomic<bool> readers_done = false, failed = false;
+        std::atomic<uint32_t> num_commits = 0;
+
+        std::thread writer_thread;
+        if(writer)
+        {
+            writer_thread = std::thread([&] {
+                auto path = work_dir / "zip" / std::format("contention_writer.{}", vierkant_cereal::bundle_file_suffix);
+                while(!readers_done)
+                {
+                    std::unique_lock lock(global_mutex, std::defer_lock);
+                    if(global_lock) { lock.lock(); }
+                    vierkant_cereal::save_bundle_file(*assets, path, zip_path);
+                    num_commits++;
+                }
+            });
+        }
+
+        spdlog::stopwatch sw;
+        std::vector<std::thread> readers;
+        for(uint32_t r = 0; r < num_readers; ++r)
+        {
+            readers.emplace_back([&, r] {
+                for(uint32_t i = 0; i < loads_per_reader && !failed; ++i)
+                {
+                    bool from_zip = (r + i) % 2;
+                    const auto &path = (from_zip ? zip_bundles : plain_bundles)[(r + i) % num_bundles];
+
+                    std::shared_lock lock(global_mutex, std::defer_lock);
+                    if(global_lock) { lock.lock(); }
+                    auto zip_archive = from_zip ? std::optional(zip_path) : std::nullopt;
+                    if(!vierkant_cereal::load_model_bundle_file(path, zip_archive)) { failed = true; }
+                }
+            });
+        }
+        for(auto &t: readers) { t.join(); }
+        double seconds = sw.elapsed().count();
+        readers_done = true;
+        if(writer_thread.joinable()) { writer_thread.join(); }
+        if(failed) { throw std::runtime_error("loading failed during contention-benchmark"); }
+
+        phase_result_t ret;
+        ret.loads_per_s = seconds > 0.0 ? num_readers * loads_per_reader / seconds : 0.0;
+        ret.num_commits = num_commits;
+        return ret;
+    };
+
+    phase_result_t idle, snapshot, global;
+    for(uint32_t i = 0; i < num_iterations; ++i)
+    {
+        auto best = [](phase_result_t &a, const phase_result_t &b) {
+            if(b.loads_per_s > a.loads_per_s) { a = b; }
+        };
+        best(idle, run_phase(false, false));
+        best(snapshot, run_phase(true, false));
+        best(global, run_phase(true, true));
+    }
+    spdlog::info("contention: {} readers - idle {:.0f} loads/s - with writer: per-archive {:.0f} loads/s "
+                 "({} commits), global lock {:.0f} loads/s ({} commits)",
+                 num_readers, idle.loads_per_s, snapshot.loads_per_s, snapshot.num_commits, global.loads_per_s,
+                 global.num_commits);
+}
@@ -0,0 +1,48 @@
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <crocore/ThreadPoolClassic.hpp>
+#include <spdlog/spdlog.h>
+#include <spdlog/stopwatch.h>
+
+#include <vierkant_cereal/deferred_image_decoder.hpp>
+
+#include "benchmarks.hpp"
+
+void run_decode_benchmark(uint32_t num_textures, uint32_t texture_size, uint32_t max_threads, uint32_t num_iterations)
+{
+    std::vector<std::shared_ptr<crocore::Image_<uint8_t>>> images(num_textures);
+    std::vector<std::vector<uint8_t>> payloads(num_textures);
+    for(uint32_t i = 0; i < num_textures; ++i)
+    {
+        images[i] = std::dynamic_pointer_cast<crocore::Image_<uint8_t>>(generate_texture(texture_size, i));
+        payloads[i] = vierkant_cereal::encode_texture(*images[i], vierkant_cereal::default_texture_codec);
+    }
+
+    // 1, 2, 4, ... threads, up to 'max_threads'
+    std::vector<uint32_t> thread_counts;
+    for(uint32_t n = 1; n < max_threads; n *= 2) { thread_counts.push_back(n); }
+    thread_counts.push_back(std::max<uint32_t>(max_threads, 1));
+
+    double single_thread_s = 0.0;
+    for(auto num_threads: thread_counts)
+    {
+        crocore::ThreadPoolClassic pool(num_threads);
+        double decode_s = std::numeric_limits<double>::infinity();
+
+        for(uint32_t i = 0; i < num_iterations; ++i)
+        {
+            // decoded images replace the source-images, with identical content
+            vierkant_cereal::deferred_image_decoder decoder;
+            for(uint32_t t = 0; t < num_textures; ++t) { decoder.push(images[t].get(), payloads[t]); }
+            spdlog::stopwatch sw;
+            decoder.run(&pool);
+            decode_s = std::min(decode_s, sw.elapsed().count());
+        }
+        if(num_threads == 1) { single_thread_s = decode_s; }
+        spdlog::info("decode: {} textures ({}px) - {} threads: {:.3f}s ({:.0f} textures/s, x{:.1f})", num_textures,
+                     texture_size, num_threads, decode_s, num_textures / decode_s, single_thread_s / decode_s);
+    }
+}
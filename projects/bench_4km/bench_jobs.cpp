@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/stopwatch.h>
+
+#include <vierkant_cereal/bake_memory.hpp>
+
+#include "benchmarks.hpp"
+#include "memory_sampler.hpp"
+
+void run_jobs_benchmark(uint32_t num_models, uint32_t max_jobs, uint64_t max_memory, const model_params_t &params,
+                        const std::filesystem::path &work_dir, uint32_t num_iterations,
+                        const vierkant_cereal::bundle_params_t &bundle_params)
+{
+    std::vector<std::filesystem::path> model_paths;
+    for(uint32_t i = 0; i < num_models; ++i)
+    {
+        auto name = std::format("jobs_{}", i);
+        model_paths.push_back(generate_model(work_dir / "models" / name, name, params));
+    }
+    const uint64_t job_memory = vierkant_cereal::estimate_bake_memory(model_paths.front());
+
+    // 1, 2, 4, ... jobs, up to 'max_jobs'
+    std::vector<uint32_t> job_counts;
+    for(uint32_t n = 1; n < max_jobs; n *= 2) { job_counts.push_back(n); }
+    job_counts.push_back(std::max<uint32_t>(max_jobs, 1));
+
+    double single_job_s = 0.0;
+    for(auto num_jobs: job_counts)
+    {
+        double bake_s = std::numeric_limits<double>::infinity();
+        uint64_t peak_rss = 0;
+        uint32_t max_in_flight = 0;
+
+        for(uint32_t iteration = 0; iteration < num_iterations; ++iteration)
+        {
+            // same admission as cache_4km
+            vierkant_cereal::memory_budget_t memory_budget(max_memory);
+            std::mutex mutex;
+            uint32_t in_flight = 0;
+
+            std::atomic<uint32_t> next_model = 0;
+            std::atomic<bool> failed = false;
+
+            auto job_fn = [&] {
+                for(uint32_t i = next_model++; i < num_models && !failed; i = next_model++)
+                {
+                    memory_budget.acquire(job_memory);
+                    {
+                        std::lock_guard lock(mutex);
+                        max_in_flight = std::max(max_in_flight, ++in_flight);
+                    }
+                    auto assets = vierkant_cereal::create_model_bundle(model_paths[i], bundle_params);
+                    if(assets)
+                    {
+                        auto bundle_path = work_dir / "bundles" /
+                                           std::format("jobs_{}.{}", i, vierkant_cereal::bundle_file_suffix);
+                        vierkant_cereal::save_bundle_file(*assets, bundle_path);
+                    }
+                    else { failed = true; }
+                    {
+                        std::lock_guard lock(mutex);
+                        in_flight--;
+                    }
+                    memory_budget.release(job_memory);
+                }
+            };
+
+            memory_sampler sampler;
+            spdlog::stopwatch sw;
+            std::vector<std::thread> job_threads;
+            for(uint32_t j = 1; j < num_jobs; ++j) { job_threads.emplace_back(job_fn); }
+            job_fn();
+            for(auto &t: job_threads) { t.join(); }
+            bake_s = std::min(bake_s, sw.elapsed().count());
+            peak_rss = std::max(peak_rss, sampler.peak());
+            if(failed) { throw std::runtime_error("baking failed during jobs-benchmark"); }
+        }
+        if(num_jobs == 1) { single_job_s = bake_s; }
+        spdlog::info("jobs: {} models - {} jobs: {:.3f}s ({:.2f} models/s, x{:.1f}) - max. in flight: {} - "
+                     "peak RSS {:.1f} MB",
+                     num_models, num_jobs, bake_s, num_models / bake_s, single_job_s / bake_s, max_in_flight,
+                     peak_rss / (1024.0 * 1024.0));
+    }
+}
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <limits>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/stopwatch.h>
+
+#include <vierkant_cereal/bake_memory.hpp>
+
+#include "bench_scenario.hpp"
+
+scenario_result_t run_scenario(const std::string &name, const model_params_t &params, const std::string &texture_codec,
+                               const std::string &geometry_codec, const std::filesystem::path &work_dir,
+                               uint32_t num_iterations, const vierkant_cereal::bundle_params_t &bundle_params,
+                               crocore::ThreadPoolClassic *pool)
+{
+    scenario_result_t ret;
+    ret.name = name;
+    ret.params = params;
+    ret.texture_codec = texture_codec;
+    ret.geometry_codec = geometry_codec;
+    auto codec = g_texture_codecs.at(texture_codec);
+    auto geom_codec = g_geometry_codecs.at(geometry_codec);
+
+    auto model_path = generate_model(work_dir / "models" / name, name, params);
+    ret.input_bytes = vierkant_cereal::model_files_size(model_path);
+
+    // the zip-entry never exists as plain file, so loads are served from the archive
+    auto bundle_path = work_dir / "bundles" / (name + "." + vierkant_cereal::bundle_file_suffix);
+    auto zip_path = work_dir / "bench.zip";
+    auto zip_bundle_path = work_dir / "zip" / (name + "." + vierkant_cereal::bundle_file_suffix);
+
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    double bake_s = inf, save_s = inf, load_s = inf, save_zip_s = inf, load_zip_s = inf, load_geometry_s = inf;
+
+    for(uint32_t i = 0; i < num_iterations; ++i)
+    {
+        spdlog::stopwatch sw;
+        auto assets = vierkant_cereal::create_model_bundle(model_path, bundle_params);
+        bake_s = std::min(bake_s, sw.elapsed().count());
+        if(!assets) { throw std::runtime_error("baking failed: " + model_path.string()); }
+
+        std::error_code ec;
+        std::filesystem::remove(bundle_path, ec);
+        sw.reset();
+        vierkant_cereal::save_bundle_file(*assets, bundle_path, {}, codec, geom_codec);
+        save_s = std::min(save_s, sw.elapsed().count());
+        ret.bundle_bytes = std::filesystem::file_size(bundle_path);
+
+        sw.reset();
+        if(!vierkant_cereal::load_model_bundle_file(bundle_path, {}, vierkant_cereal::all_bundle_sections, pool))
+        {
+            throw std::runtime_error("loading failed: " + bundle_path.string());
+        }
+        load_s = std::min(load_s, sw.elapsed().count());
+
+        sw.reset();
+        auto geometry_section = vierkant_cereal::bundle_section_bit(vierkant_cereal::bundle_section_t::Geometry);
+        if(!vierkant_cereal::load_model_bundle_file(bundle_path, {}, geometry_section, pool))
+        {
+            throw std::runtime_error("loading geometry failed: " + bundle_path.string());
+        }
+        load_geometry_s = std::min(load_geometry_s, sw.elapsed().count());
+
+        sw.reset();
+        vierkant_cereal::save_bundle_file(*assets, zip_bundle_path, zip_path, codec, geom_codec);
+        save_zip_s = std::min(save_zip_s, sw.elapsed().count());
+
+        sw.reset();
+        if(!vierkant_cereal::load_model_bundle_file(zip_bundle_path, zip_path, vierkant_cereal::all_bundle_sections,
+                                                    pool))
+        {
+            throw std::runtime_error("loading failed: " + zip_bundle_path.string() + " from " + zip_path.string());
+        }
+        load_zip_s = std::min(load_zip_s, sw.elapsed().count());
+    }
+
+    ret.bake = throughput(bake_s, ret.input_bytes, params.num_entries);
+    ret.save = throughput(save_s, ret.bundle_bytes, params.num_entries);
+    ret.load = throughput(load_s, ret.bundle_bytes, params.num_entries);
+    ret.save_zip = throughput(save_zip_s, ret.bundle_bytes, params.num_entries);
+    ret.load_zip = throughput(load_zip_s, ret.bundle_bytes, params.num_entries);
+    ret.load_geometry = throughput(load_geometry_s, ret.bundle_bytes, params.num_entries);
+    return ret;
+}
+
+bool compare_to_baseline(const bench_report_t &report, const bench_report_t &baseline, double max_regression)
+{
+    bool ret = true;
+    for(const auto &scenario: report.scenarios)
+    {
+        auto it = std::ranges::find_if(baseline.scenarios, [&scenario](const auto &s) {
+            return s.name == scenario.name && s.texture_codec == scenario.texture_codec &&
+                   s.geometry_codec == scenario.geometry_codec;
+        });
+        if(it == baseline.scenarios.end())
+        {
+            spdlog::info("{} ({}, {}): not contained in baseline", scenario.name, scenario.texture_codec,
+                         scenario.geometry_codec);
+            continue;
+        }
+
+        const std::pair<const char *, const throughput_t *> current[] = {
+                {"bake", &scenario.bake},         {"save", &scenario.save},
+                {"load", &scenario.load},         {"save_zip", &scenario.save_zip},
+                {"load_zip", &scenario.load_zip}, {"load_geometry", &scenario.load_geometry}};
+        const throughput_t *base[] = {&it->bake,     &it->save,     &it->load,
+                                      &it->save_zip, &it->load_zip, &it->load_geometry};
+
+        for(size_t i = 0; i < std::size(current); ++i)
+        {
+            if(base[i]->seconds <= 0.0) { continue; }
+            double ratio = current[i].second->seconds / base[i]->seconds;
+            bool regressed = max_regression > 0.0 && ratio > 1.0 + max_regression;
+            ret = ret && !regressed;
+            spdlog::log(regressed ? spdlog::level::warn : spdlog::level::info,
+                        "{} ({}, {}) - {}: {:.3f}s vs. baseline {:.3f}s ({:+.1f}%)", scenario.name,
+                        scenario.texture_codec, scenario.geometry_codec, current[i].first,
+                        current[i].second->seconds, base[i]->seconds, (ratio - 1.0) * 100.0);
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <crocore/ThreadPoolClassic.hpp>
+
+#include "benchmarks.hpp"
+
+//! results for a single scenario
+struct scenario_result_t
+{
+    std::string name;
+    model_params_t params;
+
+    //! codec for uncompressed textures (see g_texture_codecs)
+    std::string texture_codec = "qoi";
+
+    //! codec for geometry (see g_geometry_codecs)
+    std::string geometry_codec = "meshopt";
+
+    //! bytes of the generated model-files (.gltf, .bin, textures) and of the baked bundle
+    uint64_t input_bytes = 0;
+    uint64_t bundle_bytes = 0;
+
+    //! 'bake' is measured against input-bytes, all others against bundle-bytes
+    throughput_t bake, save, load, save_zip, load_zip;
+
+    //! loading and decoding only the geometry-section
+    throughput_t load_geometry;
+
+    template<class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(cereal::make_nvp("name", name), cereal::make_nvp("params", params),
+                cereal::make_optional_nvp("texture_codec", texture_codec, "qoi"),
+                cereal::make_optional_nvp("geometry_codec", geometry_codec, "meshopt"),
+                cereal::make_nvp("input_bytes", input_bytes), cereal::make_nvp("bundle_bytes", bundle_bytes),
+                cereal::make_nvp("bake", bake), cereal::make_nvp("save", save), cereal::make_nvp("load", load),
+                cereal::make_nvp("save_zip", save_zip), cereal::make_nvp("load_zip", load_zip),
+                cereal::make_optional_nvp("load_geometry", load_geometry));
+    }
+};
+
+struct bench_report_t
+{
+    //! report-format version, bumped on incompatible changes
+    static constexpr uint32_t current_version = 1;
+
+    uint32_t version = current_version;
+    uint32_t num_threads = 0;
+    uint32_t num_iterations = 0;
+    bool compress_textures = false;
+    std::vector<scenario_result_t> scenarios;
+
+    template<class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(cereal::make_nvp("version", version), cereal::make_nvp("num_threads", num_threads),
+                cereal::make_nvp("num_iterations", num_iterations),
+                cereal::make_nvp("compress_textures", compress_textures), cereal::make_nvp("scenarios", scenarios));
+    }
+};
+
+//! selectable codecs for uncompressed textures, as in cache_4km
+inline const std::map<std::string, vierkant_cereal::texture_codec_t> g_texture_codecs = {
+        {"png", vierkant_cereal::texture_codec_t::Png},
+        {"qoi", vierkant_cereal::texture_codec_t::Qoi},
+        {"zstd", vierkant_cereal::texture_codec_t::RawZstd}};
+
+//! selectable codecs for geometry, as in cache_4km
+inline const std::map<std::string, vierkant_cereal::geometry_codec_t> g_geometry_codecs = {
+        {"meshopt", vierkant_cereal::geometry_codec_t::Meshopt}, {"zstd", vierkant_cereal::geometry_codec_t::Zstd}};
+
+/**
+ * @brief   'run_scenario' generates a model and measures bake, save and load (plain files and zip-archive),
+ *          with textures stored by 'texture_codec' (see g_texture_codecs) and geometry by 'geometry_codec'
+ *          (see g_geometry_codecs). throws std::runtime_error if any step fails.
+ */
+scenario_result_t run_scenario(const std::string &name, const model_params_t &params, const std::string &texture_codec,
+                               const std::string &geometry_codec, const std::filesystem::path &work_dir,
+                               uint32_t num_iterations, const vierkant_cereal::bundle_params_t &bundle_params,
+                               crocore::ThreadPoolClassic *pool);
+
+/**
+ * @brief   'compare_to_baseline' logs relative timings against a baseline-report.
+ *
+ * @return  false, if any operation is slower than the baseline by more than 'max_regression' (fraction)
+ */
+bool compare_to_baseline(const bench_report_t &report, const bench_report_t &baseline, double max_regression);
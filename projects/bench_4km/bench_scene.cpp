@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include <cereal/archives/json.hpp>
+#include <spdlog/spdlog.h>
+#include <spdlog/stopwatch.h>
+
+#include <vierkant_cereal/scene_cereal.hpp>
+
+#include "benchmarks.hpp"
+#include "memory_sampler.hpp"
+
+void run_scene_benchmark(uint32_t num_nodes, uint32_t num_iterations)
+{
+    // binary tree of nodes
+    scene_data_t scene_data;
+    scene_data.nodes.resize(num_nodes);
+    std::string sparse_json = R"({"value0":{"model_paths":[],"nodes":[)";
+
+    for(uint32_t i = 0; i < num_nodes; ++i)
+    {
+        auto &node = scene_data.nodes[i];
+        node.name = "node_" + std::to_string(i);
+        for(uint32_t c = 2 * i + 1; c <= 2 * i + 2 && c < num_nodes; ++c) { node.children.push_back(c); }
+
+        sparse_json += (i ? R"(,{"name":")" : R"({"name":")") + node.name + R"(","children":[)";
+        for(size_t c = 0; c < node.children.size(); ++c)
+        {
+            sparse_json += (c ? "," : "") + std::to_string(node.children[c]);
+        }
+        sparse_json += "]}";
+    }
+    sparse_json += num_nodes ? R"(],"scene_roots":[0]}})" : R"(],"scene_roots":[]}})";
+    if(num_nodes) { scene_data.scene_roots = {0}; }
+
+    std::ostringstream dense_stream;
+    vierkant_cereal::save_scene_data(dense_stream, scene_data);
+
+    const std::pair<const char *, std::string> scenes[] = {{"sparse", std::move(sparse_json)},
+                                                           {"dense", std::move(dense_stream).str()}};
+    for(const auto &[name, json]: scenes)
+    {
+        constexpr double inf = std::numeric_limits<double>::infinity();
+        double load_s = inf, dom_s = inf;
+        uint64_t load_peak = 0, dom_peak = 0;
+
+        for(uint32_t i = 0; i < num_iterations; ++i)
+        {
+            // input-copies are allocated before sampling, results are released within
+            std::istringstream is(json), dom_is(json);
+            trim_heap();
+            {
+                memory_sampler sampler;
+                spdlog::stopwatch sw;
+                auto loaded = vierkant_cereal::load_scene_data(is);
+                load_s = std::min(load_s, sw.elapsed().count());
+                load_peak = std::max(load_peak, sampler.peak_growth());
+                if(!loaded || loaded->nodes.size() != num_nodes)
+                {
+                    throw std::runtime_error(std::string("loading failed: ") + name);
+                }
+            }
+            trim_heap();
+
+            // reference: whole document parsed into a DOM
+            {
+                memory_sampler sampler;
+                spdlog::stopwatch sw;
+                scene_data_t dom_loaded;
+                cereal::JSONInputArchive archive(dom_is);
+                archive(dom_loaded);
+                dom_s = std::min(dom_s, sw.elapsed().count());
+                dom_peak = std::max(dom_peak, sampler.peak_growth());
+                if(dom_loaded.nodes.size() != num_nodes)
+                {
+                    throw std::runtime_error(std::string("dom failed: ") + name);
+                }
+            }
+            trim_heap();
+        }
+        auto load = throughput(load_s, json.size(), num_nodes);
+        spdlog::info("scene ({}): {} nodes - load {:.3f}s - {:.1f} MB/s ({:.0f} nodes/s) - peak RSS +{:.1f} MB - "
+                     "dom {:.3f}s - peak RSS +{:.1f} MB",
+                     name, num_nodes, load_s, load.mb_per_s, load.entries_per_s, load_peak / (1024.0 * 1024.0), dom_s,
+                     dom_peak / (1024.0 * 1024.0));
+    }
+}
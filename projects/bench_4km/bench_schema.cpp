@@ -0,0 +1,76 @@
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <vierkant_cereal/bundle_manifest.hpp>
+#include <vierkant_cereal/bundle_migration.hpp>
+#include <vierkant_cereal/texture_store.hpp>
+
+#include "benchmarks.hpp"
+
+//! ids of materials, textures and referenced textures, which have to survive all schema-versions
+static std::vector<std::string> asset_ids(const vierkant::model::model_assets_t &assets)
+{
+    std::vector<std::string> ret;
+    for(const auto &material: assets.materials) { ret.push_back(material.id.str()); }
+    for(const auto &[id, texture]: assets.textures) { ret.push_back(id.str()); }
+    for(const auto &id: vierkant_cereal::texture_store::referenced_ids(assets)) { ret.push_back(id.str()); }
+    return ret;
+}
+
+void run_schema_check(const model_params_t &params, const std::filesystem::path &work_dir,
+                      const vierkant_cereal::bundle_params_t &bundle_params)
+{
+    constexpr uint32_t min_version = vierkant_cereal::min_bundle_schema_version;
+    constexpr uint32_t current_version = vierkant_cereal::bundle_schema_version;
+    if(min_version == current_version)
+    {
+        spdlog::info("schema: no older schema-version supported, skipped");
+        return;
+    }
+
+    auto model_path = generate_model(work_dir / "models" / "schema", "schema", params);
+    auto assets = vierkant_cereal::create_model_bundle(model_path, bundle_params);
+    if(!assets) { throw std::runtime_error("baking failed: " + model_path.string()); }
+    const auto expected_ids = asset_ids(*assets);
+
+    // written with the layout of the oldest supported schema-version
+    auto bundle_dir = work_dir / "schema";
+    auto bundle_path = bundle_dir / std::format("schema.{}", vierkant_cereal::bundle_file_suffix);
+    {
+        vierkant_cereal::bundle_schema_scope_t schema_scope(min_version);
+        vierkant_cereal::save_bundle_file(*assets, bundle_path);
+    }
+    if(vierkant_cereal::load_bundle_schema_version(bundle_path) != min_version)
+    {
+        throw std::runtime_error(std::format("bundle not written with schema-version {}", min_version));
+    }
+
+    auto check_loaded = [&](uint32_t schema_version) {
+        auto loaded = vierkant_cereal::load_model_bundle_file(bundle_path, {}, vierkant_cereal::all_bundle_sections,
+                                                              bundle_params.pool);
+        if(!loaded) { throw std::runtime_error(std::format("loading schema-version {} failed", schema_version)); }
+        if(asset_ids(*loaded) != expected_ids)
+        {
+            throw std::runtime_error(std::format("ids differ after loading schema-version {}", schema_version));
+        }
+    };
+    check_loaded(min_version);
+
+    // upgraded in place, like cache_4km's '--migrate'
+    vierkant_cereal::bundle_manifest manifest(bundle_dir / vierkant_cereal::bundle_manifest::default_filename);
+    vierkant_cereal::bundle_migration_params_t migration_params = {};
+    migration_params.bundle_dir = bundle_dir;
+    migration_params.pool = bundle_params.pool;
+    auto migration_result = vierkant_cereal::migrate_bundles(manifest, migration_params);
+    if(migration_result.num_migrated != 1 ||
+       vierkant_cereal::load_bundle_schema_version(bundle_path) != current_version)
+    {
+        throw std::runtime_error(std::format("migration to schema-version {} failed", current_version));
+    }
+    check_loaded(current_version);
+    spdlog::info("schema: bundle with schema-version {} loaded and migrated to {}", min_version, current_version);
+}
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/stopwatch.h>
+
+#include <vierkant_cereal/ziparchive.h>
+
+#include "benchmarks.hpp"
+
+/**
+ * @brief   'check_zip_stream_seek' verifies seeking back after a large read, which bypasses the stream-buffer.
+ *          throws std::runtime_error if the bytes read after seeking don't match 'data'.
+ */
+static void check_zip_stream_seek(const vierkant::ziparchive &archive, const char *entry,
+                                  const std::vector<uint8_t> &data)
+{
+    constexpr size_t buffer_size = 4096, small_read = 64, large_read = 16 * buffer_size, num_check = 16;
+    if(data.size() < small_read + large_read) { return; }
+
+    auto is = archive.open_file(entry, buffer_size);
+    std::vector<char> record(large_read);
+    is.read(record.data(), small_read);
+    is.read(record.data(), large_read);
+
+    // within the range of the large read, but also of a stale buffer
+    const size_t offset = small_read + large_read - num_check;
+    is.seekg(static_cast<std::streamoff>(offset));
+    is.read(record.data(), num_check);
+    if(!is || std::memcmp(record.data(), data.data() + offset, num_check) != 0)
+    {
+        throw std::runtime_error(std::string("wrong bytes after seeking back: ") + entry);
+    }
+}
+
+void run_zip_stream_benchmark(uint32_t num_megabytes, const std::filesystem::path &work_dir, uint32_t num_iterations)
+{
+    // partially compressible: pseudo-random first halves, repeated second halves of 4KiB-blocks
+    std::vector<uint8_t> data(size_t(num_megabytes) << 20);
+    std::mt19937 rng(0);
+    for(size_t i = 0; i < data.size(); ++i) { data[i] = (i & 4095) < 2048 ? uint8_t(rng()) : uint8_t(i >> 12); }
+
+    auto zip_path = work_dir / "stream.zip";
+    std::filesystem::create_directories(work_dir);
+    {
+        vierkant::ziparchive archive(zip_path);
+        auto writer = [&data](std::ostream &os) {
+            os.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        };
+        archive.add_stream(writer, "zstd.bin");
+        archive.add_stream(writer, "stored.bin", std::nullopt);
+        archive.commit();
+    }
+
+    vierkant::ziparchive archive(zip_path);
+    std::vector<char> record;
+    for(const char *entry: {"zstd.bin", "stored.bin"})
+    {
+        check_zip_stream_seek(archive, entry, data);
+
+        for(size_t record_size: {size_t(64), size_t(1) << 20})
+        {
+            record.resize(record_size);
+            double read_s = std::numeric_limits<double>::infinity();
+
+            for(uint32_t i = 0; i < num_iterations; ++i)
+            {
+                spdlog::stopwatch sw;
+                auto is = archive.open_file(entry);
+                size_t num_read = 0;
+                while(is.read(record.data(), static_cast<std::streamsize>(record.size())) || is.gcount())
+                {
+                    num_read += static_cast<size_t>(is.gcount());
+                }
+                read_s = std::min(read_s, sw.elapsed().count());
+                if(num_read != data.size()) { throw std::runtime_error(std::string("short read: ") + entry); }
+            }
+            spdlog::info("zip-stream ({}): {} MiB in {} byte records - {:.1f} MB/s", entry, num_megabytes,
+                         record_size, throughput(read_s, data.size(), 1).mb_per_s);
+        }
+    }
+}
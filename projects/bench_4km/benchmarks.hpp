@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include <vierkant_cereal/vierkant_cereal.hpp>
+
+#include "model_generator.hpp"
+
+//! throughput of a benchmarked operation, best of all iterations
+struct throughput_t
+{
+    double seconds = 0.0;
+    double mb_per_s = 0.0;
+    double entries_per_s = 0.0;
+
+    template<class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(cereal::make_nvp("seconds", seconds), cereal::make_nvp("mb_per_s", mb_per_s),
+                cereal::make_nvp("entries_per_s", entries_per_s));
+    }
+};
+
+//! throughput of 'num_entries' and 'num_bytes', processed in 'seconds'
+inline throughput_t throughput(double seconds, uint64_t num_bytes, uint32_t num_entries)
+{
+    throughput_t ret;
+    ret.seconds = seconds;
+    if(seconds > 0.0)
+    {
+        ret.mb_per_s = static_cast<double>(num_bytes) / (1024.0 * 1024.0) / seconds;
+        ret.entries_per_s = num_entries / seconds;
+    }
+    return ret;
+}
+
+/**
+ * @brief   'run_contention_benchmark' measures bundle-loads from 'num_readers' threads, alternating between
+ *          archive-entries and plain files, while another thread keeps saving bundles into the same archive.
+ *          per-archive locking (readers use committed snapshots) is compared to a process-wide reader-writer lock,
+ *          as used before. bundles are baked from a model generated with 'params'.
+ *          throws std::runtime_error if any load fails.
+ */
+void run_contention_benchmark(uint32_t num_readers, const model_params_t &params, const std::filesystem::path &work_dir,
+                              uint32_t num_iterations, const vierkant_cereal::bundle_params_t &bundle_params);
+
+/**
+ * @brief   'run_decode_benchmark' measures decoding texture-payloads on thread-pools of increasing size,
+ *          isolated from reading and deserializing bundles (see deferred_image_decoder).
+ */
+void run_decode_benchmark(uint32_t num_textures, uint32_t texture_size, uint32_t max_threads, uint32_t num_iterations);
+
+/**
+ * @brief   'run_zip_stream_benchmark' measures reading zip-entries through ziparchive::istream with small and large
+ *          records, from a zstd-compressed and a stored entry. throws std::runtime_error on short reads
+ *          or wrong bytes after seeking (see check_zip_stream_seek).
+ */
+void run_zip_stream_benchmark(uint32_t num_megabytes, const std::filesystem::path &work_dir, uint32_t num_iterations);
+
+/**
+ * @brief   'run_jobs_benchmark' bakes and saves 'num_models' models concurrently, like cache_4km's '--jobs'.
+ *          1, 2, 4, ... jobs (up to 'max_jobs') share one thread-pool for their inner work. with 'max_memory' > 0,
+ *          jobs are only admitted while their estimated memory fits into it (see vierkant_cereal::memory_budget_t).
+ *          reports models/s, speedup and the sampled peak RSS per job-count. throws std::runtime_error on failure.
+ */
+void run_jobs_benchmark(uint32_t num_models, uint32_t max_jobs, uint64_t max_memory, const model_params_t &params,
+                        const std::filesystem::path &work_dir, uint32_t num_iterations,
+                        const vierkant_cereal::bundle_params_t &bundle_params);
+
+/**
+ * @brief   'run_schema_check' writes a bundle with the layout of the oldest supported schema-version, then loads it
+ *          through the compatibility-paths and migrates it to the current one (see bundle_schema.hpp).
+ *          throws std::runtime_error if the bundle can't be loaded or migrated, or ids change on the way.
+ */
+void run_schema_check(const model_params_t &params, const std::filesystem::path &work_dir,
+                      const vierkant_cereal::bundle_params_t &bundle_params);
+
+/**
+ * @brief   'run_archive_benchmark' compares bulk- and element-wise binary serialization of a std::vector<glm::vec3>.
+ *          throws std::runtime_error if both don't produce the same bytes.
+ */
+void run_archive_benchmark(size_t num_elements, uint32_t num_iterations);
+
+/**
+ * @brief   'run_scene_benchmark' measures loading scene-json with sparse nodes (only names and children, optional
+ *          fields absent) and with dense nodes (all fields present, as written by save_scene_data).
+ *          streamed loading (see read_scene_json) is compared to parsing the whole document into a DOM,
+ *          in time and peak memory-growth (resident set size, sampled, excluding the json-text itself).
+ *          throws std::runtime_error if a scene can't be loaded.
+ */
+void run_scene_benchmark(uint32_t num_nodes, uint32_t num_iterations);
@@ -0,0 +1,73 @@
+#include <fstream>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "memory_sampler.hpp"
+
+uint64_t current_rss_bytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) { return counters.WorkingSetSize; }
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info info = {};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) !=
+       KERN_SUCCESS)
+    {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    // total program-size and resident pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t num_pages = 0, num_resident = 0;
+    if(!(statm >> num_pages >> num_resident)) { return 0; }
+    return num_resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+void trim_heap()
+{
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+memory_sampler::memory_sampler(std::chrono::microseconds interval) : m_start(current_rss_bytes()), m_peak(m_start)
+{
+    m_thread = std::thread([this, interval] {
+        while(m_running)
+        {
+            sample();
+            std::this_thread::sleep_for(interval);
+        }
+    });
+}
+
+memory_sampler::~memory_sampler()
+{
+    m_running = false;
+    if(m_thread.joinable()) { m_thread.join(); }
+}
+
+void memory_sampler::sample()
+{
+    uint64_t rss = current_rss_bytes();
+    uint64_t peak = m_peak;
+    while(rss > peak && !m_peak.compare_exchange_weak(peak, rss)) {}
+}
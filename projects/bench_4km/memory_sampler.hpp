@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+//! current resident set size of the process in bytes, 0 if not available
+uint64_t current_rss_bytes();
+
+//! return freed heap-memory to the OS, where supported (glibc). otherwise memory retained by the allocator
+//! is reused by later allocations, hiding their growth from a subsequent memory_sampler.
+void trim_heap();
+
+/**
+ * @brief   memory_sampler samples the resident set size of the process on a background-thread,
+ *          between construction and destruction.
+ *
+ * unlike the process-wide high-water mark (getrusage), the peak is reset for each sampler,
+ * so consecutive measurements in one process don't hide each other.
+ */
+class memory_sampler
+{
+public:
+    explicit memory_sampler(std::chrono::microseconds interval = std::chrono::milliseconds(1));
+
+    ~memory_sampler();
+
+    memory_sampler(const memory_sampler &) = delete;
+    memory_sampler &operator=(const memory_sampler &) = delete;
+
+    //! peak resident set size in bytes, sampled so far
+    uint64_t peak() const { return m_peak; }
+
+    //! peak resident set size in bytes, above the size at construction
+    uint64_t peak_growth() const { return m_peak > m_start ? m_peak - m_start : 0; }
+
+private:
+    void sample();
+
+    uint64_t m_start = 0;
+    std::atomic<uint64_t> m_peak = 0;
+    std::atomic<bool> m_running = true;
+    std::thread m_thread;
+};
@@ -0,0 +1,514 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <cereal/archives/json.hpp>
+#include <crocore/Image.hpp>
+
+#include <vierkant_cereal/texture_codec.hpp>
+
+#include "model_generator.hpp"
+
+namespace rj = CEREAL_RAPIDJSON_NAMESPACE;
+
+// glTF enums
+constexpr uint32_t gl_float = 5126;
+constexpr uint32_t gl_unsigned_short = 5123;
+constexpr uint32_t gl_unsigned_int = 5125;
+constexpr uint32_t gl_array_buffer = 34962;
+constexpr uint32_t gl_element_array_buffer = 34963;
+
+constexpr uint32_t num_keyframes = 32;
+
+//! spacing of entries, placed on a grid
+constexpr float entry_spacing = 2.5f;
+constexpr uint32_t entries_per_row = 32;
+
+struct buffer_view_t
+{
+    size_t offset = 0;
+    size_t length = 0;
+    uint32_t target = 0;
+};
+
+struct accessor_t
+{
+    uint32_t view = 0;
+    uint32_t component_type = gl_float;
+    size_t count = 0;
+    const char *type = "SCALAR";
+    std::optional<std::pair<std::array<float, 3>, std::array<float, 3>>> bounds;
+};
+
+//! binary buffer, views and accessors of a glTF-model
+struct gltf_buffers_t
+{
+    std::vector<uint8_t> bin;
+    std::vector<buffer_view_t> views;
+    std::vector<accessor_t> accessors;
+
+    template<typename T>
+    uint32_t add(const std::vector<T> &data, uint32_t component_type, const char *type, size_t count,
+                 uint32_t target = 0)
+    {
+        bin.resize((bin.size() + 3) & ~size_t(3));
+        views.push_back({bin.size(), data.size() * sizeof(T), target});
+        bin.resize(bin.size() + views.back().length);
+        std::memcpy(bin.data() + views.back().offset, data.data(), views.back().length);
+        accessors.push_back({static_cast<uint32_t>(views.size() - 1), component_type, count, type, {}});
+        return static_cast<uint32_t>(accessors.size() - 1);
+    }
+};
+
+struct mesh_accessors_t
+{
+    uint32_t position = 0, normal = 0, tex_coord = 0, indices = 0;
+    std::optional<uint32_t> joints, weights;
+};
+
+//! a displaced grid, distinct per entry
+static mesh_accessors_t add_grid(gltf_buffers_t &buffers, uint32_t num_vertices, uint32_t entry, bool skinning)
+{
+    auto side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(num_vertices))));
+    side = std::max<uint32_t>(side, 2);
+    std::vector<float> positions, normals, tex_coords, weights;
+    std::vector<uint16_t> joints;
+    std::vector<uint32_t> indices;
+    std::array<float, 3> min = {1.f, 1.f, 1.f}, max = {-1.f, -1.f, -1.f};
+
+    float phase = static_cast<float>(entry) * 0.618f;
+    for(uint32_t y = 0; y < side; ++y)
+    {
+        for(uint32_t x = 0; x < side; ++x)
+        {
+            float u = static_cast<float>(x) / static_cast<float>(side - 1);
+            float v = static_cast<float>(y) / static_cast<float>(side - 1);
+            std::array<float, 3> p = {2.f * u - 1.f, 0.1f * std::sin(8.f * u + phase) * std::cos(8.f * v - phase),
+                                      2.f * v - 1.f};
+            for(uint32_t c = 0; c < 3; ++c)
+            {
+                min[c] = std::min(min[c], p[c]);
+                max[c] = std::max(max[c], p[c]);
+            }
+            positions.insert(positions.end(), p.begin(), p.end());
+            normals.insert(normals.end(), {0.f, 1.f, 0.f});
+            tex_coords.insert(tex_coords.end(), {u, v});
+
+            if(skinning)
+            {
+                joints.insert(joints.end(), {0, 1, 0, 0});
+                weights.insert(weights.end(), {1.f - v, v, 0.f, 0.f});
+            }
+        }
+    }
+
+    for(uint32_t y = 0; y + 1 < side; ++y)
+    {
+        for(uint32_t x = 0; x + 1 < side; ++x)
+        {
+            uint32_t i = y * side + x;
+            indices.insert(indices.end(), {i, i + side, i + 1, i + 1, i + side, i + side + 1});
+        }
+    }
+
+    size_t count = static_cast<size_t>(side) * side;
+    mesh_accessors_t ret;
+    ret.position = buffers.add(positions, gl_float, "VEC3", count, gl_array_buffer);
+    buffers.accessors.back().bounds = std::make_pair(min, max);
+    ret.normal = buffers.add(normals, gl_float, "VEC3", count, gl_array_buffer);
+    ret.tex_coord = buffers.add(tex_coords, gl_float, "VEC2", count, gl_array_buffer);
+    if(skinning)
+    {
+        ret.joints = buffers.add(joints, gl_unsigned_short, "VEC4", count, gl_array_buffer);
+        ret.weights = buffers.add(weights, gl_float, "VEC4", count, gl_array_buffer);
+    }
+    ret.indices = buffers.add(indices, gl_unsigned_int, "SCALAR", indices.size(), gl_element_array_buffer);
+    return ret;
+}
+
+crocore::ImagePtr generate_texture(uint32_t size, uint32_t index)
+{
+    std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4);
+    for(uint32_t y = 0; y < size; ++y)
+    {
+        for(uint32_t x = 0; x < size; ++x)
+        {
+            uint8_t *px = pixels.data() + (static_cast<size_t>(y) * size + x) * 4;
+            px[0] = static_cast<uint8_t>((x ^ y) + index * 37);
+            px[1] = static_cast<uint8_t>(255 * x / size);
+            px[2] = static_cast<uint8_t>(255 * y / size + index * 11);
+            px[3] = ((x / 32 + y / 32) % 2) ? 255 : 192;
+        }
+    }
+    return crocore::Image_<uint8_t>::create(pixels.data(), size, size, 4);
+}
+
+static void write_file(const std::filesystem::path &path, const void *data, size_t num_bytes)
+{
+    std::ofstream ofs(path, std::ios_base::out | std::ios_base::binary);
+    ofs.write(static_cast<const char *>(data), static_cast<std::streamsize>(num_bytes));
+    if(!ofs) { throw std::runtime_error("generate_model: could not write '" + path.string() + "'"); }
+}
+
+template<typename Writer>
+static void write_string(Writer &w, const std::string &str)
+{
+    w.String(str.c_str(), static_cast<rj::SizeType>(str.size()));
+}
+
+template<typename Writer, typename T>
+static void write_array(Writer &w, const T &values)
+{
+    w.StartArray();
+    for(auto v: values) { w.Double(v); }
+    w.EndArray();
+}
+
+std::filesystem::path generate_model(const std::filesystem::path &directory, const std::string &name,
+                                     const model_params_t &params)
+{
+    std::filesystem::create_directories(directory);
+
+    gltf_buffers_t buffers;
+    std::vector<mesh_accessors_t> meshes;
+    for(uint32_t i = 0; i < params.num_entries; ++i)
+    {
+        meshes.push_back(add_grid(buffers, params.num_vertices, i, params.skinning));
+    }
+
+    // two joints, the second one rotated by animations
+    const uint32_t num_joints = params.skinning ? 2 : 0;
+    std::optional<uint32_t> inverse_bind_matrices;
+    if(params.skinning)
+    {
+        std::vector<float> matrices;
+        for(uint32_t j = 0; j < num_joints; ++j)
+        {
+            matrices.insert(matrices.end(), {1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f,
+                                             -static_cast<float>(j), 0.f, 1.f});
+        }
+        inverse_bind_matrices = buffers.add(matrices, gl_float, "MAT4", num_joints);
+    }
+
+    std::vector<uint32_t> keyframe_times, keyframe_rotations;
+    for(uint32_t a = 0; a < params.num_animations; ++a)
+    {
+        std::vector<float> times, rotations;
+        for(uint32_t k = 0; k < num_keyframes; ++k)
+        {
+            float t = static_cast<float>(k) / static_cast<float>(num_keyframes - 1);
+            float angle = 3.14159265f * t * static_cast<float>(a + 1);
+            times.push_back(t);
+            rotations.insert(rotations.end(), {0.f, std::sin(angle / 2.f), 0.f, std::cos(angle / 2.f)});
+        }
+        keyframe_times.push_back(buffers.add(times, gl_float, "SCALAR", num_keyframes));
+        buffers.accessors.back().bounds =
+                std::make_pair(std::array<float, 3>{0.f, 0.f, 0.f}, std::array<float, 3>{1.f, 0.f, 0.f});
+        keyframe_rotations.push_back(buffers.add(rotations, gl_float, "VEC4", num_keyframes));
+    }
+
+    // textures
+    for(uint32_t i = 0; i < params.num_textures; ++i)
+    {
+        auto img = std::dynamic_pointer_cast<crocore::Image_<uint8_t>>(generate_texture(params.texture_size, i));
+        auto png = vierkant_cereal::encode_texture(*img, vierkant_cereal::texture_codec_t::Png);
+        write_file(directory / std::format("{}_{}.png", name, i), png.data(), png.size());
+    }
+    write_file(directory / (name + ".bin"), buffers.bin.data(), buffers.bin.size());
+
+    rj::StringBuffer json;
+    rj::PrettyWriter<rj::StringBuffer> w(json);
+    w.StartObject();
+
+    w.Key("asset");
+    w.StartObject();
+    w.Key("version");
+    w.String("2.0");
+    w.Key("generator");
+    w.String("bench_4km");
+    w.EndObject();
+
+    w.Key("buffers");
+    w.StartArray();
+    w.StartObject();
+    w.Key("uri");
+    write_string(w, name + ".bin");
+    w.Key("byteLength");
+    w.Uint64(buffers.bin.size());
+    w.EndObject();
+    w.EndArray();
+
+    w.Key("bufferViews");
+    w.StartArray();
+    for(const auto &view: buffers.views)
+    {
+        w.StartObject();
+        w.Key("buffer");
+        w.Uint(0);
+        w.Key("byteOffset");
+        w.Uint64(view.offset);
+        w.Key("byteLength");
+        w.Uint64(view.length);
+        if(view.target)
+        {
+            w.Key("target");
+            w.Uint(view.target);
+        }
+        w.EndObject();
+    }
+    w.EndArray();
+
+    w.Key("accessors");
+    w.StartArray();
+    for(const auto &accessor: buffers.accessors)
+    {
+        w.StartObject();
+        w.Key("bufferView");
+        w.Uint(accessor.view);
+        w.Key("componentType");
+        w.Uint(accessor.component_type);
+        w.Key("count");
+        w.Uint64(accessor.count);
+        w.Key("type");
+        w.String(accessor.type);
+        if(accessor.bounds)
+        {
+            // bounds are provided for positions (VEC3) and keyframe-times (SCALAR)
+            size_t num_components = std::strcmp(accessor.type, "VEC3") ? 1 : 3;
+            w.Key("min");
+            write_array(w, std::vector<float>(accessor.bounds->first.begin(),
+                                              accessor.bounds->first.begin() + num_components));
+            w.Key("max");
+            write_array(w, std::vector<float>(accessor.bounds->second.begin(),
+                                              accessor.bounds->second.begin() + num_components));
+        }
+        w.EndObject();
+    }
+    w.EndArray();
+
+    const uint32_t num_materials = std::max<uint32_t>(params.num_textures, 1);
+    if(params.num_textures)
+    {
+        w.Key("images");
+        w.StartArray();
+        for(uint32_t i = 0; i < params.num_textures; ++i)
+        {
+            w.StartObject();
+            w.Key("uri");
+            write_string(w, std::format("{}_{}.png", name, i));
+            w.EndObject();
+        }
+        w.EndArray();
+
+        w.Key("samplers");
+        w.StartArray();
+        w.StartObject();
+        w.Key("magFilter");
+        w.Uint(9729);
+        w.Key("minFilter");
+        w.Uint(9987);
+        w.EndObject();
+        w.EndArray();
+
+        w.Key("textures");
+        w.StartArray();
+        for(uint32_t i = 0; i < params.num_textures; ++i)
+        {
+            w.StartObject();
+            w.Key("source");
+            w.Uint(i);
+            w.Key("sampler");
+            w.Uint(0);
+            w.EndObject();
+        }
+        w.EndArray();
+    }
+
+    w.Key("materials");
+    w.StartArray();
+    for(uint32_t i = 0; i < num_materials; ++i)
+    {
+        w.StartObject();
+        w.Key("name");
+        write_string(w, std::format("material_{}", i));
+        w.Key("pbrMetallicRoughness");
+        w.StartObject();
+        if(params.num_textures)
+        {
+            w.Key("baseColorTexture");
+            w.StartObject();
+            w.Key("index");
+            w.Uint(i);
+            w.EndObject();
+        }
+        w.Key("metallicFactor");
+        w.Double(0.0);
+        w.Key("roughnessFactor");
+        w.Double(0.5);
+        w.EndObject();
+        w.EndObject();
+    }
+    w.EndArray();
+
+    w.Key("meshes");
+    w.StartArray();
+    for(uint32_t i = 0; i < meshes.size(); ++i)
+    {
+        const auto &mesh = meshes[i];
+        w.StartObject();
+        w.Key("name");
+        write_string(w, std::format("mesh_{}", i));
+        w.Key("primitives");
+        w.StartArray();
+        w.StartObject();
+        w.Key("attributes");
+        w.StartObject();
+        w.Key("POSITION");
+        w.Uint(mesh.position);
+        w.Key("NORMAL");
+        w.Uint(mesh.normal);
+        w.Key("TEXCOORD_0");
+        w.Uint(mesh.tex_coord);
+        if(mesh.joints && mesh.weights)
+        {
+            w.Key("JOINTS_0");
+            w.Uint(*mesh.joints);
+            w.Key("WEIGHTS_0");
+            w.Uint(*mesh.weights);
+        }
+        w.EndObject();
+        w.Key("indices");
+        w.Uint(mesh.indices);
+        w.Key("material");
+        w.Uint(i % num_materials);
+        w.EndObject();
+        w.EndArray();
+        w.EndObject();
+    }
+    w.EndArray();
+
+    // nodes: joints first, followed by one node per entry
+    w.Key("nodes");
+    w.StartArray();
+    for(uint32_t j = 0; j < num_joints; ++j)
+    {
+        w.StartObject();
+        w.Key("name");
+        write_string(w, std::format("joint_{}", j));
+        if(j)
+        {
+            w.Key("translation");
+            write_array(w, std::array<float, 3>{0.f, 1.f, 0.f});
+        }
+        if(j + 1 < num_joints)
+        {
+            w.Key("children");
+            w.StartArray();
+            w.Uint(j + 1);
+            w.EndArray();
+        }
+        w.EndObject();
+    }
+    for(uint32_t i = 0; i < params.num_entries; ++i)
+    {
+        w.StartObject();
+        w.Key("name");
+        write_string(w, std::format("entry_{}", i));
+        w.Key("mesh");
+        w.Uint(i);
+        if(params.skinning)
+        {
+            w.Key("skin");
+            w.Uint(0);
+        }
+        w.Key("translation");
+        write_array(w, std::array<float, 3>{entry_spacing * static_cast<float>(i % entries_per_row), 0.f,
+                                            entry_spacing * static_cast<float>(i / entries_per_row)});
+        w.EndObject();
+    }
+    w.EndArray();
+
+    if(params.skinning)
+    {
+        w.Key("skins");
+        w.StartArray();
+        w.StartObject();
+        w.Key("inverseBindMatrices");
+        w.Uint(*inverse_bind_matrices);
+        w.Key("skeleton");
+        w.Uint(0);
+        w.Key("joints");
+        w.StartArray();
+        for(uint32_t j = 0; j < num_joints; ++j) { w.Uint(j); }
+        w.EndArray();
+        w.EndObject();
+        w.EndArray();
+    }
+
+    if(params.num_animations && (num_joints || params.num_entries))
+    {
+        // animated: the last joint when skinned, entry-nodes otherwise
+        w.Key("animations");
+        w.StartArray();
+        for(uint32_t a = 0; a < params.num_animations; ++a)
+        {
+            uint32_t target_node = num_joints ? num_joints - 1 : a % params.num_entries;
+            w.StartObject();
+            w.Key("name");
+            write_string(w, std::format("animation_{}", a));
+            w.Key("samplers");
+            w.StartArray();
+            w.StartObject();
+            w.Key("input");
+            w.Uint(keyframe_times[a]);
+            w.Key("output");
+            w.Uint(keyframe_rotations[a]);
+            w.Key("interpolation");
+            w.String("LINEAR");
+            w.EndObject();
+            w.EndArray();
+            w.Key("channels");
+            w.StartArray();
+            w.StartObject();
+            w.Key("sampler");
+            w.Uint(0);
+            w.Key("target");
+            w.StartObject();
+            w.Key("node");
+            w.Uint(target_node);
+            w.Key("path");
+            w.String("rotation");
+            w.EndObject();
+            w.EndObject();
+            w.EndArray();
+            w.EndObject();
+        }
+        w.EndArray();
+    }
+
+    w.Key("scenes");
+    w.StartArray();
+    w.StartObject();
+    w.Key("nodes");
+    w.StartArray();
+    if(num_joints) { w.Uint(0); }
+    for(uint32_t i = 0; i < params.num_entries; ++i) { w.Uint(num_joints + i); }
+    w.EndArray();
+    w.EndObject();
+    w.EndArray();
+    w.Key("scene");
+    w.Uint(0);
+
+    w.EndObject();
+
+    auto gltf_path = directory / (name + ".gltf");
+    write_file(gltf_path, json.GetString(), json.GetSize());
+    return gltf_path;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include <cereal/cereal.hpp>
+#include <crocore/Image.hpp>
+
+//! parameters for a procedurally generated model
+struct model_params_t
+{
+    //! number of mesh-entries, each with its own geometry and node
+    uint32_t num_entries = 16;
+
+    //! approximate number of vertices per entry (rounded up to a square grid)
+    uint32_t num_vertices = 4096;
+
+    //! number of textures (and materials). models without textures use a single untextured material.
+    uint32_t num_textures = 4;
+
+    //! width and height of textures in px
+    uint32_t texture_size = 512;
+
+    //! number of node-animations (rotation, 32 keyframes each)
+    uint32_t num_animations = 0;
+
+    //! skin all entries to a two-joint skeleton
+    bool skinning = false;
+
+    template<class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(cereal::make_nvp("num_entries", num_entries), cereal::make_nvp("num_vertices", num_vertices),
+                cereal::make_nvp("num_textures", num_textures), cereal::make_nvp("texture_size", texture_size),
+                cereal::make_nvp("num_animations", num_animations), cereal::make_nvp("skinning", skinning));
+    }
+};
+
+/**
+ * @brief   'generate_model' writes a deterministic glTF-model (.gltf + .bin + PNG-textures) into a directory.
+ *          geometry and textures differ per entry/texture, so bake-time deduplication does not collapse them.
+ *          throws std::runtime_error if files cannot be written.
+ *
+ * @param   directory   output-directory, created if necessary
+ * @param   name        base-name for all written files
+ * @param   params      model-parameters
+ * @return  path of the written .gltf-file
+ */
+std::filesystem::path generate_model(const std::filesystem::path &directory, const std::string &name,
+                                     const model_params_t &params);
+
+/**
+ * @brief   'generate_texture' creates a procedural RGBA-pattern, distinct per index.
+ *
+ * @param   size    width and height in px
+ * @param   index   index of the texture
+ * @return  an image with 4 components
+ */
+crocore::ImagePtr generate_texture(uint32_t size, uint32_t index);
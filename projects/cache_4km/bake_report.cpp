@@ -0,0 +1,66 @@
+#include <fstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <spdlog/spdlog.h>
+
+#include "bake_report.hpp"
+
+uint64_t peak_rss_bytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) { return counters.PeakWorkingSetSize; }
+    return 0;
+#else
+    rusage usage = {};
+    if(getrusage(RUSAGE_SELF, &usage)) { return 0; }
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    // kilobytes on linux
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+void bake_report::add(input_report_t input)
+{
+    std::lock_guard lock(m_mutex);
+    m_inputs.push_back(std::move(input));
+}
+
+void bake_report::add_commit_seconds(double seconds)
+{
+    std::lock_guard lock(m_mutex);
+    m_commit_seconds += seconds;
+}
+
+bool bake_report::save(const std::filesystem::path &path) const
+{
+    std::lock_guard lock(m_mutex);
+    try
+    {
+        if(path.has_parent_path()) { std::filesystem::create_directories(path.parent_path()); }
+        std::ofstream ofs(path);
+        {
+            cereal::JSONOutputArchive archive(ofs);
+            archive(cereal::make_nvp("version", version), cereal::make_nvp("process_peak_rss", peak_rss_bytes()),
+                    cereal::make_nvp("commit_seconds", m_commit_seconds), cereal::make_nvp("inputs", m_inputs));
+        }
+        if(!ofs) { throw std::runtime_error("write failed"); }
+        return true;
+    } catch(const std::exception &e) { spdlog::error("could not write report '{}': {}", path.string(), e.what()); }
+    return false;
+}
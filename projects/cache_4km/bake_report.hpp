@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+#include <vierkant_cereal/vierkant_cereal.hpp>
+
+//! high-water mark of the process' resident set size in bytes (never decreases), 0 if not available
+uint64_t peak_rss_bytes();
+
+//! report-entry for a single input-file
+struct input_report_t
+{
+    std::string model_path;
+    std::string bundle_path;
+
+    //! "baked", "up-to-date" or "failed"
+    std::string status;
+
+    //! stage-timings and size-statistics of the bake
+    vierkant_cereal::bake_stats_t bake;
+
+    //! wall-time saving the bundle (serialization, compression and writing)
+    double save_seconds = 0.0;
+
+    //! thereof serializing and compressing (textures and sections), summed over threads (see save_stats_t)
+    double serialize_seconds = 0.0;
+    double compress_seconds = 0.0;
+
+    //! serialized bundle-size and size stored on disk (file or zip-entry)
+    uint64_t bundle_size = 0;
+    uint64_t stored_size = 0;
+
+    //! high-water mark of the process' RSS after this input, not a per-input value:
+    //! it includes earlier and concurrently baked inputs.
+    uint64_t process_peak_rss = 0;
+
+    template<class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(cereal::make_nvp("model_path", model_path), cereal::make_nvp("bundle_path", bundle_path),
+                cereal::make_nvp("status", status), cereal::make_nvp("bake", bake),
+                cereal::make_nvp("save_seconds", save_seconds),
+                cereal::make_nvp("serialize_seconds", serialize_seconds),
+                cereal::make_nvp("compress_seconds", compress_seconds), cereal::make_nvp("bundle_size", bundle_size),
+                cereal::make_nvp("stored_size", stored_size), cereal::make_nvp("process_peak_rss", process_peak_rss));
+    }
+};
+
+/**
+ * @brief   bake_report collects per-input statistics of a cache_4km run and writes them as json.
+ *          all methods are thread-safe.
+ */
+class bake_report
+{
+public:
+    //! report-format version
+    static constexpr uint32_t version = 2;
+
+    void add(input_report_t input);
+
+    //! account time spent committing bundles to a zip-archive
+    void add_commit_seconds(double seconds);
+
+    /**
+     * @brief   'save' writes the report, replacing an existing file.
+     *
+     * @param   path    output-path
+     * @return  true on success
+     */
+    bool save(const std::filesystem::path &path) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<input_report_t> m_inputs;
+    double m_commit_seconds = 0.0;
+};
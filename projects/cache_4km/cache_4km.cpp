@@ -1,9 +1,27 @@
 //
 // cache_4km - bake self-contained '.4km' asset-bundles (mesh-buffers/meshlets/lods + texture-compression)
 // from model-files, optionally storing them into a compressed zip-archive.
+// with '--watch', models are re-baked in the background whenever they (or referenced files) change.
+// with '--gc', stale bundles are removed and least-recently used ones evicted to fit into '--max-size'.
+// big bakes can be split with '--shard i/N' and the resulting archives joined with '--merge',
+// the shards' texture-stores with '--merge-texture-store'.
+// with '--migrate', bundles and stored textures with an older schema-version are upgraded in place,
+// instead of re-baking them.
 //
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <csignal>
 #include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <thread>
 
 #include <crocore/ThreadPoolClassic.hpp>
@@ -11,7 +29,161 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/stopwatch.h>
 
+#include <vierkant_cereal/bake_memory.hpp>
+#include <vierkant_cereal/bundle_archive_writer.hpp>
+#include <vierkant_cereal/bundle_container.hpp>
+#include <vierkant_cereal/bundle_gc.hpp>
+#include <vierkant_cereal/bundle_manifest.hpp>
+#include <vierkant_cereal/bundle_migration.hpp>
+#include <vierkant_cereal/model_dependencies.hpp>
+#include <vierkant_cereal/texture_store.hpp>
 #include <vierkant_cereal/vierkant_cereal.hpp>
+#include <vierkant_cereal/xxhash64.hpp>
+#include <vierkant_cereal/ziparchive_pool.h>
+
+#include "bake_report.hpp"
+#include "file_watcher.hpp"
+
+//! set by SIGINT/SIGTERM, ends the watch-mode
+static volatile std::sig_atomic_t g_interrupted = 0;
+
+static void handle_interrupt(int) { g_interrupted = 1; }
+
+//! true for file-types handled by vierkant::model::load_model
+static bool is_model_file(const std::filesystem::path &path)
+{
+    auto ext = path.extension().string();
+    std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".gltf" || ext == ".glb" || ext == ".obj";
+}
+
+//! all model-files contained in 'directories', recursively
+static std::vector<std::string> find_model_files(const std::vector<std::filesystem::path> &directories)
+{
+    std::vector<std::string> ret;
+    for(const auto &directory: directories)
+    {
+        std::error_code ec;
+        for(const auto &entry: std::filesystem::recursive_directory_iterator(directory, ec))
+        {
+            if(entry.is_regular_file(ec) && is_model_file(entry.path()))
+            {
+                ret.push_back(std::filesystem::absolute(entry.path()).lexically_normal().string());
+            }
+        }
+    }
+    return ret;
+}
+
+//! a partition of input-files
+struct shard_t
+{
+    uint32_t index = 0;
+    uint32_t count = 1;
+};
+
+//! parse a shard-specification 'i/N', with 0 <= i < N
+static std::optional<shard_t> parse_shard(const std::string &str)
+{
+    shard_t ret;
+    const char *end = str.data() + str.size();
+    auto [ptr, ec] = std::from_chars(str.data(), end, ret.index);
+    if(ec != std::errc() || ptr == end || *ptr != '/') { return {}; }
+    auto [count_ptr, count_ec] = std::from_chars(ptr + 1, end, ret.count);
+    if(count_ec != std::errc() || count_ptr != end || ret.index >= ret.count) { return {}; }
+    return ret;
+}
+
+//! true, if a model-file belongs to a shard. partitions are stable across machines,
+//! as long as paths relative to the working-directory match.
+static bool in_shard(const std::string &file, const shard_t &shard)
+{
+    if(shard.count <= 1) { return true; }
+    auto key = std::filesystem::absolute(file).lexically_normal().lexically_proximate(std::filesystem::current_path());
+    return vierkant_cereal::xxh64(key.generic_string()) % shard.count == shard.index;
+}
+
+/**
+ * @brief   'watch_models' re-bakes models whenever they, or files they reference, are written.
+ *          writes are debounced per model, bursts of writes (e.g. an export with textures) cause a single re-bake.
+ *          runs until interrupted (SIGINT/SIGTERM).
+ *
+ * @param   directories     watched directories, new model-files in those are baked as well
+ * @param   models          initially known model-files
+ * @param   debounce        time without further writes, before a model is re-baked
+ * @param   bake            bakes a batch of model-files
+ */
+static void watch_models(const std::vector<std::filesystem::path> &directories, const std::vector<std::string> &models,
+                         std::chrono::milliseconds debounce,
+                         const std::function<void(const std::vector<std::string> &)> &bake)
+{
+    using clock_t = std::chrono::steady_clock;
+    file_watcher watcher(directories);
+
+    // model-files by referenced file and vice versa
+    std::map<std::filesystem::path, std::set<std::string>> dependents;
+    std::map<std::string, std::vector<std::filesystem::path>> dependencies;
+
+    auto track = [&](const std::string &model) {
+        for(const auto &dependency: dependencies[model]) { dependents[dependency].erase(model); }
+        auto &model_dependencies = dependencies[model];
+        model_dependencies.clear();
+        for(const auto &dependency: vierkant_cereal::model_dependencies(model))
+        {
+            model_dependencies.push_back(std::filesystem::absolute(dependency).lexically_normal());
+            dependents[model_dependencies.back()].insert(model);
+        }
+    };
+    for(const auto &model: models) { track(model); }
+
+    // last write per model
+    std::map<std::string, clock_t::time_point> pending;
+
+    std::signal(SIGINT, handle_interrupt);
+    std::signal(SIGTERM, handle_interrupt);
+    spdlog::info("watching {} directory(ies) for changes, {} model(s) - ctrl-c to stop", directories.size(),
+                 dependencies.size());
+
+    while(!g_interrupted)
+    {
+        auto events = watcher.wait(std::clamp(debounce / 4, std::chrono::milliseconds(10),
+                                              std::chrono::milliseconds(250)));
+        auto now = clock_t::now();
+
+        if(events.overflow)
+        {
+            spdlog::warn("missed file-events, rescanning watched directories");
+            for(const auto &model: find_model_files(directories)) { pending[model] = now; }
+        }
+
+        for(const auto &file: events.files)
+        {
+            auto path = std::filesystem::absolute(file).lexically_normal();
+            if(is_model_file(path)) { pending[path.string()] = now; }
+            if(auto it = dependents.find(path); it != dependents.end())
+            {
+                for(const auto &model: it->second) { pending[model] = now; }
+            }
+        }
+
+        std::vector<std::string> ready;
+        for(auto it = pending.begin(); it != pending.end();)
+        {
+            if(now - it->second < debounce) { ++it; }
+            else
+            {
+                ready.push_back(it->first);
+                it = pending.erase(it);
+            }
+        }
+        if(ready.empty()) { continue; }
+
+        // references might have changed
+        for(const auto &model: ready) { track(model); }
+        bake(ready);
+    }
+    spdlog::info("stopped watching");
+}
 
 int main(int argc, char *argv[])
 {
@@ -26,8 +198,26 @@ int main(int argc, char *argv[])
         ("no-pack-vertices", "disable vertex-packing")
         ("c,compress", "block-compress (BC7/BC5) all textures")
         ("omm", "bake opacity-micromaps for alpha-masked geometry")
+        ("texture-codec", "codec for uncompressed textures (png, qoi, zstd)", cxxopts::value<std::string>()->default_value("qoi"))
+        ("geometry-codec", "codec for geometry (meshopt, zstd)", cxxopts::value<std::string>()->default_value("meshopt"))
+        ("texture-store", "directory of the texture-store shared across bundles (default: <output-dir>/../textures)", cxxopts::value<std::string>())
+        ("no-texture-store", "store all textures inside the bundles")
         ("z,zip", "store bundles zstd-compressed into the given zip-archive", cxxopts::value<std::string>())
+        ("f,force", "re-bake all files, including up-to-date ones")
+        ("checkpoint", "commit the zip-archive after this many baked or migrated bundles (0: once at the end)", cxxopts::value<uint32_t>()->default_value("0"))
         ("j,threads", "number of worker-threads", cxxopts::value<uint32_t>())
+        ("J,jobs", "number of models baked concurrently (default: threads / 4)", cxxopts::value<uint32_t>())
+        ("max-memory", "estimated memory-budget in MiB for concurrently baked models (0: unlimited)", cxxopts::value<uint64_t>()->default_value("0"))
+        ("report", "write per-input stage-timings and size-statistics as json", cxxopts::value<std::string>())
+        ("watch", "keep running and re-bake models in these directories, when they or referenced files change", cxxopts::value<std::vector<std::string>>())
+        ("debounce", "watch-mode: milliseconds without further writes, before a changed model is re-baked", cxxopts::value<uint32_t>()->default_value("500"))
+        ("shard", "bake only a deterministic partition 'i/N' of the input-files (0 <= i < N)", cxxopts::value<std::string>())
+        ("merge", "merge all entries of these zip-archives into '--zip' without recompression, e.g. from shards", cxxopts::value<std::vector<std::string>>())
+        ("merge-texture-store", "merge: copy textures of these texture-stores (e.g. from shards) into the texture-store", cxxopts::value<std::vector<std::string>>())
+        ("gc", "cache-maintenance: remove stale bundles and unreferenced textures, evict least-recently used bundles")
+        ("max-size", "gc: maximum size of bundles and texture-store in MiB (0: unlimited)", cxxopts::value<uint64_t>()->default_value("0"))
+        ("migrate", "cache-maintenance: upgrade bundles and stored textures with an older schema-version in place, without re-baking")
+        ("dry-run", "gc/migrate: only report what would be removed/migrated")
         ("v,verbose", "verbose logging")
         ("h,help", "print this help message");
     // clang-format on
@@ -52,12 +242,43 @@ int main(int argc, char *argv[])
 
     spdlog::set_level(result.count("verbose") ? spdlog::level::debug : spdlog::level::info);
 
-    if(!result.count("files"))
+    std::vector<std::filesystem::path> watch_dirs;
+    if(result.count("watch"))
+    {
+        if(!file_watcher::supported())
+        {
+            spdlog::error("watch-mode is not supported on this platform");
+            return EXIT_FAILURE;
+        }
+        for(const auto &dir: result["watch"].as<std::vector<std::string>>()) { watch_dirs.emplace_back(dir); }
+    }
+
+    const bool gc = result.count("gc") > 0;
+    const bool migrate = result.count("migrate") > 0;
+    if(!result.count("files") && watch_dirs.empty() && !gc && !migrate && !result.count("merge"))
     {
         spdlog::error("no input-files provided\n{}", options.help());
         return EXIT_FAILURE;
     }
 
+    shard_t shard;
+    if(result.count("shard"))
+    {
+        auto parsed = parse_shard(result["shard"].as<std::string>());
+        if(!parsed)
+        {
+            spdlog::error("invalid shard '{}', expected 'i/N' with 0 <= i < N", result["shard"].as<std::string>());
+            return EXIT_FAILURE;
+        }
+        shard = *parsed;
+    }
+
+    if(result.count("merge") && !result.count("zip"))
+    {
+        spdlog::error("'--merge' requires a target-archive ('--zip')");
+        return EXIT_FAILURE;
+    }
+
     // bake-parameters (defaults mirror the pbr_viewer)
     vierkant_cereal::bundle_params_t bundle_params = {};
     bundle_params.mesh_buffer_params.optimize_vertex_cache = true;
@@ -67,32 +288,356 @@ int main(int argc, char *argv[])
     bundle_params.compress_textures = result.count("compress") > 0;
     if(result.count("omm")) { bundle_params.omm_params = vierkant::model::omm_gen_params_t{}; }
 
+    const std::map<std::string, vierkant_cereal::texture_codec_t> texture_codecs = {
+            {"png", vierkant_cereal::texture_codec_t::Png},
+            {"qoi", vierkant_cereal::texture_codec_t::Qoi},
+            {"zstd", vierkant_cereal::texture_codec_t::RawZstd}};
+    auto codec_it = texture_codecs.find(result["texture-codec"].as<std::string>());
+    if(codec_it == texture_codecs.end())
+    {
+        spdlog::error("unknown texture-codec '{}'", result["texture-codec"].as<std::string>());
+        return EXIT_FAILURE;
+    }
+    const auto texture_codec = codec_it->second;
+
+    const std::map<std::string, vierkant_cereal::geometry_codec_t> geometry_codecs = {
+            {"meshopt", vierkant_cereal::geometry_codec_t::Meshopt},
+            {"zstd", vierkant_cereal::geometry_codec_t::Zstd}};
+    auto geometry_codec_it = geometry_codecs.find(result["geometry-codec"].as<std::string>());
+    if(geometry_codec_it == geometry_codecs.end())
+    {
+        spdlog::error("unknown geometry-codec '{}'", result["geometry-codec"].as<std::string>());
+        return EXIT_FAILURE;
+    }
+    const auto geometry_codec = geometry_codec_it->second;
+    if(!vierkant_cereal::geometry_codec_supported(geometry_codec))
+    {
+        spdlog::warn("geometry-codec '{}' not supported, falling back to zstd", geometry_codec_it->first);
+    }
+
     uint32_t num_threads =
             result.count("threads") ? result["threads"].as<uint32_t>() : std::thread::hardware_concurrency();
     crocore::ThreadPoolClassic pool(num_threads);
     bundle_params.pool = &pool;
 
+    std::vector<std::string> files;
+    if(result.count("files")) { files = result["files"].as<std::vector<std::string>>(); }
+    for(auto &file: find_model_files(watch_dirs)) { files.push_back(std::move(file)); }
+    if(shard.count > 1)
+    {
+        auto num_files = files.size();
+        std::erase_if(files, [&shard](const std::string &file) { return !in_shard(file, shard); });
+        spdlog::info("shard {}/{}: {} of {} file(s)", shard.index, shard.count, files.size(), num_files);
+    }
+
+    // outer parallelism: models bake concurrently on dedicated threads, sharing the pool for their inner work
+    const uint32_t max_jobs = result.count("jobs") ? result["jobs"].as<uint32_t>() : num_threads / 4;
+    vierkant_cereal::memory_budget_t memory_budget(result["max-memory"].as<uint64_t>() << 20);
+
     const std::filesystem::path output_dir = result["output-dir"].as<std::string>();
-    std::optional<std::filesystem::path> zip_archive;
-    if(result.count("zip")) { zip_archive = result["zip"].as<std::string>(); }
 
-    int num_failed = 0;
-    for(const auto &file: result["files"].as<std::vector<std::string>>())
+    // textures shared across models are compressed and stored once, bundles only reference them
+    std::optional<vierkant_cereal::texture_store> texture_store;
+    if(!result.count("no-texture-store"))
+    {
+        std::filesystem::path store_dir = result.count("texture-store")
+                                                  ? result["texture-store"].as<std::string>()
+                                                  : vierkant_cereal::texture_store::default_directory(output_dir);
+        texture_store.emplace(store_dir, texture_codec);
+        bundle_params.texture_store = &*texture_store;
+    }
+
+    // bundles are compressed by the baking threads, holding on to the memory-budget until compressed.
+    // all bundles are committed with a single archive-rewrite (per checkpoint)
+    std::unique_ptr<vierkant_cereal::bundle_archive_writer> archive_writer;
+    if(result.count("zip"))
     {
+        archive_writer = std::make_unique<vierkant_cereal::bundle_archive_writer>(result["zip"].as<std::string>(),
+                                                                                  &pool, false);
+    }
+    const uint32_t checkpoint_interval = result["checkpoint"].as<uint32_t>();
+
+    // records inputs of baked bundles, unchanged inputs are recognized without reading them
+    std::optional<std::filesystem::path> zip_path;
+    if(result.count("zip")) { zip_path = result["zip"].as<std::string>(); }
+    vierkant_cereal::bundle_manifest manifest(output_dir / vierkant_cereal::bundle_manifest::default_filename);
+    const bool force = result.count("force") > 0;
+
+    std::atomic<int> num_failed = 0, num_up_to_date = 0;
+
+    std::optional<std::filesystem::path> report_path;
+    if(result.count("report")) { report_path = result["report"].as<std::string>(); }
+    bake_report report;
+
+    auto bake_file = [&](const std::string &file) {
         spdlog::stopwatch sw;
-        auto assets = vierkant_cereal::create_model_bundle(file, bundle_params);
-        if(!assets)
+        auto content_hash = manifest.content_hash(file);
+        auto bundle_path = output_dir / vierkant_cereal::model_bundle_filename(
+                                                file, content_hash, bundle_params.mesh_buffer_params,
+                                                bundle_params.compress_textures, bundle_params.omm_params);
+
+        input_report_t input_report = {};
+        input_report.model_path = file;
+        input_report.bundle_path = bundle_path.string();
+
+        if(!force && vierkant_cereal::has_bundle_file(bundle_path, zip_path))
+        {
+            spdlog::debug("up-to-date '{}' -> '{}'", file, bundle_path.string());
+            ++num_up_to_date;
+            manifest.touch(bundle_path);
+            input_report.status = "up-to-date";
+            report.add(std::move(input_report));
+            return;
+        }
+
+        auto memory_estimate = vierkant_cereal::estimate_bake_memory(file);
+        memory_budget.acquire(memory_estimate);
+        bool baked = false;
+        try
+        {
+            if(auto assets = vierkant_cereal::create_model_bundle(file, bundle_params, &input_report.bake))
+            {
+                if(texture_store) { texture_store->strip(assets->textures); }
+
+                spdlog::stopwatch save_sw;
+                vierkant_cereal::save_stats_t save_stats;
+                if(archive_writer)
+                {
+                    // synchronous writer, sizes are available right away
+                    auto entry_size =
+                            archive_writer->add(std::move(*assets), bundle_path, texture_codec, geometry_codec).get();
+                    input_report.bundle_size = entry_size.size;
+                    input_report.stored_size = entry_size.stored_size;
+                    save_stats = entry_size.save_stats;
+                }
+                else
+                {
+                    vierkant_cereal::save_bundle_file(*assets, bundle_path, {}, texture_codec, geometry_codec,
+                                                      &save_stats);
+                    std::error_code ec;
+                    input_report.bundle_size = input_report.stored_size = std::filesystem::file_size(bundle_path, ec);
+                }
+                input_report.save_seconds = save_sw.elapsed().count();
+                input_report.serialize_seconds = save_stats.serialize_seconds;
+                input_report.compress_seconds = save_stats.compress_seconds;
+                baked = true;
+            }
+        } catch(const std::exception &e) { spdlog::error("baking '{}' failed: {}", file, e.what()); }
+        memory_budget.release(memory_estimate);
+
+        input_report.status = baked ? "baked" : "failed";
+        input_report.process_peak_rss = peak_rss_bytes();
+        report.add(std::move(input_report));
+
+        if(!baked)
         {
             ++num_failed;
-            continue;
+            return;
         }
-        auto bundle_path = output_dir / vierkant_cereal::model_bundle_filename(file, bundle_params.mesh_buffer_params,
-                                                                               bundle_params.compress_textures,
-                                                                               bundle_params.omm_params);
-        vierkant_cereal::save_bundle_file(*assets, bundle_path, zip_archive);
+        manifest.record(bundle_path, file, content_hash);
         spdlog::info("baked '{}' -> '{}' ({})", file, bundle_path.string(), sw.elapsed());
+
+        try
+        {
+            if(archive_writer && checkpoint_interval && archive_writer->num_pending() >= checkpoint_interval)
+            {
+                spdlog::stopwatch commit_sw;
+                archive_writer->checkpoint();
+                report.add_commit_seconds(commit_sw.elapsed().count());
+            }
+        } catch(const std::exception &e) { spdlog::error(e.what()); }
+    };
+
+    auto bake_files = [&](const std::vector<std::string> &batch) {
+        std::atomic<size_t> next_file = 0;
+        auto bake_fn = [&]() {
+            for(size_t i = next_file++; i < batch.size(); i = next_file++) { bake_file(batch[i]); }
+        };
+        auto num_jobs = std::clamp<uint32_t>(max_jobs, 1, static_cast<uint32_t>(batch.size()));
+        spdlog::debug("baking {} file(s) - jobs: {} - threads: {}", batch.size(), num_jobs, num_threads);
+
+        std::vector<std::thread> bake_threads;
+        for(uint32_t i = 1; i < num_jobs; ++i) { bake_threads.emplace_back(bake_fn); }
+        bake_fn();
+        for(auto &t: bake_threads) { t.join(); }
+    };
+
+    // publish baked bundles, the manifest is written after the bundles it references
+    auto commit = [&]() -> bool {
+        if(archive_writer)
+        {
+            try
+            {
+                spdlog::stopwatch sw;
+                archive_writer->checkpoint();
+                report.add_commit_seconds(sw.elapsed().count());
+                spdlog::info("committed archive '{}' ({})", archive_writer->archive_path().string(), sw.elapsed());
+            } catch(const std::exception &e)
+            {
+                spdlog::error(e.what());
+                return false;
+            }
+        }
+        manifest.save();
+        if(report_path) { report.save(*report_path); }
+        return true;
+    };
+
+    // join archives (e.g. baked by shards), entries are copied as they are
+    if(result.count("merge"))
+    {
+        try
+        {
+            spdlog::stopwatch sw;
+            const std::filesystem::path target = result["zip"].as<std::string>();
+            std::vector<std::filesystem::path> sources;
+            for(const auto &path: result["merge"].as<std::vector<std::string>>())
+            {
+                std::error_code ec;
+                if(!std::filesystem::is_regular_file(path)) { throw std::runtime_error("archive not found: " + path); }
+                if(!std::filesystem::equivalent(path, target, ec)) { sources.emplace_back(path); }
+            }
+
+            // merged model-bundles, as bundle-paths for the target-archive
+            const std::string suffix = std::string(".") + vierkant_cereal::bundle_file_suffix;
+            std::vector<std::filesystem::path> merged_bundles;
+            for(const auto &path: sources)
+            {
+                auto index = vierkant::ziparchive_pool::global().index(path);
+                if(!index) { throw std::runtime_error("could not open archive: " + path.string()); }
+                for(const auto &[name, info]: *index)
+                {
+                    if(std::filesystem::path(name).extension() == suffix)
+                    {
+                        merged_bundles.push_back(target.parent_path() / name);
+                    }
+                }
+            }
+
+            size_t num_entries = 0;
+            vierkant::ziparchive_pool::global().modify(target, [&](vierkant::ziparchive &archive) {
+                for(const auto &path: sources) { num_entries += archive.add_archive(vierkant::ziparchive(path)); }
+            });
+            spdlog::info("merged {} entries into '{}' ({})", num_entries, target.string(), sw.elapsed());
+
+            // stripped bundles only reference their textures, those have to be merged as well
+            if(texture_store)
+            {
+                if(result.count("merge-texture-store"))
+                {
+                    size_t num_textures = 0;
+                    for(const auto &dir: result["merge-texture-store"].as<std::vector<std::string>>())
+                    {
+                        num_textures += texture_store->merge(dir);
+                    }
+                    spdlog::info("merged {} texture(s) into '{}'", num_textures,
+                                 texture_store->directory().string());
+                }
+
+                std::vector<size_t> num_missing(merged_bundles.size(), 0);
+                vierkant_cereal::parallel_for(
+                        merged_bundles.size(),
+                        [&](size_t i) {
+                            auto assets = vierkant_cereal::load_model_bundle_file(
+                                    merged_bundles[i], target,
+                                    vierkant_cereal::bundle_section_bit(vierkant_cereal::bundle_section_t::Materials));
+                            if(!assets) { return; }
+                            for(const auto &id: vierkant_cereal::texture_store::referenced_ids(*assets))
+                            {
+                                if(!assets->textures.contains(id) && !texture_store->contains(id)) { num_missing[i]++; }
+                            }
+                        },
+                        &pool);
+                auto num_incomplete = std::ranges::count_if(num_missing, [](size_t n) { return n > 0; });
+                if(num_incomplete)
+                {
+                    spdlog::warn("{} merged bundle(s) reference textures missing in texture-store '{}', "
+                                 "merge the shards' stores with '--merge-texture-store'",
+                                 num_incomplete, texture_store->directory().string());
+                }
+            }
+            else if(result.count("merge-texture-store"))
+            {
+                spdlog::warn("'--merge-texture-store' is ignored with '--no-texture-store'");
+            }
+        } catch(const std::exception &e)
+        {
+            spdlog::error("merging archives failed: {}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    // migrated bundles are up-to-date for the following bake
+    if(migrate)
+    {
+        spdlog::stopwatch sw;
+        vierkant_cereal::bundle_migration_params_t migration_params = {};
+        migration_params.bundle_dir = output_dir;
+        migration_params.zip_archive = zip_path;
+        migration_params.texture_store = texture_store ? &*texture_store : nullptr;
+        migration_params.texture_codec = texture_codec;
+        migration_params.geometry_codec = geometry_codec;
+        migration_params.checkpoint_interval = checkpoint_interval;
+        migration_params.dry_run = result.count("dry-run") > 0;
+        migration_params.pool = &pool;
+
+        auto migration_result = vierkant_cereal::migrate_bundles(manifest, migration_params);
+        spdlog::info("{}{} bundle(s), {} texture(s): {} / {} migrated to schema-version {}, {} unsupported, "
+                     "{} failed ({})",
+                     migration_params.dry_run ? "dry-run - " : "", migration_result.num_bundles,
+                     migration_result.num_textures, migration_result.num_migrated,
+                     migration_result.num_textures_migrated, vierkant_cereal::bundle_schema_version,
+                     migration_result.num_unsupported, migration_result.num_failed, sw.elapsed());
+        if(!migration_params.dry_run && !manifest.save()) { return EXIT_FAILURE; }
+        num_failed += static_cast<int>(migration_result.num_failed);
+    }
+
+    if(!files.empty())
+    {
+        bake_files(files);
+        if(!commit()) { return EXIT_FAILURE; }
+    }
+
+    if(gc)
+    {
+        spdlog::stopwatch sw;
+        vierkant_cereal::bundle_gc_params_t gc_params = {};
+        gc_params.bundle_dir = output_dir;
+        gc_params.zip_archive = zip_path;
+        gc_params.max_size = result["max-size"].as<uint64_t>() << 20;
+        gc_params.texture_store = texture_store ? &*texture_store : nullptr;
+        gc_params.dry_run = result.count("dry-run") > 0;
+        gc_params.pool = &pool;
+
+        auto gc_result = vierkant_cereal::collect_bundle_garbage(manifest, gc_params);
+        constexpr double mib = 1 << 20;
+        spdlog::info("{}{} bundle(s): {} stale, {} evicted, {} texture(s) removed - {:.1f} MiB -> {:.1f} MiB ({})",
+                     gc_params.dry_run ? "dry-run - " : "", gc_result.num_bundles, gc_result.num_stale,
+                     gc_result.num_evicted, gc_result.num_textures, static_cast<double>(gc_result.size_before) / mib,
+                     static_cast<double>(gc_result.size_after) / mib, sw.elapsed());
+        if(!gc_params.dry_run && !manifest.save()) { return EXIT_FAILURE; }
+    }
+
+    if(!watch_dirs.empty())
+    {
+        try
+        {
+            watch_models(watch_dirs, files, std::chrono::milliseconds(result["debounce"].as<uint32_t>()),
+                         [&](std::vector<std::string> batch) {
+                             std::erase_if(batch, [&shard](const std::string &file) { return !in_shard(file, shard); });
+                             if(batch.empty()) { return; }
+                             bake_files(batch);
+                             commit();
+                         });
+        } catch(const std::exception &e)
+        {
+            spdlog::error(e.what());
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
     }
 
-    if(num_failed) { spdlog::warn("{} file(s) failed", num_failed); }
+    if(num_up_to_date) { spdlog::info("{} file(s) up-to-date", num_up_to_date.load()); }
+    if(num_failed) { spdlog::warn("{} file(s) failed", num_failed.load()); }
     return num_failed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
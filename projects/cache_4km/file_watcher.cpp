@@ -0,0 +1,123 @@
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "file_watcher.hpp"
+
+#if defined(__linux__)
+
+//! watched events, directory-creation is watched to extend watches to new subdirectories
+constexpr uint32_t watch_mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+
+bool file_watcher::supported() { return true; }
+
+file_watcher::file_watcher(const std::vector<std::filesystem::path> &directories)
+{
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(m_fd < 0) { throw std::runtime_error(std::string("file_watcher: inotify_init1: ") + std::strerror(errno)); }
+
+    try
+    {
+        for(const auto &directory: directories)
+        {
+            if(!std::filesystem::is_directory(directory))
+            {
+                throw std::runtime_error("file_watcher: not a directory: " + directory.string());
+            }
+            add_directory(std::filesystem::absolute(directory).lexically_normal(), nullptr);
+        }
+    } catch(...)
+    {
+        close(m_fd);
+        throw;
+    }
+}
+
+file_watcher::~file_watcher() { close(m_fd); }
+
+void file_watcher::add_directory(const std::filesystem::path &directory, events_t *events)
+{
+    int wd = inotify_add_watch(m_fd, directory.c_str(), watch_mask);
+    if(wd < 0)
+    {
+        throw std::runtime_error("file_watcher: could not watch '" + directory.string() + "': " + std::strerror(errno));
+    }
+    m_directories[wd] = directory;
+
+    // subdirectories and, for directories appearing later, files written before the watch was added
+    std::error_code ec;
+    for(const auto &entry: std::filesystem::directory_iterator(directory, ec))
+    {
+        if(entry.is_directory(ec)) { add_directory(entry.path(), events); }
+        else if(events && entry.is_regular_file(ec)) { events->files.push_back(entry.path()); }
+    }
+}
+
+file_watcher::events_t file_watcher::wait(std::chrono::milliseconds timeout)
+{
+    events_t ret;
+    pollfd pfd = {m_fd, POLLIN, 0};
+    if(poll(&pfd, 1, static_cast<int>(timeout.count())) <= 0 || !(pfd.revents & POLLIN)) { return ret; }
+
+    alignas(inotify_event) char buffer[64 * 1024];
+
+    for(;;)
+    {
+        auto num_bytes = read(m_fd, buffer, sizeof(buffer));
+        if(num_bytes <= 0) { break; }
+
+        for(char *ptr = buffer; ptr < buffer + num_bytes;)
+        {
+            const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if(event->mask & IN_Q_OVERFLOW) { ret.overflow = true; }
+            if(event->mask & IN_IGNORED)
+            {
+                m_directories.erase(event->wd);
+                continue;
+            }
+
+            auto it = m_directories.find(event->wd);
+            if(it == m_directories.end() || !event->len) { continue; }
+            auto path = it->second / event->name;
+
+            if(event->mask & IN_ISDIR)
+            {
+                if(event->mask & (IN_CREATE | IN_MOVED_TO))
+                {
+                    try
+                    {
+                        add_directory(path, &ret);
+                    } catch(const std::exception &) { ret.overflow = true; }
+                }
+            }
+            else if(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) { ret.files.push_back(std::move(path)); }
+        }
+    }
+    return ret;
+}
+
+#else
+
+bool file_watcher::supported() { return false; }
+
+file_watcher::file_watcher(const std::vector<std::filesystem::path> &)
+{
+    throw std::runtime_error("file_watcher: not supported on this platform");
+}
+
+file_watcher::~file_watcher() = default;
+
+void file_watcher::add_directory(const std::filesystem::path &, events_t *) {}
+
+file_watcher::events_t file_watcher::wait(std::chrono::milliseconds) { return {}; }
+
+#endif
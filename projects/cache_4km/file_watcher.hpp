@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief   file_watcher reports files written or moved into a set of directories, including their subdirectories.
+ *
+ * uses inotify and is only supported on linux. directories created later are watched as well,
+ * files already contained in those are reported.
+ */
+class file_watcher
+{
+public:
+    //! events collected by a single 'wait'
+    struct events_t
+    {
+        //! files that were written (closed after writing) or moved in, absolute paths
+        std::vector<std::filesystem::path> files;
+
+        //! true, if events were dropped by the kernel. watched directories should be rescanned.
+        bool overflow = false;
+    };
+
+    //! true, if file-watching is supported on this platform
+    static bool supported();
+
+    /**
+     * @brief   start watching directories. throws std::runtime_error on failure or unsupported platforms.
+     *
+     * @param   directories     directories to watch, recursively
+     */
+    explicit file_watcher(const std::vector<std::filesystem::path> &directories);
+
+    ~file_watcher();
+
+    file_watcher(const file_watcher &) = delete;
+    file_watcher &operator=(const file_watcher &) = delete;
+
+    /**
+     * @brief   'wait' blocks until events are available or 'timeout' expires.
+     *
+     * @param   timeout maximum time to wait
+     * @return  collected events, possibly none
+     */
+    events_t wait(std::chrono::milliseconds timeout);
+
+private:
+    void add_directory(const std::filesystem::path &directory, events_t *events);
+
+    int m_fd = -1;
+
+    //! watched directories, by watch-descriptor
+    std::unordered_map<int, std::filesystem::path> m_directories;
+};
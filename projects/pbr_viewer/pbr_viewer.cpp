@@ -85,11 +85,14 @@ void PBRViewer::setup()
     create_texture_image();
     create_graphics_pipeline();
 
-    // load a scene (keep a CLI-provided top-scene key; default only when none was staged)
+    // load a scene (keep a CLI-provided top-scene key; default only when none was staged).
+    // meshes start loading while the scene is still parsed
     if(!m_scene_paths.contains(m_scene_id)) { m_scene_paths[m_scene_id] = s_default_scene_path; }
-    auto scene_data =
-            m_scene_data.nodes.empty() && m_scene_data.environment_path.empty() ? load_scene_data() : m_scene_data;
-    build_scene(scene_data, true, m_scene_id);
+    auto mesh_futures = std::make_shared<mesh_futures_t>();
+    auto scene_data = m_scene_data.nodes.empty() && m_scene_data.environment_path.empty()
+                              ? load_scene_data(s_default_scene_path, mesh_prefetch_fn(mesh_futures))
+                              : m_scene_data;
+    build_scene(scene_data, true, m_scene_id, mesh_futures);
 }
 
 void PBRViewer::teardown()
@@ -98,6 +101,16 @@ void PBRViewer::teardown()
     background_queue().join_all();
     main_queue().poll();
 
+    // commit remaining cache-bundles, then the manifest referencing them
+    {
+        std::lock_guard lock(m_bundle_writer_mutex);
+        m_bundle_writer.reset();
+    }
+    {
+        std::lock_guard lock(m_model_manifest_mutex);
+        if(m_model_manifest) { m_model_manifest->save(); }
+    }
+
     // clear scene, free referenced gpu-resources
     m_scene.reset();
 
@@ -468,6 +481,9 @@ void PBRViewer::update(double time_delta)
 
     update_js(time_delta);
 
+    // commit batched cache-bundles once loading settled
+    if(!m_num_loading) { checkpoint_bundle_archive(); }
+
     // issue top-level draw-command
     m_window->draw();
 }
@@ -4,10 +4,15 @@
 
 #pragma once
 
+#include <vierkant_cereal/bundle_archive_writer.hpp>
+#include <vierkant_cereal/bundle_manifest.hpp>
+#include <vierkant_cereal/texture_store.hpp>
 #include <vierkant_cereal/scene_data.hpp>
+#include <vierkant_cereal/scene_json_reader.hpp>
 #include <crocore/Application.hpp>
 #include <crocore/set_lru.hpp>
 #include <filesystem>
+#include <future>
 #include <spdlog/spdlog.h>
 #include <vierkant/CameraControl.hpp>
 #include <vierkant/PBRDeferred.hpp>
@@ -77,6 +82,14 @@ public:
 
         bool texture_compression = false;
 
+        //! cap for the resolution of block-compressed textures loaded from bundles (0: unlimited).
+        //! finer mip-levels are skipped, limiting resident texture-memory
+        uint32_t max_texture_extent = 0;
+
+        //! block-compressed textures from bundles are loaded up to this extent first (0: disabled),
+        //! finer levels up to 'max_texture_extent' are streamed in afterwards
+        uint32_t initial_texture_extent = 256;
+
         //! bake opacity-micromaps (OMM) for alpha-masked geometry and feed them to the path-tracer
         bool opacity_micromaps = false;
 
@@ -184,13 +197,34 @@ private:
 
     static std::optional<settings_t> load_settings(const std::filesystem::path &path = "settings.json");
 
-    void save_asset_bundle(const vierkant::model::model_assets_t &mesh_assets, const std::filesystem::path &path) const;
+    void save_asset_bundle(vierkant::model::model_assets_t mesh_assets, const std::filesystem::path &path) const;
+
+    std::optional<vierkant::model::model_assets_t> load_asset_bundle(const std::filesystem::path &path,
+                                                                     uint32_t max_texture_extent);
 
-    std::optional<vierkant::model::model_assets_t> load_asset_bundle(const std::filesystem::path &path) const;
+    //! GPU-images of stored textures, shared by loaded meshes
+    struct resident_textures_t
+    {
+        std::vector<vierkant::TextureId> ids;
+        std::unordered_map<vierkant::texture_key_t, vierkant::ImagePtr> images;
+    };
+
+    //! GPU-images of stored textures referenced, but not contained in 'assets', still in use by loaded meshes
+    resident_textures_t resident_stored_textures(const vierkant::model::model_assets_t &assets);
+
+    //! register GPU-images of stored textures in 'mesh_result', so subsequently loaded meshes can share them
+    void share_stored_textures(const vierkant_cereal::texture_store &texture_store,
+                               const vierkant::model::model_assets_t &assets,
+                               const vierkant::model::load_mesh_result_t &mesh_result);
+
+    //! stream in finer levels of block-compressed 'textures', loaded from 'bundle_path' or the texture-store,
+    //! and replace the corresponding GPU-textures of a loaded mesh, asynchronously on the background-queue.
+    void stream_texture_levels(const std::filesystem::path &bundle_path, vierkant_cereal::texture_map_t textures,
+                               const vierkant::model::load_mesh_result_t &mesh_result);
 
     void save_material_bundle(const vierkant::material_data_t &material_data, const std::filesystem::path &path) const;
 
-    std::optional<vierkant::material_data_t> load_material_bundle(const std::filesystem::path &path) const;
+    std::optional<vierkant::material_data_t> load_material_bundle(const std::filesystem::path &path);
 
     //! project-root helpers (P1). establish the root once from the top-scene (or --project-root).
     void establish_project_root(const std::filesystem::path &top_scene_path);
@@ -209,14 +243,36 @@ private:
     //! optional zip-archive path under the project-root, depending on the cache_zip_archive setting.
     std::optional<std::filesystem::path> zip_archive_path() const;
 
+    //! writer batching cache-bundles into the zip-archive, nullptr if the zip-archive is disabled.
+    std::shared_ptr<vierkant_cereal::bundle_archive_writer> bundle_writer() const;
+
+    //! manifest for model-bundles under the project-root cache, lazily created
+    std::shared_ptr<vierkant_cereal::bundle_manifest> model_manifest() const;
+
+    //! texture-store shared by model-bundles under the project-root cache
+    vierkant_cereal::texture_store model_texture_store() const;
+
+    //! commit pending cache-bundles to the zip-archive, asynchronously on the background-queue.
+    void checkpoint_bundle_archive();
+
     vierkant::model::load_mesh_result_t load_mesh(const std::filesystem::path &path);
 
     void save_scene(std::filesystem::path path = {});
 
-    static std::optional<scene_data_t> load_scene_data(const std::filesystem::path &path = s_default_scene_path);
+    //! load a scene-file, model-paths are passed to 'model_path_fn' as soon as they were read
+    static std::optional<scene_data_t>
+    load_scene_data(const std::filesystem::path &path = s_default_scene_path,
+                    const vierkant_cereal::scene_model_path_fn_t &model_path_fn = {});
+
+    //! meshes loading in the background, by model-path
+    using mesh_futures_t = std::unordered_map<std::string, std::future<vierkant::model::load_mesh_result_t>>;
 
+    //! model-path callback for 'load_scene_data', starting to load meshes into 'mesh_futures' while parsing
+    vierkant_cereal::scene_model_path_fn_t mesh_prefetch_fn(const std::shared_ptr<mesh_futures_t> &mesh_futures);
+
+    //! build a scene (and its sub-scenes). meshes already prefetched into 'mesh_futures' are used, not reloaded.
     void build_scene(const std::optional<scene_data_t> &scene_data, bool import = false,
-                     vierkant::SceneId scene_id = {});
+                     vierkant::SceneId scene_id = {}, std::shared_ptr<mesh_futures_t> mesh_futures = {});
 
     //! clone a set of objects, assigning fresh physics body-ids and remapping their constraints.
     //! when 'instance_seed' is provided, new body-ids are derived deterministically from it (stable
@@ -344,6 +400,18 @@ private:
     std::map<vierkant::MeshId, std::filesystem::path> m_model_paths;
     std::map<vierkant::SceneId, std::filesystem::path> m_scene_paths;
     vierkant::SceneId m_scene_id;
+
+    // cache-bundles are queued and committed to the zip-archive in batches, once loading settled
+    mutable std::mutex m_bundle_writer_mutex;
+    mutable std::shared_ptr<vierkant_cereal::bundle_archive_writer> m_bundle_writer;
+    std::atomic<bool> m_bundle_checkpoint_running = false;
+
+    mutable std::mutex m_model_manifest_mutex;
+    mutable std::shared_ptr<vierkant_cereal::bundle_manifest> m_model_manifest;
+
+    // GPU-images of stored textures, weakly referenced, so equal textures of different meshes are uploaded once
+    std::mutex m_stored_texture_mutex;
+    std::unordered_map<vierkant::texture_key_t, std::weak_ptr<vierkant::Image>> m_stored_textures;
 };
 
 #include <vierkant_cereal/scene_cereal.hpp>
@@ -365,6 +433,8 @@ void serialize(Archive &ar, PBRViewer::settings_t &settings)
        cereal::make_nvp("draw_node_hierarchy", settings.draw_node_hierarchy),
        cereal::make_nvp("path_tracing", settings.path_tracing),
        cereal::make_nvp("texture_compression", settings.texture_compression),
+       cereal::make_optional_nvp("max_texture_extent", settings.max_texture_extent),
+       cereal::make_optional_nvp("initial_texture_extent", settings.initial_texture_extent),
        cereal::make_optional_nvp("opacity_micromaps", settings.opacity_micromaps),
        cereal::make_nvp("mesh_buffer_params", settings.mesh_buffer_params),
        cereal::make_nvp("cache_mesh_bundles", settings.cache_mesh_bundles),
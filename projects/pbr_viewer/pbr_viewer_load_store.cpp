@@ -391,7 +391,9 @@ void PBRViewer::load_file(const std::string &path, bool clear)
         case crocore::filesystem::FileType::OTHER:
             if(std::filesystem::path(path).extension() == ".json")
             {
-                if(auto loaded_scene = load_scene_data(path))
+                // meshes start loading while the scene is still parsed
+                auto mesh_futures = std::make_shared<mesh_futures_t>();
+                if(auto loaded_scene = load_scene_data(path, mesh_prefetch_fn(mesh_futures)))
                 {
                     if(clear)
                     {
@@ -401,7 +403,7 @@ void PBRViewer::load_file(const std::string &path, bool clear)
                     add_to_recent_files(path);
                     vierkant::SceneId scene_id;
                     m_scene_paths[scene_id] = project_key(path);
-                    build_scene(loaded_scene, clear, scene_id);
+                    build_scene(loaded_scene, clear, scene_id, mesh_futures);
                 }
             }
             break;
@@ -562,12 +564,23 @@ void PBRViewer::save_scene(std::filesystem::path path)
     save_material_bundle(texture_bundle, material_path);
 }
 
+vierkant_cereal::scene_model_path_fn_t PBRViewer::mesh_prefetch_fn(const std::shared_ptr<mesh_futures_t> &mesh_futures)
+{
+    return [this, mesh_futures](const vierkant::MeshId &, const std::string &path) {
+        if(!mesh_futures->contains(path))
+        {
+            (*mesh_futures)[path] = background_queue().post([this, path] { return load_mesh(path); });
+        }
+    };
+}
+
 void PBRViewer::build_scene(const std::optional<scene_data_t> &scene_data_in, bool clear_scene,
-                            vierkant::SceneId scene_id)
+                            vierkant::SceneId scene_id, std::shared_ptr<mesh_futures_t> mesh_futures)
 {
     auto start_time = std::chrono::high_resolution_clock::now();
+    if(!mesh_futures) { mesh_futures = std::make_shared<mesh_futures_t>(); }
 
-    auto load_task = [this, scene_data_in, scene_id, clear_scene, start_time]() {
+    auto load_task = [this, scene_data_in, scene_id, clear_scene, start_time, mesh_futures]() {
         // load background (resolve the stored env-key to an openable path)
         if(scene_data_in && clear_scene && !scene_data_in->environment_path.empty())
         {
@@ -596,6 +609,10 @@ void PBRViewer::build_scene(const std::optional<scene_data_t> &scene_data_in, bo
                 scene_assets[0].scene_key = it->second.generic_string();
             }
 
+            // schedule background creation of meshes not prefetched yet, sub-scenes schedule theirs while being parsed
+            auto schedule_mesh = mesh_prefetch_fn(mesh_futures);
+            for(const auto &[mesh_id, path]: scene_assets[0].scene_data.model_paths) { schedule_mesh(mesh_id, path); }
+
             // sub-scenes
             std::deque<std::pair<vierkant::SceneId, std::string>> sub_scene_paths = {
                     scene_assets[0].scene_data.scene_paths.begin(), scene_assets[0].scene_data.scene_paths.end()};
@@ -608,7 +625,7 @@ void PBRViewer::build_scene(const std::optional<scene_data_t> &scene_data_in, bo
 
                 m_scene_paths[id] = p;
 
-                if(auto sub_scene_data = load_scene_data(resolve(p)))
+                if(auto sub_scene_data = load_scene_data(resolve(p), schedule_mesh))
                 {
                     auto &new_scene_asset = scene_assets.emplace_back();
                     new_scene_asset.scene_data = std::move(*sub_scene_data);
@@ -622,20 +639,8 @@ void PBRViewer::build_scene(const std::optional<scene_data_t> &scene_data_in, bo
                 }
                 else { spdlog::error("could not load sub-scene: {}", p); }
             }
-            std::unordered_map<std::string, std::future<vierkant::model::load_mesh_result_t>> mesh_future_cache;
-
-            // schedule background creation of meshes
             for(auto &asset: scene_assets)
             {
-                for(const auto &path: asset.scene_data.model_paths | std::views::values)
-                {
-                    if(auto cache_it = mesh_future_cache.find(path); cache_it != mesh_future_cache.end()) {}
-                    else
-                    {
-                        mesh_future_cache[path] = background_queue().post([this, path] { return load_mesh(path); });
-                    }
-                }
-
                 // load the derived texture-bundle for scene and sub-scenes. its path is no longer
                 // stored in the scene-JSON (W4) -> recompute from the scene-key. fall back to any
                 // legacy stored path for pre-P1 scenes.
@@ -675,7 +680,7 @@ void PBRViewer::build_scene(const std::optional<scene_data_t> &scene_data_in, bo
             }
 
             std::unordered_map<std::string, vierkant::model::load_mesh_result_t> mesh_cache;
-            for(auto &[path, mesh_future]: mesh_future_cache) { mesh_cache[path] = mesh_future.get(); }
+            for(auto &[path, mesh_future]: *mesh_futures) { mesh_cache[path] = mesh_future.get(); }
 
             // load meshes for scene and sub-scenes
             for(auto &asset: scene_assets)
@@ -1038,15 +1043,39 @@ vierkant::model::load_mesh_result_t PBRViewer::load_mesh(const std::filesystem::
         std::optional<vierkant::model::omm_gen_params_t> omm_params;
         if(m_settings.opacity_micromaps) { omm_params = vierkant::model::omm_gen_params_t{}; }
 
-        // canonical cache-path for filename+params (hash uses filename() only), search existing bundle
+        // canonical cache-path for filename+content+params, search existing bundle.
+        // content-hashes of unchanged files are taken from the manifest, without reading them
+        auto manifest = model_manifest();
+        auto content_hash = manifest->content_hash(abs);
         std::filesystem::path bundle_path =
                 m_project_root / g_cache_path / g_model_store_path /
-                vierkant_cereal::model_bundle_filename(abs, m_settings.mesh_buffer_params,
+                vierkant_cereal::model_bundle_filename(abs, content_hash, m_settings.mesh_buffer_params,
                                                        m_settings.texture_compression, omm_params);
 
+        // with progressive loading, coarse texture-levels are loaded first and refined after the mesh is added
+        uint32_t texture_extent = m_settings.max_texture_extent;
+        if(m_settings.initial_texture_extent)
+        {
+            texture_extent = texture_extent ? std::min(texture_extent, m_settings.initial_texture_extent)
+                                            : m_settings.initial_texture_extent;
+        }
+
         auto mesh_id = vierkant::MeshId::from_name(key);
         bool bundle_created = false;
-        auto model_assets = load_asset_bundle(bundle_path);
+        auto model_assets = load_asset_bundle(bundle_path, texture_extent);
+
+        // textures shared across models are kept in the texture-store, bundles only reference them.
+        // stored textures still in use on the GPU are shared, instead of being loaded and uploaded again
+        auto texture_store = model_texture_store();
+        resident_textures_t resident_textures;
+        if(model_assets) { resident_textures = resident_stored_textures(*model_assets); }
+        if(model_assets &&
+           !texture_store.resolve(*model_assets, &background_queue(), texture_extent, resident_textures.ids))
+        {
+            model_assets.reset();
+            resident_textures = {};
+        }
+        if(model_assets) { manifest->touch(bundle_path); }
 
         if(!model_assets)
         {
@@ -1058,6 +1087,7 @@ vierkant::model::load_mesh_result_t PBRViewer::load_mesh(const std::filesystem::
                                                               .omm_params = omm_params,
                                                               .id_seed = key,
                                                               .pool = &background_queue()};
+            if(m_settings.cache_mesh_bundles) { bundle_params.texture_store = &texture_store; }
             model_assets = vierkant_cereal::create_model_bundle(abs, bundle_params);
 
             if(!model_assets)
@@ -1079,6 +1109,8 @@ vierkant::model::load_mesh_result_t PBRViewer::load_mesh(const std::filesystem::
 
         result = vierkant::model::load_mesh(load_params, *model_assets);
         result.mesh->id = mesh_id;
+        for(auto &[texture_key, image]: resident_textures.images) { result.textures[texture_key] = std::move(image); }
+        share_stored_textures(texture_store, *model_assets, result);
 
         // load_mesh keyed the OMM-cache on the mesh-id it assigned internally; re-stamp with the
         // final scene mesh-id so RayBuilder lookups (which use the scene mesh) hit, then accumulate
@@ -1097,11 +1129,21 @@ vierkant::model::load_mesh_result_t PBRViewer::load_mesh(const std::filesystem::
                 mesh_id,
                 {.mesh = result.mesh, .bundle = std::get<vierkant::mesh_buffer_bundle_t>(model_assets->geometry_data)});
 
+        // freshly baked bundles contain all levels already
+        if(!bundle_created && texture_extent != m_settings.max_texture_extent)
+        {
+            stream_texture_levels(bundle_path, std::move(model_assets->textures), result);
+        }
+
         if(bundle_created && m_settings.cache_mesh_bundles)
         {
-            background_queue().post([this, mesh_assets = std::move(model_assets), bundle_path]() {
-                save_asset_bundle(*mesh_assets, bundle_path);
-            });
+            background_queue().post(
+                    [this, mesh_assets = std::move(model_assets), bundle_path, manifest, abs, content_hash,
+                     texture_store]() mutable {
+                        texture_store.strip(mesh_assets->textures);
+                        save_asset_bundle(std::move(*mesh_assets), bundle_path);
+                        manifest->record(bundle_path, abs, content_hash);
+                    });
         }
     }
 
@@ -1110,17 +1152,12 @@ vierkant::model::load_mesh_result_t PBRViewer::load_mesh(const std::filesystem::
     return result;
 }
 
-std::optional<scene_data_t> PBRViewer::load_scene_data(const std::filesystem::path &path)
+std::optional<scene_data_t> PBRViewer::load_scene_data(const std::filesystem::path &path,
+                                                       const vierkant_cereal::scene_model_path_fn_t &model_path_fn)
 {
-    // create and open a character archive for input
-    std::ifstream file_stream(path.string());
-
-    if(file_stream.is_open())
-    {
-        spdlog::debug("loading scene: {}", path.string());
-        return vierkant_cereal::load_scene_data(file_stream);
-    }
-    return {};
+    // a converted binary scene is preferred, unless outdated (see scene_4km)
+    spdlog::debug("loading scene: {}", path.string());
+    return vierkant_cereal::load_scene_file(path, model_path_fn);
 }
 
 std::optional<std::filesystem::path> PBRViewer::zip_archive_path() const
@@ -1129,19 +1166,246 @@ std::optional<std::filesystem::path> PBRViewer::zip_archive_path() const
     return {};
 }
 
-void PBRViewer::save_asset_bundle(const vierkant::model::model_assets_t &mesh_assets,
-                                  const std::filesystem::path &path) const
-{ vierkant_cereal::save_bundle_file(mesh_assets, path, zip_archive_path()); }
+std::shared_ptr<vierkant_cereal::bundle_archive_writer> PBRViewer::bundle_writer() const
+{
+    auto zip_path = zip_archive_path();
+    std::lock_guard lock(m_bundle_writer_mutex);
+    if(!zip_path) { return nullptr; }
 
-std::optional<vierkant::model::model_assets_t> PBRViewer::load_asset_bundle(const std::filesystem::path &path) const
-{ return vierkant_cereal::load_model_bundle_file(path, m_project_root / g_zip_path); }
+    // bundles are compressed synchronously by the (background-)thread adding them
+    if(!m_bundle_writer || m_bundle_writer->archive_path() != *zip_path)
+    {
+        m_bundle_writer = std::make_shared<vierkant_cereal::bundle_archive_writer>(*zip_path);
+    }
+    return m_bundle_writer;
+}
+
+std::shared_ptr<vierkant_cereal::bundle_manifest> PBRViewer::model_manifest() const
+{
+    auto manifest_path =
+            m_project_root / g_cache_path / g_model_store_path / vierkant_cereal::bundle_manifest::default_filename;
+    std::lock_guard lock(m_model_manifest_mutex);
+
+    if(!m_model_manifest || m_model_manifest->path() != manifest_path)
+    {
+        if(m_model_manifest) { m_model_manifest->save(); }
+        m_model_manifest = std::make_shared<vierkant_cereal::bundle_manifest>(manifest_path);
+    }
+    return m_model_manifest;
+}
+
+vierkant_cereal::texture_store PBRViewer::model_texture_store() const
+{
+    // same store as cache_4km's default, for bundles in the model-store
+    return vierkant_cereal::texture_store(
+            vierkant_cereal::texture_store::default_directory(m_project_root / g_cache_path / g_model_store_path));
+}
+
+void PBRViewer::checkpoint_bundle_archive()
+{
+    std::shared_ptr<vierkant_cereal::bundle_archive_writer> writer;
+    {
+        std::lock_guard lock(m_bundle_writer_mutex);
+        writer = m_bundle_writer;
+    }
+    std::shared_ptr<vierkant_cereal::bundle_manifest> manifest;
+    {
+        std::lock_guard lock(m_model_manifest_mutex);
+        manifest = m_model_manifest;
+    }
+    bool commit_archive = writer && writer->num_pending();
+    bool save_manifest = manifest && manifest->modified();
+    if(!(commit_archive || save_manifest) || m_bundle_checkpoint_running.exchange(true)) { return; }
+
+    // bundles are committed before the manifest referencing them
+    background_queue().post([this, writer, manifest, commit_archive]() {
+        try
+        {
+            if(commit_archive) { writer->checkpoint(); }
+            if(manifest) { manifest->save(); }
+        } catch(std::exception &e) { spdlog::error(e.what()); }
+        m_bundle_checkpoint_running = false;
+    });
+}
+
+void PBRViewer::save_asset_bundle(vierkant::model::model_assets_t mesh_assets, const std::filesystem::path &path) const
+{
+    if(auto writer = bundle_writer()) { writer->add(std::move(mesh_assets), path); }
+    else { vierkant_cereal::save_bundle_file(mesh_assets, path); }
+}
+
+std::optional<vierkant::model::model_assets_t> PBRViewer::load_asset_bundle(const std::filesystem::path &path,
+                                                                              uint32_t max_texture_extent)
+{
+    // sections and textures are decoded concurrently on the background-queue
+    return vierkant_cereal::load_model_bundle_file(path, m_project_root / g_zip_path,
+                                                   vierkant_cereal::all_bundle_sections, &background_queue(),
+                                                   max_texture_extent);
+}
+
+PBRViewer::resident_textures_t PBRViewer::resident_stored_textures(const vierkant::model::model_assets_t &assets)
+{
+    std::unordered_map<vierkant::TextureId, std::vector<std::pair<vierkant::texture_key_t, vierkant::ImagePtr>>> found;
+    std::vector<vierkant::TextureId> missing;
+    {
+        std::unique_lock lock(m_stored_texture_mutex);
+        for(const auto &material: assets.materials)
+        {
+            for(const auto &[type, texture_data]: material.texture_data)
+            {
+                if(assets.textures.contains(texture_data.texture_id)) { continue; }
+
+                bool resident = false;
+                for(const auto &key: {vierkant::texture_key_t{texture_data.texture_id, texture_data.sampler_id},
+                                      vierkant::texture_key_t{texture_data.texture_id, vierkant::SamplerId::nil()}})
+                {
+                    auto it = m_stored_textures.find(key);
+                    if(it == m_stored_textures.end()) { continue; }
+                    if(auto image = it->second.lock())
+                    {
+                        found[texture_data.texture_id].emplace_back(key, std::move(image));
+                        resident = true;
+                    }
+                }
+                if(!resident) { missing.push_back(texture_data.texture_id); }
+            }
+        }
+    }
+
+    // a texture is only shared, if images for all its texture-keys are resident
+    resident_textures_t ret;
+    for(auto &[texture_id, images]: found)
+    {
+        if(std::ranges::find(missing, texture_id) != missing.end()) { continue; }
+        ret.ids.push_back(texture_id);
+        ret.images.insert(std::make_move_iterator(images.begin()), std::make_move_iterator(images.end()));
+    }
+    return ret;
+}
+
+void PBRViewer::share_stored_textures(const vierkant_cereal::texture_store &texture_store,
+                                      const vierkant::model::model_assets_t &assets,
+                                      const vierkant::model::load_mesh_result_t &mesh_result)
+{
+    std::vector<vierkant::TextureId> stored_ids;
+    for(const auto &id: vierkant_cereal::texture_store::referenced_ids(assets))
+    {
+        if(texture_store.contains(id)) { stored_ids.push_back(id); }
+    }
+    if(stored_ids.empty()) { return; }
+
+    std::unique_lock lock(m_stored_texture_mutex);
+    std::erase_if(m_stored_textures, [](const auto &item) { return item.second.expired(); });
+
+    for(const auto &material: assets.materials)
+    {
+        for(const auto &[type, texture_data]: material.texture_data)
+        {
+            if(std::ranges::find(stored_ids, texture_data.texture_id) == stored_ids.end()) { continue; }
+            for(const auto &key: {vierkant::texture_key_t{texture_data.texture_id, texture_data.sampler_id},
+                                  vierkant::texture_key_t{texture_data.texture_id, vierkant::SamplerId::nil()}})
+            {
+                auto it = mesh_result.textures.find(key);
+                if(it != mesh_result.textures.end()) { m_stored_textures[key] = it->second; }
+            }
+        }
+    }
+}
+
+void PBRViewer::stream_texture_levels(const std::filesystem::path &bundle_path,
+                                      vierkant_cereal::texture_map_t textures,
+                                      const vierkant::model::load_mesh_result_t &mesh_result)
+{
+    // GPU-textures of the mesh, backed by block-compressed textures
+    struct gpu_texture_t
+    {
+        vierkant::TextureId texture_id;
+        vierkant::texture_key_t key;
+        vierkant::ImagePtr image;
+    };
+    std::vector<gpu_texture_t> gpu_textures;
+
+    for(const auto &[material_id, material]: mesh_result.materials)
+    {
+        for(const auto &[type, texture_data]: material.texture_data)
+        {
+            auto it = textures.find(texture_data.texture_id);
+            if(it == textures.end() || !std::holds_alternative<vierkant::bcn::compress_result_t>(it->second))
+            {
+                continue;
+            }
+            for(const auto &key: {vierkant::texture_key_t{texture_data.texture_id, texture_data.sampler_id},
+                                  vierkant::texture_key_t{texture_data.texture_id, vierkant::SamplerId::nil()}})
+            {
+                auto image_it = mesh_result.textures.find(key);
+                if(image_it != mesh_result.textures.end())
+                {
+                    gpu_textures.push_back({texture_data.texture_id, key, image_it->second});
+                }
+            }
+        }
+    }
+    if(gpu_textures.empty()) { return; }
+
+    background_queue().post([this, bundle_path, textures = std::move(textures),
+                             gpu_textures = std::move(gpu_textures)]() mutable {
+        auto num_resident = [&textures](const vierkant::TextureId &id) {
+            const auto &compressed = std::get<vierkant::bcn::compress_result_t>(textures.at(id));
+            return static_cast<size_t>(
+                    std::ranges::count_if(compressed.levels, [](const auto &level) { return !level.empty(); }));
+        };
+        std::unordered_map<vierkant::TextureId, size_t> initial_levels;
+        for(const auto &gpu_texture: gpu_textures)
+        {
+            initial_levels[gpu_texture.texture_id] = num_resident(gpu_texture.texture_id);
+        }
+
+        const uint32_t max_texture_extent = m_settings.max_texture_extent;
+        size_t num_levels = vierkant_cereal::load_texture_levels_file(bundle_path, zip_archive_path(), textures,
+                                                                      max_texture_extent, &background_queue())
+                                    .value_or(0);
+
+        // stored textures are refined from their texture-store files, levels are only added to missing ones
+        auto texture_store = model_texture_store();
+        for(const auto &[texture_id, levels]: initial_levels)
+        {
+            if(!texture_store.contains(texture_id)) { continue; }
+            num_levels += vierkant_cereal::load_texture_levels_file(texture_store.file_path(texture_id), {}, textures,
+                                                                    max_texture_extent, &background_queue())
+                                  .value_or(0);
+        }
+        if(!num_levels) { return; }
+
+        // replace GPU-textures, keeping their format and sampler-state
+        for(const auto &gpu_texture: gpu_textures)
+        {
+            if(num_resident(gpu_texture.texture_id) == initial_levels[gpu_texture.texture_id]) { continue; }
+            const auto &compressed = std::get<vierkant::bcn::compress_result_t>(textures.at(gpu_texture.texture_id));
+            auto image = vierkant::model::create_compressed_texture(m_device, compressed, gpu_texture.image->format(),
+                                                                    m_queue_image_loading);
+            m_scene->asset_provider()->add_texture(gpu_texture.key, image);
+
+            // meshes loaded later share the refined texture
+            std::unique_lock lock(m_stored_texture_mutex);
+            if(auto it = m_stored_textures.find(gpu_texture.key); it != m_stored_textures.end())
+            {
+                it->second = image;
+            }
+        }
+        spdlog::debug("streamed {} texture-levels for {} textures: {}", num_levels, gpu_textures.size(),
+                      bundle_path.filename().string());
+    });
+}
 
 void PBRViewer::save_material_bundle(const vierkant::material_data_t &material_data,
                                      const std::filesystem::path &path) const
-{ vierkant_cereal::save_bundle_file(material_data, path, zip_archive_path()); }
+{
+    if(auto writer = bundle_writer()) { writer->add(material_data, path); }
+    else { vierkant_cereal::save_bundle_file(material_data, path); }
+}
 
-std::optional<vierkant::material_data_t> PBRViewer::load_material_bundle(const std::filesystem::path &path) const
-{ return vierkant_cereal::load_material_bundle_file(path, m_project_root / g_zip_path); }
+std::optional<vierkant::material_data_t> PBRViewer::load_material_bundle(const std::filesystem::path &path)
+{ return vierkant_cereal::load_material_bundle_file(path, m_project_root / g_zip_path, &background_queue()); }
 
 bool PBRViewer::parse_override_settings(int argc, char *argv[])
 {
@@ -429,6 +429,33 @@ void PBRViewer::create_ui()
                     ImGui::Checkbox("physics debug-draw", &m_settings.draw_physics);
                     ImGui::Checkbox("draw node hierarchy", &m_settings.draw_node_hierarchy);
                     ImGui::Checkbox("texture compression", &m_settings.texture_compression);
+
+                    // applies to subsequently loaded bundles
+                    constexpr uint32_t texture_extents[] = {0, 4096, 2048, 1024, 512, 256};
+                    const char *texture_extent_items[] = {"unlimited", "4096", "2048", "1024", "512", "256"};
+                    int texture_extent_index = 0;
+                    for(int i = 0; i < IM_ARRAYSIZE(texture_extents); ++i)
+                    {
+                        if(texture_extents[i] == m_settings.max_texture_extent) { texture_extent_index = i; }
+                    }
+                    if(ImGui::Combo("max texture-extent", &texture_extent_index, texture_extent_items,
+                                    IM_ARRAYSIZE(texture_extent_items)))
+                    {
+                        m_settings.max_texture_extent = texture_extents[texture_extent_index];
+                    }
+
+                    // first extent of progressively loaded textures, index 0 disables streaming
+                    int initial_extent_index = 0;
+                    for(int i = 0; i < IM_ARRAYSIZE(texture_extents); ++i)
+                    {
+                        if(texture_extents[i] == m_settings.initial_texture_extent) { initial_extent_index = i; }
+                    }
+                    const char *initial_extent_items[] = {"off", "4096", "2048", "1024", "512", "256"};
+                    if(ImGui::Combo("initial texture-extent", &initial_extent_index, initial_extent_items,
+                                    IM_ARRAYSIZE(initial_extent_items)))
+                    {
+                        m_settings.initial_texture_extent = texture_extents[initial_extent_index];
+                    }
                     ImGui::Checkbox("opacity micromaps", &m_settings.opacity_micromaps);
                     ImGui::Checkbox("remap indices", &m_settings.mesh_buffer_params.remap_indices);
                     ImGui::Checkbox("optimize vertex cache", &m_settings.mesh_buffer_params.optimize_vertex_cache);
@@ -0,0 +1,116 @@
+//
+// scene_4km - convert scene-json into lossless binary '.scene4k' scenes, which are loaded instead when present.
+// the json stays the editable source of truth: binaries record the json's hash and are ignored by loaders,
+// once the json changed. '--to-json' never overwrites an existing json, unless '--force' is given.
+//
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include <cxxopts.hpp>
+#include <spdlog/spdlog.h>
+#include <spdlog/stopwatch.h>
+
+#include <vierkant_cereal/vierkant_cereal.hpp>
+
+//! write a binary scene back as json, e.g. for inspection
+static bool convert_to_json(const std::filesystem::path &binary_path, const std::filesystem::path &json_path)
+{
+    std::ifstream ifs(binary_path, std::ios_base::in | std::ios_base::binary);
+    auto scene_data = ifs.is_open() ? vierkant_cereal::load_scene_data(ifs) : std::nullopt;
+    if(!scene_data)
+    {
+        spdlog::error("could not load scene '{}'", binary_path.string());
+        return false;
+    }
+    std::ofstream ofs(json_path);
+    vierkant_cereal::save_scene_data(ofs, *scene_data, vierkant_cereal::scene_format_t::Json);
+    return ofs.good();
+}
+
+int main(int argc, char *argv[])
+{
+    cxxopts::Options options(argv[0], "convert scene-json into binary '.scene4k' scenes\n");
+    options.positional_help("<scene-file>...");
+    // clang-format off
+    options.add_options()
+        ("files", "input scene-files (.json, or .scene4k with '--to-json')", cxxopts::value<std::vector<std::string>>())
+        ("o,output", "output-path, only for a single input-file (default: next to the input)", cxxopts::value<std::string>())
+        ("to-json", "convert binary scenes back into json")
+        ("f,force", "overwrite existing json-files with '--to-json'")
+        ("v,verbose", "verbose logging")
+        ("h,help", "print this help message");
+    // clang-format on
+    options.parse_positional("files");
+
+    cxxopts::ParseResult result;
+    try
+    {
+        result = options.parse(argc, argv);
+    } catch(const std::exception &e)
+    {
+        spdlog::error(e.what());
+        return EXIT_FAILURE;
+    }
+
+    if(result.count("help"))
+    {
+        spdlog::set_pattern("%v");
+        spdlog::info("\n{}", options.help());
+        return EXIT_SUCCESS;
+    }
+    spdlog::set_level(result.count("verbose") ? spdlog::level::debug : spdlog::level::info);
+
+    if(!result.count("files"))
+    {
+        spdlog::error("no input-files provided\n{}", options.help());
+        return EXIT_FAILURE;
+    }
+    const auto files = result["files"].as<std::vector<std::string>>();
+    if(result.count("output") && files.size() != 1)
+    {
+        spdlog::error("'--output' requires a single input-file");
+        return EXIT_FAILURE;
+    }
+    const bool to_json = result.count("to-json") > 0;
+    const bool force = result.count("force") > 0;
+
+    int num_failed = 0;
+    for(const auto &file: files)
+    {
+        spdlog::stopwatch sw;
+        std::filesystem::path output_path;
+        if(result.count("output")) { output_path = result["output"].as<std::string>(); }
+        else if(to_json) { output_path = std::filesystem::path(file).replace_extension(".json"); }
+        else { output_path = vierkant_cereal::scene_binary_path(file); }
+
+        if(output_path == std::filesystem::path(file))
+        {
+            spdlog::error("'{}': input- and output-path are the same", file);
+            ++num_failed;
+            continue;
+        }
+
+        // json-files are the editable source, possibly with edits not yet converted
+        std::error_code ec;
+        if(to_json && !force && std::filesystem::exists(output_path, ec))
+        {
+            spdlog::error("'{}': output '{}' exists, use '--force' to overwrite it", file, output_path.string());
+            ++num_failed;
+            continue;
+        }
+
+        bool converted = to_json ? convert_to_json(file, output_path)
+                                 : vierkant_cereal::convert_scene_file(file, output_path);
+        if(!converted)
+        {
+            ++num_failed;
+            continue;
+        }
+        spdlog::info("converted '{}' ({} bytes) -> '{}' ({} bytes) ({})", file, std::filesystem::file_size(file, ec),
+                     output_path.string(), std::filesystem::file_size(output_path, ec), sw.elapsed());
+    }
+    if(num_failed) { spdlog::warn("{} file(s) failed", num_failed); }
+    return num_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
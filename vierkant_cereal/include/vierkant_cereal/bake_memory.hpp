@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+
+namespace vierkant_cereal
+{
+
+//! decoded inputs and baked bundles exceed the encoded input-files by roughly this factor
+constexpr uint64_t bake_memory_factor = 8;
+
+//! total size in bytes of a model-file and the files it references (see model_dependencies)
+uint64_t model_files_size(const std::filesystem::path &model_path);
+
+//! coarse estimate for the peak memory used while baking a model-file, including referenced files
+uint64_t estimate_bake_memory(const std::filesystem::path &model_path);
+
+//! memory_budget_t admits bake-jobs, as long as their estimated memory fits into a budget
+class memory_budget_t
+{
+public:
+    //! 'max_bytes' = 0: unlimited
+    explicit memory_budget_t(uint64_t max_bytes) : m_max_bytes(max_bytes) {}
+
+    //! blocks until 'num_bytes' fit into the budget. a job exceeding the budget alone is admitted, once nothing else runs
+    void acquire(uint64_t num_bytes)
+    {
+        std::unique_lock lock(m_mutex);
+        m_cond.wait(lock, [&] { return !m_max_bytes || !m_num_used || m_num_used + num_bytes <= m_max_bytes; });
+        m_num_used += num_bytes;
+    }
+
+    void release(uint64_t num_bytes)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_num_used -= num_bytes;
+        }
+        m_cond.notify_all();
+    }
+
+private:
+    uint64_t m_max_bytes = 0;
+    uint64_t m_num_used = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+}// namespace vierkant_cereal
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+
+#include <crocore/ThreadPoolClassic.hpp>
+#include <vierkant/Material.hpp>
+#include <vierkant/model/model_loading.hpp>
+#include <vierkant_cereal/geometry_codec.hpp>
+#include <vierkant_cereal/texture_codec.hpp>
+#include <vierkant_cereal/vierkant_cereal.hpp>
+#include <vierkant_cereal/ziparchive.h>
+
+namespace vierkant_cereal
+{
+
+/**
+ * @brief   bundle_archive_writer is a long-lived writer, storing many bundles into a single zip-archive.
+ *
+ * added bundles are queued, serialized and compressed on worker-threads and kept compressed in memory.
+ * all queued bundles are committed with a single archive-rewrite, at explicit checkpoints or on destruction.
+ */
+class bundle_archive_writer
+{
+public:
+    //! sizes of a staged bundle
+    struct entry_size_t
+    {
+        //! serialized size
+        uint64_t size = 0;
+
+        //! size stored in the archive
+        uint64_t stored_size = 0;
+
+        //! serialization- and compression-times of model-bundles
+        save_stats_t save_stats;
+    };
+
+    /**
+     * @brief   create a writer for a zip-archive.
+     *
+     * @param   zip_archive     path to a zip-archive, created on first commit if not existing.
+     * @param   pool            optional thread-pool used for serialization/compression.
+     *                          if not provided, bundles are compressed synchronously when added.
+     * @param   async           queue bundles onto 'pool'. otherwise bundles are compressed synchronously when added,
+     *                          with 'pool' only encoding the sections of a bundle concurrently.
+     */
+    explicit bundle_archive_writer(std::filesystem::path zip_archive, crocore::ThreadPoolClassic *pool = nullptr,
+                                   bool async = true);
+
+    bundle_archive_writer(const bundle_archive_writer &) = delete;
+    bundle_archive_writer &operator=(const bundle_archive_writer &) = delete;
+
+    //! commits all pending bundles
+    ~bundle_archive_writer();
+
+    /**
+     * @brief   queue a model-asset-bundle.
+     *
+     * @param   assets          baked model-assets
+     * @param   path            bundle-path, translated into an archive-relative entry-name.
+     * @param   texture_codec   codec for uncompressed textures
+     * @param   geometry_codec  codec for geometry
+     * @return  future for the entry's sizes, available once the bundle is staged
+     */
+    std::shared_future<entry_size_t> add(vierkant::model::model_assets_t assets, const std::filesystem::path &path,
+                                         texture_codec_t texture_codec = default_texture_codec,
+                                         geometry_codec_t geometry_codec = default_geometry_codec);
+
+    /**
+     * @brief   queue a material-bundle.
+     *
+     * @param   material_data   material-data
+     * @param   path            bundle-path, translated into an archive-relative entry-name.
+     * @param   texture_codec   codec for uncompressed textures
+     * @return  future for the entry's sizes, available once the bundle is staged
+     */
+    std::shared_future<entry_size_t> add(vierkant::material_data_t material_data, const std::filesystem::path &path,
+                                         texture_codec_t texture_codec = default_texture_codec);
+
+    /**
+     * @brief   'checkpoint' waits for all queued bundles and commits them to the archive with a single rewrite.
+     *
+     * @return  the number of committed bundles.
+     */
+    size_t checkpoint();
+
+    //! number of bundles queued since the last checkpoint.
+    [[nodiscard]] size_t num_pending() const;
+
+    //! path of the zip-archive
+    [[nodiscard]] const std::filesystem::path &archive_path() const { return m_archive_path; }
+
+private:
+    struct staged_entry_t
+    {
+        std::filesystem::path entry_path;
+        std::shared_ptr<const vierkant::ziparchive::compressed_entry_t> compressed;
+    };
+
+    std::shared_future<entry_size_t> enqueue(const std::filesystem::path &path, std::optional<int> level,
+                                             std::function<void(std::ostream &)> writer,
+                                             std::shared_ptr<const save_stats_t> save_stats = {});
+
+    std::filesystem::path m_archive_path;
+
+    crocore::ThreadPoolClassic *m_pool = nullptr;
+
+    bool m_async = true;
+
+    mutable std::mutex m_mutex;
+
+    //! serializes checkpoints, while new bundles can still be queued
+    std::mutex m_checkpoint_mutex;
+
+    std::vector<std::future<staged_entry_t>> m_pending;
+};
+
+}// namespace vierkant_cereal
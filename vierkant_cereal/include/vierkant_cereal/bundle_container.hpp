@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <optional>
+#include <vector>
+
+#include <crocore/ThreadPoolClassic.hpp>
+
+namespace vierkant_cereal
+{
+
+//! bundle-container ---------------------------------------------------------------------------
+//
+// a sectioned container for bundles. layout (header and toc are always little-endian):
+//
+//  header:   magic "4KMS" | version (u8) | payload-endianness (u8) | schema-version (u16) | num_sections (u32)
+//  toc:      num_sections x section_entry_t (type, codec, key, offset, size, raw_size, hash)
+//  payload:  section-data, stored back-to-back at the offsets given in the toc
+//
+// offsets are relative to the beginning of the container. hashes (xxh64) cover the stored bytes,
+// so sections are verified before decoding. section-payloads use the writer's native endianness,
+// recorded in the header and rejected by readers with a different one. the schema-version is application-defined
+// (see bundle_schema.hpp), 0 for containers written without one.
+
+//! magic bytes identifying a bundle-container
+constexpr char bundle_container_magic[4] = {'4', 'K', 'M', 'S'};
+
+//! container-format version
+constexpr uint8_t bundle_container_version = 1;
+
+//! codecs for stored section-data
+enum class section_codec_t : uint32_t
+{
+    None = 0,
+    Zstd
+};
+
+//! toc-entry describing a single section
+struct section_entry_t
+{
+    //! application-defined section-type
+    uint32_t type = 0;
+
+    //! codec used for the stored bytes
+    section_codec_t codec = section_codec_t::None;
+
+    //! optional application-defined key, distinguishing multiple sections of the same type
+    uint64_t key = 0;
+
+    //! byte-offset relative to the beginning of the container
+    uint64_t offset = 0;
+
+    //! number of stored bytes
+    uint64_t size = 0;
+
+    //! number of bytes after decoding
+    uint64_t raw_size = 0;
+
+    //! xxh64 of the stored bytes
+    uint64_t hash = 0;
+};
+
+//! a section, encoded and ready to be written into a container
+struct encoded_section_t
+{
+    uint32_t type = 0;
+    uint64_t key = 0;
+    section_codec_t codec = section_codec_t::None;
+    uint64_t raw_size = 0;
+    uint64_t hash = 0;
+    std::vector<uint8_t> data;
+
+    //! time spent serializing (running the writer) and compressing the raw section-data
+    double serialize_seconds = 0.0;
+    double compress_seconds = 0.0;
+};
+
+/**
+ * @brief   'encode_section' serializes and encodes a section.
+ *
+ * @param   type    application-defined section-type
+ * @param   key     application-defined key
+ * @param   writer  function writing the raw section-data into the provided std::ostream
+ * @param   codec   codec used for the stored bytes
+ * @return  an encoded section
+ */
+encoded_section_t encode_section(uint32_t type, uint64_t key, const std::function<void(std::ostream &)> &writer,
+                                 section_codec_t codec = section_codec_t::Zstd);
+
+/**
+ * @brief   'write_bundle_container' writes header, toc and all sections into a std::ostream.
+ *
+ * @param   os              output-stream
+ * @param   sections        encoded sections, written in the given order
+ * @param   schema_version  application-defined schema-version of the section-payloads
+ */
+void write_bundle_container(std::ostream &os, const std::vector<encoded_section_t> &sections,
+                            uint16_t schema_version = 0);
+
+/**
+ * @brief   'read_bundle_toc' reads header and toc from the current stream-position.
+ *          if the stream does not start with a bundle-container, its position is restored and nothing is returned.
+ *          throws std::runtime_error for corrupt or incompatible containers.
+ *
+ * @param   is              a seekable input-stream, positioned at the beginning of a container
+ * @param   schema_version  optional output for the schema-version of the section-payloads
+ * @return  the table of contents, with offsets relative to the initial stream-position
+ */
+std::optional<std::vector<section_entry_t>> read_bundle_toc(std::istream &is, uint16_t *schema_version = nullptr);
+
+/**
+ * @brief   'read_section' reads the stored bytes of a section.
+ *
+ * @param   is      a seekable input-stream
+ * @param   base    stream-position of the container's beginning
+ * @param   entry   toc-entry for the section
+ * @return  the stored (still encoded) bytes
+ */
+std::vector<uint8_t> read_section(std::istream &is, std::streamoff base, const section_entry_t &entry);
+
+/**
+ * @brief   'decode_section' verifies and decodes the stored bytes of a section.
+ *          throws std::runtime_error on hash-mismatch or decoding-errors.
+ *
+ * @param   entry   toc-entry for the section
+ * @param   stored  stored bytes, as returned by 'read_section'
+ * @return  the decoded section-data
+ */
+std::vector<uint8_t> decode_section(const section_entry_t &entry, std::vector<uint8_t> stored);
+
+/**
+ * @brief   'parallel_for' runs fn(i) for all i in [0, num) on a thread-pool, with the calling thread participating.
+ *          the caller never blocks on tasks which have not started yet, so it's safe to call from within pool-tasks.
+ *          the first exception thrown by fn is rethrown after all started work is done.
+ *
+ * @param   num     number of work-items
+ * @param   fn      work-function
+ * @param   pool    optional thread-pool. if not provided, all items run on the calling thread.
+ */
+void parallel_for(size_t num, const std::function<void(size_t)> &fn, crocore::ThreadPoolClassic *pool);
+
+}// namespace vierkant_cereal
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+#include <vierkant/model/model_loading.hpp>
+
+namespace vierkant_cereal
+{
+
+//! counts of merged duplicates, see 'deduplicate_model_assets'
+struct dedup_result_t
+{
+    //! number of mesh-entries now sharing the geometry of an identical, earlier entry
+    size_t num_geometries = 0;
+
+    //! number of removed materials and texture-samplers
+    size_t num_materials = 0;
+    size_t num_samplers = 0;
+
+    //! number of bytes removed from vertex-, index- and meshlet-buffers
+    size_t num_bytes = 0;
+};
+
+/**
+ * @brief   'deduplicate_model_assets' merges identical texture-samplers, materials and entry-geometries
+ *          of model-assets and remaps all references.
+ *
+ * - samplers: identical samplers collapse into one, referenced by materials
+ * - materials: materials equal in everything but id and name collapse into the first one,
+ *              referenced by mesh-entries via material-index
+ * - geometry: mesh-entries with identical vertices, indices, lods and meshlets share a single range
+ *             in the buffers of a mesh_buffer_bundle_t, unreferenced ranges are removed.
+ *             entries keep their transforms, nodes and materials. entries with morph-targets are left as is.
+ *
+ * @param   assets  model-assets, containing a mesh_buffer_bundle_t
+ * @return  counts of merged duplicates
+ */
+dedup_result_t deduplicate_model_assets(vierkant::model::model_assets_t &assets);
+
+}// namespace vierkant_cereal
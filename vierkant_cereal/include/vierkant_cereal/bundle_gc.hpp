@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+#include <crocore/ThreadPoolClassic.hpp>
+#include <vierkant_cereal/bundle_manifest.hpp>
+
+namespace vierkant_cereal
+{
+
+class texture_store;
+
+//! parameters for 'collect_bundle_garbage'
+struct bundle_gc_params_t
+{
+    //! directory containing model-bundles and their manifest
+    std::filesystem::path bundle_dir;
+
+    //! optional zip-archive, containing model-bundles for 'bundle_dir' (see bundle_entry_path)
+    std::optional<std::filesystem::path> zip_archive;
+
+    //! maximum size of bundles and stored textures in bytes, least-recently used bundles are evicted (0: unlimited)
+    uint64_t max_size = 0;
+
+    //! remove bundles with an unsupported schema-version or from missing/modified model-files
+    bool remove_stale = true;
+
+    //! optional texture-store, only shared by bundles in 'bundle_dir'. unreferenced textures are removed.
+    const vierkant_cereal::texture_store *texture_store = nullptr;
+
+    //! only determine what would be removed
+    bool dry_run = false;
+
+    //! optional thread-pool, used to read bundle-materials concurrently
+    crocore::ThreadPoolClassic *pool = nullptr;
+};
+
+//! what 'collect_bundle_garbage' removed
+struct bundle_gc_result_t
+{
+    //! number of bundles found, as plain files or archive-entries
+    size_t num_bundles = 0;
+
+    //! number of removed stale and evicted bundles
+    size_t num_stale = 0;
+    size_t num_evicted = 0;
+
+    //! number of removed textures from the texture-store
+    size_t num_textures = 0;
+
+    //! size of bundles and stored textures in bytes, before and after
+    uint64_t size_before = 0;
+    uint64_t size_after = 0;
+};
+
+/**
+ * @brief   'collect_bundle_garbage' removes stale model-bundles and evicts least-recently used ones,
+ *          until bundles and stored textures fit into 'max_size'.
+ *
+ * - bundles are found as plain files in 'bundle_dir' and as entries of 'zip_archive'.
+ * - last-access is taken from the manifest (see bundle_manifest::touch), unrecorded bundles use their file-time.
+ * - stale: recorded with a schema-version, which can't be migrated, or the model-file is missing or modified.
+ *   unrecorded bundles are never considered stale.
+ * - stored textures are shared, they are only freed once no remaining bundle references them.
+ *   references are read from all found bundles, recorded or not.
+ * - bundles merged from other archives (e.g. 'cache_4km --merge') are unrecorded: they are never stale and
+ *   evicted by the archive's file-time. their textures keep being referenced, but must have been merged into the
+ *   texture-store as well (see texture_store::merge). references to missing textures are ignored.
+ * - archive-entries are removed with a single archive-rewrite, which also compacts the archive.
+ * - records of removed bundles are removed from 'manifest', saving it is left to the caller.
+ *
+ * @param   manifest    the manifest for 'bundle_dir'
+ * @param   params      gc-parameters
+ * @return  what was removed (or would be, for a dry-run)
+ */
+bundle_gc_result_t collect_bundle_garbage(bundle_manifest &manifest, const bundle_gc_params_t &params);
+
+}// namespace vierkant_cereal
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+
+namespace vierkant_cereal
+{
+
+/**
+ * @brief   'model_content_hash' computes a content-hash (xxh64) for a model-file and all files it references
+ *          (see model_dependencies). missing files contribute a fixed marker.
+ *
+ * @param   model_path  path to a model-file
+ * @return  the content-hash
+ */
+uint64_t model_content_hash(const std::filesystem::path &model_path);
+
+/**
+ * @brief   bundle_manifest records what baked bundles were built from, stored as json next to the bundles.
+ *
+ * content-hashes of input-files are cached by size and modification-time, so unchanged inputs are
+ * recognized without reading them. all methods are thread-safe.
+ */
+class bundle_manifest
+{
+public:
+    //! cached content-hash of a file, valid while size and modification-time are unchanged
+    struct file_stamp_t
+    {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0;
+
+        template<class Archive>
+        void serialize(Archive &archive)
+        {
+            archive(cereal::make_nvp("size", size), cereal::make_nvp("mtime", mtime), cereal::make_nvp("hash", hash));
+        }
+    };
+
+    //! what a bundle was built from
+    struct bundle_record_t
+    {
+        //! absolute path of the model-file
+        std::string model_path;
+        uint64_t content_hash = 0;
+        std::vector<std::string> dependencies;
+
+        //! bundle-schema version the bundle was baked with, 0 if unknown (records upgraded from version 1)
+        uint32_t schema_version = 0;
+
+        //! last time the bundle was baked or used, in seconds since epoch. 0 if unknown.
+        int64_t last_access = 0;
+
+        template<class Archive>
+        void serialize(Archive &archive)
+        {
+            archive(cereal::make_nvp("model_path", model_path), cereal::make_nvp("content_hash", content_hash),
+                    cereal::make_nvp("dependencies", dependencies), cereal::make_nvp("schema_version", schema_version),
+                    cereal::make_nvp("last_access", last_access));
+        }
+    };
+
+    //! canonical filename for manifests, next to the bundles
+    static constexpr char default_filename[] = "manifest.json";
+
+    //! manifest-format version
+    static constexpr uint32_t version = 2;
+
+    /**
+     * @brief   create a manifest, loading existing contents from 'path'.
+     *          manifests of version 1 are upgraded, written with the current version on the next save.
+     *
+     * @param   path    path of the manifest-file
+     */
+    explicit bundle_manifest(std::filesystem::path path);
+
+    bundle_manifest(const bundle_manifest &) = delete;
+    bundle_manifest &operator=(const bundle_manifest &) = delete;
+
+    //! content-hash for a model-file and its dependencies (see model_content_hash), using cached file-hashes.
+    uint64_t content_hash(const std::filesystem::path &model_path);
+
+    //! record a bundle, built from 'model_path' with 'content_hash'
+    void record(const std::filesystem::path &bundle_path, const std::filesystem::path &model_path,
+                uint64_t content_hash);
+
+    //! mark a recorded bundle as used, bundles are evicted by last-access (see collect_bundle_garbage)
+    void touch(const std::filesystem::path &bundle_path);
+
+    //! update the schema-version of a recorded bundle, e.g. after migrating it. returns true, if a record was found.
+    bool set_schema_version(const std::filesystem::path &bundle_path, uint32_t schema_version);
+
+    //! remove the record for a bundle. returns true, if a record was removed.
+    bool remove(const std::filesystem::path &bundle_path);
+
+    //! the record for a bundle, if any
+    [[nodiscard]] std::optional<bundle_record_t> find(const std::filesystem::path &bundle_path) const;
+
+    //! all bundle-records, by bundle-filename
+    [[nodiscard]] std::map<std::string, bundle_record_t> records() const;
+
+    //! true, if modified since loading or saving
+    [[nodiscard]] bool modified() const;
+
+    /**
+     * @brief   'save' writes the manifest, if modified. the file is replaced atomically.
+     *
+     * @return  true, if the manifest is stored on disk.
+     */
+    bool save();
+
+    //! path of the manifest-file
+    [[nodiscard]] const std::filesystem::path &path() const { return m_path; }
+
+private:
+    uint64_t file_hash(const std::filesystem::path &path);
+
+    std::filesystem::path m_path;
+
+    mutable std::mutex m_mutex;
+
+    //! cached file-stamps, by normalized path
+    std::map<std::string, file_stamp_t> m_files;
+
+    //! bundle-records, by bundle-filename
+    std::map<std::string, bundle_record_t> m_bundles;
+
+    bool m_modified = false;
+};
+
+}// namespace vierkant_cereal
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+#include <crocore/ThreadPoolClassic.hpp>
+#include <vierkant_cereal/bundle_manifest.hpp>
+#include <vierkant_cereal/geometry_codec.hpp>
+#include <vierkant_cereal/texture_codec.hpp>
+
+namespace vierkant_cereal
+{
+
+class texture_store;
+
+//! parameters for 'migrate_bundles'
+struct bundle_migration_params_t
+{
+    //! directory containing model-bundles and their manifest
+    std::filesystem::path bundle_dir;
+
+    //! optional zip-archive, containing model-bundles for 'bundle_dir' (see bundle_entry_path)
+    std::optional<std::filesystem::path> zip_archive;
+
+    //! optional texture-store, its texture-files are migrated as well
+    const vierkant_cereal::texture_store *texture_store = nullptr;
+
+    //! codecs used for re-encoding migrated bundles
+    texture_codec_t texture_codec = default_texture_codec;
+    geometry_codec_t geometry_codec = default_geometry_codec;
+
+    //! migrated archive-entries are committed after this many bundles (0: once at the end)
+    uint32_t checkpoint_interval = 64;
+
+    //! ... or once the staged entries exceed this many stored bytes (0: unlimited)
+    uint64_t checkpoint_bytes = uint64_t(256) << 20;
+
+    //! only determine what would be migrated
+    bool dry_run = false;
+
+    //! optional thread-pool, used to decode and encode bundles concurrently
+    crocore::ThreadPoolClassic *pool = nullptr;
+};
+
+//! what 'migrate_bundles' did
+struct bundle_migration_result_t
+{
+    //! number of bundles found, as plain files or archive-entries
+    size_t num_bundles = 0;
+
+    //! number of bundles upgraded to the current schema-version
+    size_t num_migrated = 0;
+
+    //! number of texture-files found in the texture-store and upgraded to the current schema-version
+    size_t num_textures = 0;
+    size_t num_textures_migrated = 0;
+
+    //! number of bundles (or texture-files) with a schema-version, which can't be migrated.
+    //! those are re-baked (or removed by gc)
+    size_t num_unsupported = 0;
+
+    //! number of bundles (or texture-files), which could not be read or written
+    size_t num_failed = 0;
+};
+
+/**
+ * @brief   'migrate_bundles' upgrades model-bundles with an older schema-version in place, without re-baking them.
+ *
+ * - bundles are found as plain files in 'bundle_dir' and as entries of 'zip_archive'.
+ *   plain files take precedence over archive-entries with the same name, as for loading.
+ * - bundles are loaded (through compatibility-paths and registered migrations) and saved with the current
+ *   schema-version, one at a time. plain files are replaced atomically,
+ *   archive-entries are replaced in batches (see 'checkpoint_interval', 'checkpoint_bytes'),
+ *   each committed with a single archive-rewrite.
+ * - texture-files of 'params.texture_store' are upgraded the same way, they are replaced atomically.
+ * - schema-versions of migrated bundles are updated in 'manifest', saving it is left to the caller.
+ *
+ * @param   manifest    the manifest for 'bundle_dir'
+ * @param   params      migration-parameters
+ * @return  what was migrated (or would be, for a dry-run)
+ */
+bundle_migration_result_t migrate_bundles(bundle_manifest &manifest, const bundle_migration_params_t &params);
+
+}// namespace vierkant_cereal
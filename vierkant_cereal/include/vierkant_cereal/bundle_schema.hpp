@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include <vierkant/Material.hpp>
+#include <vierkant/model/model_loading.hpp>
+
+namespace vierkant_cereal
+{
+
+//! bundle-schema ------------------------------------------------------------------------------
+//
+// the schema-version of model- and material-bundles is stored in their container-header (see bundle_container.hpp).
+// bumping it does not invalidate existing bundles: older ones are read through compatibility-paths and upgraded by
+// registered migrations. serialize-functions changing their layout branch on 'bundle_schema_scope_t::version()'.
+//
+// schema-versions:
+// - 10: first recorded version. also assumed for bundles written before versioning.
+// - 11: uuids are stored as 16 raw bytes in binary archives, instead of strings (compatibility-path).
+
+//! current schema-version of bundle-payloads. bump on any serialization-change, together with a compatibility-path
+//! and/or a migration (see register_model_migration), so existing bundles are upgraded instead of re-baked.
+constexpr uint32_t bundle_schema_version = 11;
+
+//! first schema-version storing uuids as raw bytes in binary archives
+constexpr uint32_t binary_uuid_schema_version = 11;
+
+//! oldest schema-version, which can still be read and migrated. older bundles are re-baked.
+constexpr uint32_t min_bundle_schema_version = 10;
+
+//! schema-version assumed for bundles without a recorded one (written before versioning)
+constexpr uint32_t unversioned_bundle_schema_version = 10;
+
+//! true, if bundles with 'schema_version' can be loaded, possibly through migrations
+constexpr bool bundle_schema_supported(uint32_t schema_version)
+{
+    return schema_version >= min_bundle_schema_version && schema_version <= bundle_schema_version;
+}
+
+/**
+ * @brief   bundle_schema_scope_t binds the schema-version of bundle-data deserialized on the current thread.
+ *
+ * compatibility-paths in serialize-functions query 'bundle_schema_scope_t::version()', which is the current
+ * schema-version outside of any scope. bound while saving, a scope selects the written layout and schema-version,
+ * e.g. to write bundles of an older schema-version for compatibility-checks.
+ */
+class bundle_schema_scope_t
+{
+public:
+    explicit bundle_schema_scope_t(uint32_t schema_version);
+    ~bundle_schema_scope_t();
+
+    bundle_schema_scope_t(const bundle_schema_scope_t &) = delete;
+    bundle_schema_scope_t &operator=(const bundle_schema_scope_t &) = delete;
+
+    //! schema-version of the scope bound to the current thread or 'bundle_schema_version'
+    static uint32_t version();
+
+private:
+    uint32_t m_version;
+    const bundle_schema_scope_t *m_previous = nullptr;
+};
+
+//! migrations upgrade loaded data from 'from_version' to 'from_version + 1'. they run after deserialization
+//! and have to cope with partially loaded model-assets (see bundle_section_mask_t).
+using model_migration_fn_t = std::function<void(vierkant::model::model_assets_t &)>;
+using material_migration_fn_t = std::function<void(vierkant::material_data_t &)>;
+
+//! register a migration for model-assets from 'from_version' to 'from_version + 1'. thread-safe.
+void register_model_migration(uint32_t from_version, model_migration_fn_t fn);
+
+//! register a migration for material-data from 'from_version' to 'from_version + 1'. thread-safe.
+void register_material_migration(uint32_t from_version, material_migration_fn_t fn);
+
+/**
+ * @brief   'migrate_model_assets' applies all registered migrations from 'schema_version' up to the current one,
+ *          in order of their versions. throws std::runtime_error for unsupported schema-versions.
+ *
+ * @param   assets          model-assets, loaded with 'schema_version'
+ * @param   schema_version  schema-version of the bundle 'assets' were loaded from
+ */
+void migrate_model_assets(vierkant::model::model_assets_t &assets, uint32_t schema_version);
+
+/**
+ * @brief   'migrate_material_data' applies all registered migrations from 'schema_version' up to the current one,
+ *          in order of their versions. throws std::runtime_error for unsupported schema-versions.
+ *
+ * @param   material_data   material-data, loaded with 'schema_version'
+ * @param   schema_version  schema-version of the bundle 'material_data' was loaded from
+ */
+void migrate_material_data(vierkant::material_data_t &material_data, uint32_t schema_version);
+
+}// namespace vierkant_cereal
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <crocore/Image.hpp>
+#include <crocore/ThreadPoolClassic.hpp>
+
+namespace vierkant_cereal
+{
+
+/**
+ * @brief   deferred_image_decoder collects encoded image-payloads during deserialization,
+ *          to decode them afterwards, concurrently on a thread-pool.
+ *
+ * a decoder is bound to the deserializing thread via a scope_t. while bound, loading a crocore::Image_
+ * only reads its encoded payload and queues it, leaving the image empty until 'run' is called.
+ * multiple threads can be bound to the same decoder.
+ */
+class deferred_image_decoder
+{
+public:
+    //! binds a decoder to the current thread for the lifetime of the scope
+    class scope_t
+    {
+    public:
+        explicit scope_t(deferred_image_decoder &decoder);
+        ~scope_t();
+
+        scope_t(const scope_t &) = delete;
+        scope_t &operator=(const scope_t &) = delete;
+
+    private:
+        deferred_image_decoder *m_previous = nullptr;
+    };
+
+    deferred_image_decoder() = default;
+    deferred_image_decoder(const deferred_image_decoder &) = delete;
+    deferred_image_decoder &operator=(const deferred_image_decoder &) = delete;
+
+    //! images still queued are decoded synchronously
+    ~deferred_image_decoder();
+
+    //! the decoder bound to the current thread or nullptr
+    static deferred_image_decoder *current();
+
+    /**
+     * @brief   queue an encoded payload for an image.
+     *
+     * @param   image   target-image, must stay valid until 'run' is called
+     * @param   payload encoded image-data
+     */
+    void push(crocore::Image_<uint8_t> *image, std::vector<uint8_t> payload);
+
+    /**
+     * @brief   'run' decodes all queued images. throws std::runtime_error if an image could not be decoded.
+     *
+     * @param   pool    optional thread-pool. if not provided, images are decoded on the calling thread.
+     */
+    void run(crocore::ThreadPoolClassic *pool);
+
+    //! number of queued images
+    [[nodiscard]] size_t size() const;
+
+private:
+    struct task_t
+    {
+        crocore::Image_<uint8_t> *image = nullptr;
+        std::vector<uint8_t> payload;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<task_t> m_tasks;
+};
+
+}// namespace vierkant_cereal
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+#include <cereal/archives/binary.hpp>
+#include <vierkant/model/model_loading.hpp>
+
+namespace vierkant_cereal
+{
+
+//! codecs for the geometry-section of model-bundles. sections are zstd-compressed in either case.
+enum class geometry_codec_t : uint32_t
+{
+    //! plain serialized buffers
+    Zstd = 0,
+
+    //! vertex-, index- and meshlet-vertex-buffers pre-encoded with meshoptimizer's codecs,
+    //! falls back to Zstd if unsupported
+    Meshopt
+};
+
+//! codec used for geometry, unless selected otherwise
+constexpr geometry_codec_t default_geometry_codec = geometry_codec_t::Meshopt;
+
+//! true, if a codec is available in this build
+bool geometry_codec_supported(geometry_codec_t codec);
+
+/**
+ * @brief   'encode_geometry' serializes a mesh_buffer_bundle_t, with buffers encoded by meshoptimizer's
+ *          vertex- and index-codecs. buffers not suitable for those (e.g. strides not a multiple of 4) are stored as is.
+ *          throws std::runtime_error if the codec is unsupported.
+ *
+ * @param   archive             a binary output-archive
+ * @param   bundle              a mesh_buffer_bundle_t
+ * @param   preserve_triangles  keep the exact vertex-order within triangles, e.g. for opacity-micromaps.
+ *                              otherwise triangles may be rotated (keeping order and winding), which compresses better.
+ *                              bundles with entries other than triangle-lists always keep their index-order.
+ */
+void encode_geometry(cereal::BinaryOutputArchive &archive, const vierkant::mesh_buffer_bundle_t &bundle,
+                     bool preserve_triangles);
+
+/**
+ * @brief   'decode_geometry' deserializes a mesh_buffer_bundle_t written by 'encode_geometry'.
+ *          decoding uses SIMD, where available. throws std::runtime_error for corrupt data or an unsupported codec.
+ *
+ * @param   archive a binary input-archive
+ * @param   bundle  the decoded mesh_buffer_bundle_t
+ */
+void decode_geometry(cereal::BinaryInputArchive &archive, vierkant::mesh_buffer_bundle_t &bundle);
+
+}// namespace vierkant_cereal
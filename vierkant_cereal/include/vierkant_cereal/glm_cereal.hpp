@@ -4,7 +4,12 @@
 
 #pragma once
 
+#include <type_traits>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
 #include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
 #include <vierkant/math.hpp>
 
 namespace glm
@@ -54,3 +59,61 @@ void serialize(Archive &archive, glm::qua<T, glm::defaultp> &q)
 }
 
 }// namespace glm
+
+namespace vierkant_cereal
+{
+
+//! element-types, which binary archives read and write as one contiguous block, when stored in a std::vector.
+//! requires the type's in-memory layout to equal its serialized layout (no padding, members in serialization-order).
+template<typename T>
+struct is_bulk_serializable : std::false_type
+{};
+
+template<glm::length_t L, typename T>
+struct is_bulk_serializable<glm::vec<L, T, glm::defaultp>>
+    : std::bool_constant<std::is_arithmetic_v<T> && L >= 2 && sizeof(glm::vec<L, T, glm::defaultp>) == L * sizeof(T)>
+{};
+
+template<glm::length_t L, typename T>
+struct is_bulk_serializable<glm::mat<L, L, T, glm::defaultp>>
+    : std::bool_constant<std::is_arithmetic_v<T> && L >= 2 &&
+                         sizeof(glm::mat<L, L, T, glm::defaultp>) == L * L * sizeof(T)>
+{};
+
+// quaternions are serialized as x, y, z, w
+#if !defined(GLM_FORCE_QUAT_DATA_WXYZ)
+template<typename T>
+struct is_bulk_serializable<glm::qua<T, glm::defaultp>>
+    : std::bool_constant<std::is_arithmetic_v<T> && sizeof(glm::qua<T, glm::defaultp>) == 4 * sizeof(T)>
+{};
+#endif
+
+template<typename T>
+constexpr bool is_bulk_serializable_v = is_bulk_serializable<T>::value;
+
+}// namespace vierkant_cereal
+
+namespace cereal
+{
+
+// bulk-serialization of vectors with glm-types, producing the same bytes as element-wise serialization.
+// restricted to native-endian binary archives, portable archives swap bytes per element and keep the generic path.
+template<class T, class A>
+inline std::enable_if_t<vierkant_cereal::is_bulk_serializable_v<T>>
+CEREAL_SAVE_FUNCTION_NAME(BinaryOutputArchive &ar, const std::vector<T, A> &vector)
+{
+    ar(make_size_tag(static_cast<size_type>(vector.size())));
+    ar(binary_data(vector.data(), vector.size() * sizeof(T)));
+}
+
+template<class T, class A>
+inline std::enable_if_t<vierkant_cereal::is_bulk_serializable_v<T>>
+CEREAL_LOAD_FUNCTION_NAME(BinaryInputArchive &ar, std::vector<T, A> &vector)
+{
+    size_type size;
+    ar(make_size_tag(size));
+    vector.resize(static_cast<std::size_t>(size));
+    ar(binary_data(vector.data(), static_cast<std::size_t>(size) * sizeof(T)));
+}
+
+}// namespace cereal
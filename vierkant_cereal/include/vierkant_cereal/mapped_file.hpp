@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <streambuf>
+
+namespace vierkant_cereal
+{
+
+class mapped_file;
+using mapped_file_ptr = std::shared_ptr<const mapped_file>;
+
+/**
+ * @brief   mapped_file provides a read-only memory-mapping of an entire file.
+ *
+ * the mapping is released when the last reference goes away, so consumers can keep it alive
+ * by holding on to the shared_ptr returned by mapped_file::open.
+ */
+class mapped_file
+{
+public:
+    /**
+     * @brief   open and memory-map a file.
+     *
+     * @param   path    path to an existing, non-empty file
+     * @return  a shared mapping or nullptr, if the file could not be mapped.
+     */
+    static mapped_file_ptr open(const std::filesystem::path &path);
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    ~mapped_file();
+
+    [[nodiscard]] const uint8_t *data() const { return m_data; }
+
+    [[nodiscard]] size_t size() const { return m_size; }
+
+    /**
+     * @brief   hint that a range was consumed and won't be needed soon.
+     *          resident pages are dropped (re-faulted from the file on next access).
+     *
+     * @param   offset  byte-offset into the mapping
+     * @param   num_bytes   number of bytes
+     */
+    void release(size_t offset, size_t num_bytes) const;
+
+private:
+    mapped_file() = default;
+
+    const uint8_t *m_data = nullptr;
+    size_t m_size = 0;
+
+#if defined(_WIN32)
+    void *m_file_handle = nullptr;
+    void *m_mapping_handle = nullptr;
+#endif
+};
+
+/**
+ * @brief   memory_streambuf is a seekable, read-only std::streambuf over a contiguous memory-range.
+ *
+ * bulk-reads (sgetn) are served by a single memcpy from the underlying memory, without an intermediate buffer.
+ * an optional mapped_file can be provided as owner, in which case consumed pages are released while reading.
+ */
+class memory_streambuf : public std::streambuf
+{
+public:
+    memory_streambuf(const uint8_t *data, size_t num_bytes, mapped_file_ptr owner = {});
+
+protected:
+    std::streamsize xsgetn(char *s, std::streamsize n) override;
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+    void release_consumed();
+
+    mapped_file_ptr m_owner;
+    size_t m_num_released = 0;
+};
+
+/**
+ * @brief   mapped_istream is a std::istream reading from a memory-mapped file.
+ */
+class mapped_istream : public std::istream
+{
+public:
+    explicit mapped_istream(mapped_file_ptr mapped_file);
+
+    [[nodiscard]] const mapped_file_ptr &file() const { return m_file; }
+
+private:
+    mapped_file_ptr m_file;
+    memory_streambuf m_streambuf;
+};
+
+}// namespace vierkant_cereal
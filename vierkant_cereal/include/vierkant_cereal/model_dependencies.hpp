@@ -0,0 +1,23 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+namespace vierkant_cereal
+{
+
+/**
+ * @brief   'model_dependencies' lists the files referenced by a model-file.
+ *
+ * - glTF/GLB: external buffers and images
+ * - OBJ: material-libraries and the textures they reference
+ *
+ * relative references are resolved against the model's directory, embedded (data-URI) resources are skipped.
+ * referenced files are not required to exist. unreadable or unknown model-files have no dependencies.
+ *
+ * @param   model_path  path to a model-file
+ * @return  paths of all referenced files, in order of appearance
+ */
+std::vector<std::filesystem::path> model_dependencies(const std::filesystem::path &model_path);
+
+}// namespace vierkant_cereal
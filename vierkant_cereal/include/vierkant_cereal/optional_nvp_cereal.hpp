@@ -12,6 +12,15 @@
 #include <cereal/archives/binary.hpp>
 #include <cereal/archives/json.hpp>
 
+namespace vierkant_cereal
+{
+
+//! true, if the current node of a JSONInputArchive contains a member 'name'. never throws.
+//! relies on internals of the pinned cereal-version, checked at compile-time (see optional_nvp_cereal.cpp).
+bool json_has_member(const cereal::JSONInputArchive &archive, const char *name);
+
+}// namespace vierkant_cereal
+
 namespace cereal
 {
 
@@ -66,18 +75,14 @@ inline void CEREAL_SAVE_FUNCTION_NAME(JSONOutputArchive &ar, OptionalNameValuePa
 template<class T>
 inline void CEREAL_LOAD_FUNCTION_NAME(JSONInputArchive &ar, OptionalNameValuePair<T> &t)
 {
-    ar.setNextName(t.name);
-
-    try
-    {
-        ar(t.value);
-    } catch(const Exception &e)
+    // absent members are detected upfront, instead of unwinding cereal's 'not found'-exception
+    if(!vierkant_cereal::json_has_member(ar, t.name))
     {
-        ar.setNextName(nullptr);
-
-        if(std::string(e.what()).find("provided NVP (" + std::string(t.name)) == std::string::npos) { throw; }
-        else { t.value = t.defaultValue; }
+        t.value = t.defaultValue;
+        return;
     }
+    ar.setNextName(t.name);
+    ar(t.value);
 }
 
 }// namespace cereal
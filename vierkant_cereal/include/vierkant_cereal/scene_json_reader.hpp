@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <optional>
+#include <string>
+
+#include <vierkant_cereal/scene_data.hpp>
+
+namespace vierkant_cereal
+{
+
+//! invoked for each model-path of a scene, as soon as it was read
+using scene_model_path_fn_t = std::function<void(const vierkant::MeshId &mesh_id, const std::string &path)>;
+
+/**
+ * @brief   'read_scene_json' reads scene-json incrementally, without parsing the whole document into memory.
+ *
+ * - the document is read with a SAX-parser, in a single pass.
+ * - elements of 'nodes', 'materials', 'lights', 'model_paths', 'scene_paths' and 'texture_samplers' are
+ *   deserialized in small batches, peak memory is bounded by the largest element instead of the document.
+ * - model-paths are passed to 'model_path_fn' as soon as their member was read. cereal writes them before
+ *   'nodes', so loading meshes can start while nodes are still being parsed.
+ * - equivalent to deserializing with cereal::JSONInputArchive, unknown members are ignored.
+ *
+ * throws std::runtime_error for malformed documents.
+ *
+ * @param   is              input-stream containing scene-json (as written by save_scene_data)
+ * @param   model_path_fn   optional callback for model-paths
+ * @return  the scene-data
+ */
+scene_data_t read_scene_json(std::istream &is, const scene_model_path_fn_t &model_path_fn = {});
+
+}// namespace vierkant_cereal
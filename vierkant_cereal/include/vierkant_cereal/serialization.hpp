@@ -12,6 +12,10 @@
 #pragma GCC diagnostic ignored "-Wdangling-reference"
 #endif
 
+#include <array>
+#include <stdexcept>
+#include <string>
+
 #include <cereal/archives/binary.hpp>
 #include <cereal/archives/json.hpp>
 #include <cereal/cereal.hpp>
@@ -24,9 +28,12 @@
 #include <cereal/types/vector.hpp>
 
 #include "animation_cereal.hpp"
+#include "bundle_schema.hpp"
 #include "collision_cereal.hpp"
+#include "deferred_image_decoder.hpp"
 #include "glm_cereal.hpp"
 #include "optional_nvp_cereal.hpp"
+#include "texture_codec.hpp"
 
 #include <crocore/NamedId.hpp>
 #include <crocore/set_lru.hpp>
@@ -40,6 +47,51 @@
 #include <vierkant/texture_block_compression.hpp>
 #include <vierkant/transform.hpp>
 
+namespace vierkant_cereal
+{
+
+//! raw bytes of a uuid
+using uuid_bytes_t = std::array<uint8_t, 16>;
+
+//! parse the raw bytes of a uuid from its canonical string-form ("xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx")
+inline uuid_bytes_t uuid_bytes(const std::string &uuid_str)
+{
+    auto hex_value = [&uuid_str](char c) -> uint8_t {
+        if(c >= '0' && c <= '9') { return static_cast<uint8_t>(c - '0'); }
+        if(c >= 'a' && c <= 'f') { return static_cast<uint8_t>(c - 'a' + 10); }
+        if(c >= 'A' && c <= 'F') { return static_cast<uint8_t>(c - 'A' + 10); }
+        throw std::runtime_error("invalid uuid '" + uuid_str + "'");
+    };
+    uuid_bytes_t ret = {};
+    size_t num_digits = 0;
+    for(char c: uuid_str)
+    {
+        if(c == '-') { continue; }
+        if(num_digits == 2 * ret.size()) { throw std::runtime_error("invalid uuid '" + uuid_str + "'"); }
+        ret[num_digits / 2] = static_cast<uint8_t>(ret[num_digits / 2] << 4 | hex_value(c));
+        num_digits++;
+    }
+    if(num_digits != 2 * ret.size()) { throw std::runtime_error("invalid uuid '" + uuid_str + "'"); }
+    return ret;
+}
+
+//! canonical string-form of a uuid's raw bytes
+inline std::string uuid_string(const uuid_bytes_t &bytes)
+{
+    constexpr char hex_digits[] = "0123456789abcdef";
+    std::string ret;
+    ret.reserve(36);
+    for(size_t i = 0; i < bytes.size(); ++i)
+    {
+        if(i == 4 || i == 6 || i == 8 || i == 10) { ret.push_back('-'); }
+        ret.push_back(hex_digits[bytes[i] >> 4]);
+        ret.push_back(hex_digits[bytes[i] & 0xF]);
+    }
+    return ret;
+}
+
+}// namespace vierkant_cereal
+
 namespace cereal
 {
 
@@ -68,14 +120,47 @@ void serialize(Archive &archive, vierkant::bcn::compress_result_t &compress_resu
 namespace crocore
 {
 
-template<class Archive, class T>
+//! text-archives (json) store uuids as strings
+template<class Archive, class T,
+         cereal::traits::EnableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
 std::string save_minimal(Archive const &, const crocore::NamedUUID<T> &named_id)
 { return named_id.str(); }
 
-template<class Archive, class T>
+template<class Archive, class T,
+         cereal::traits::EnableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
 void load_minimal(Archive const &, crocore::NamedUUID<T> &named_id, const std::string &uuid_str)
 { named_id = crocore::NamedUUID<T>::from_string(uuid_str); }
 
+//! binary archives store uuids as 16 raw bytes, older schema-versions as strings
+template<class Archive, class T,
+         cereal::traits::DisableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
+void save(Archive &archive, const crocore::NamedUUID<T> &named_id)
+{
+    if(vierkant_cereal::bundle_schema_scope_t::version() < vierkant_cereal::binary_uuid_schema_version)
+    {
+        archive(named_id.str());
+        return;
+    }
+    auto bytes = vierkant_cereal::uuid_bytes(named_id.str());
+    archive(cereal::binary_data(bytes.data(), bytes.size()));
+}
+
+template<class Archive, class T,
+         cereal::traits::DisableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
+void load(Archive &archive, crocore::NamedUUID<T> &named_id)
+{
+    if(vierkant_cereal::bundle_schema_scope_t::version() < vierkant_cereal::binary_uuid_schema_version)
+    {
+        std::string uuid_str;
+        archive(uuid_str);
+        named_id = crocore::NamedUUID<T>::from_string(uuid_str);
+        return;
+    }
+    vierkant_cereal::uuid_bytes_t bytes;
+    archive(cereal::binary_data(bytes.data(), bytes.size()));
+    named_id = crocore::NamedUUID<T>::from_string(vierkant_cereal::uuid_string(bytes));
+}
+
 template<class Archive, class T>
 void serialize(Archive &archive, crocore::set_lru<T> &set_lru)
 {
@@ -86,14 +171,26 @@ void serialize(Archive &archive, crocore::set_lru<T> &set_lru)
 
 template<class Archive>
 void save(Archive &archive, const crocore::Image_<unsigned char> &img)
-{ archive(crocore::encode_png(img)); }
+{
+    // codec and optional pre-encoded payloads are selected per thread
+    const auto *codec_scope = vierkant_cereal::texture_codec_scope_t::current();
+    if(const auto *payload = codec_scope ? codec_scope->payload(&img) : nullptr) { archive(*payload); }
+    else
+    {
+        auto codec = codec_scope ? codec_scope->codec() : vierkant_cereal::default_texture_codec;
+        archive(vierkant_cereal::encode_texture(img, codec));
+    }
+}
 
 template<class Archive>
 void load(Archive &archive, crocore::Image_<unsigned char> &img)
 {
     std::vector<uint8_t> array;
     archive(array);
-    img = std::move(*std::dynamic_pointer_cast<crocore::Image_<unsigned char>>(crocore::create_image_from_data(array)));
+
+    // decoding is deferred, when a decoder is bound to this thread
+    if(auto *decoder = vierkant_cereal::deferred_image_decoder::current()) { decoder->push(&img, std::move(array)); }
+    else { img = vierkant_cereal::decode_texture(array); }
 }
 
 }// namespace crocore
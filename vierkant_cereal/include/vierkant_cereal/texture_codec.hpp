@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <crocore/Image.hpp>
+
+namespace vierkant_cereal
+{
+
+//! codecs for uncompressed texture-payloads. payloads are self-describing, the codec is detected when decoding.
+enum class texture_codec_t : uint32_t
+{
+    //! PNG, slow but widely compatible
+    Png = 0,
+
+    //! QOI ("quite ok image"), fast lossless codec for 3/4 components, falls back to RawZstd otherwise
+    Qoi,
+
+    //! raw pixel-data, zstd-compressed
+    RawZstd
+};
+
+//! codec used for textures, unless selected otherwise
+constexpr texture_codec_t default_texture_codec = texture_codec_t::Qoi;
+
+//! pre-encoded texture-payloads, by image
+using texture_payload_map_t = std::unordered_map<const crocore::Image *, std::vector<uint8_t>>;
+
+/**
+ * @brief   'encode_texture' encodes an image into a self-describing payload.
+ *
+ * @param   img     an image
+ * @param   codec   the codec to use
+ * @return  the encoded payload
+ */
+std::vector<uint8_t> encode_texture(const crocore::Image_<uint8_t> &img, texture_codec_t codec);
+
+/**
+ * @brief   'decode_texture' decodes a payload created by 'encode_texture' (or any format supported by
+ *          crocore::create_image_from_data). throws std::runtime_error on failure.
+ *
+ * @param   payload encoded image-data
+ * @return  the decoded image
+ */
+crocore::Image_<uint8_t> decode_texture(const std::vector<uint8_t> &payload);
+
+//! detect the codec of an encoded payload. nothing is returned for unknown formats.
+std::optional<texture_codec_t> detect_texture_codec(const std::vector<uint8_t> &payload);
+
+/**
+ * @brief   texture_codec_scope_t selects the codec for textures serialized on the current thread.
+ *
+ * an optional map of pre-encoded payloads can be provided, e.g. encoded concurrently ahead of serialization.
+ */
+class texture_codec_scope_t
+{
+public:
+    explicit texture_codec_scope_t(texture_codec_t codec, const texture_payload_map_t *payloads = nullptr);
+    ~texture_codec_scope_t();
+
+    texture_codec_scope_t(const texture_codec_scope_t &) = delete;
+    texture_codec_scope_t &operator=(const texture_codec_scope_t &) = delete;
+
+    //! the scope bound to the current thread or nullptr
+    static const texture_codec_scope_t *current();
+
+    [[nodiscard]] texture_codec_t codec() const { return m_codec; }
+
+    //! a pre-encoded payload for 'img' or nullptr
+    [[nodiscard]] const std::vector<uint8_t> *payload(const crocore::Image *img) const;
+
+private:
+    texture_codec_t m_codec;
+    const texture_payload_map_t *m_payloads = nullptr;
+    const texture_codec_scope_t *m_previous = nullptr;
+};
+
+}// namespace vierkant_cereal
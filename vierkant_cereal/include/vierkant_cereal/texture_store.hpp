@@ -0,0 +1,125 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <crocore/Image.hpp>
+#include <crocore/ThreadPoolClassic.hpp>
+#include <vierkant_cereal/vierkant_cereal.hpp>
+
+namespace vierkant_cereal
+{
+
+/**
+ * @brief   texture_store is a project-wide, content-addressed store for textures shared across model-bundles.
+ *
+ * texture-ids are derived from source-pixels and compression-setting, so equal textures in different models
+ * share an id and are compressed, stored and loaded once. each texture is stored as a separate bundle-file
+ * (textures and texture-levels sections only). model-bundles omit stored textures and reference them by id.
+ * all methods are thread-safe, stored files are published atomically.
+ */
+class texture_store
+{
+public:
+    using texture_id_t = texture_map_t::key_type;
+    using texture_t = texture_map_t::mapped_type;
+
+    //! suffix for stored texture-files
+    static constexpr char file_suffix[] = "4kt";
+
+    //! name of the default store-directory, next to the bundle-directory
+    static constexpr char default_directory_name[] = "textures";
+
+    /**
+     * @brief   'default_directory' returns the default store-directory for bundles in 'bundle_directory'.
+     *          derived from the absolute, normalized path, so spellings like "cache/models/" or
+     *          "./cache/models" resolve to the same store.
+     *
+     * @param   bundle_directory    directory containing model-bundles
+     * @return  the sibling directory 'default_directory_name'
+     */
+    static std::filesystem::path default_directory(const std::filesystem::path &bundle_directory);
+
+    /**
+     * @brief   create a store in a directory, created when storing the first texture.
+     *
+     * @param   directory       directory containing stored texture-files
+     * @param   texture_codec   codec for uncompressed textures
+     */
+    explicit texture_store(std::filesystem::path directory, texture_codec_t texture_codec = default_texture_codec);
+
+    /**
+     * @brief   'content_id' derives a texture-id from source-pixels and compression-setting.
+     *
+     * @param   img         a source-image
+     * @param   compress    whether the texture is block-compressed
+     * @return  a content-derived texture-id
+     */
+    static texture_id_t content_id(const crocore::Image_<uint8_t> &img, bool compress);
+
+    //! true, if a texture is stored
+    [[nodiscard]] bool contains(const texture_id_t &id) const;
+
+    //! store a texture, unless contained already. returns true, if the texture is stored afterwards.
+    bool store(const texture_id_t &id, const texture_t &texture) const;
+
+    /**
+     * @brief   load a stored texture.
+     *
+     * @param   id                  a texture-id
+     * @param   pool                optional thread-pool, used to decode concurrently
+     * @param   max_texture_extent  cap for the resolution of block-compressed textures (0: unlimited)
+     * @return  the texture or nothing, if not stored
+     */
+    std::optional<texture_t> load(const texture_id_t &id, crocore::ThreadPoolClassic *pool = nullptr,
+                                  uint32_t max_texture_extent = 0) const;
+
+    /**
+     * @brief   'merge' copies stored textures from another store-directory (e.g. of a cache_4km-shard).
+     *          textures are content-addressed, contained ones are skipped.
+     *
+     * @param   directory   directory of another texture-store
+     * @return  the number of copied textures
+     */
+    size_t merge(const std::filesystem::path &directory) const;
+
+    //! remove stored textures from 'textures', so model-bundles only reference them. returns the number removed.
+    size_t strip(texture_map_t &textures) const;
+
+    //! ids of all textures referenced by materials in 'assets', contained or not
+    static std::vector<texture_id_t> referenced_ids(const vierkant::model::model_assets_t &assets);
+
+    //! load stored textures, referenced by materials but missing in 'assets'. textures in 'skip_ids' are not loaded,
+    //! e.g. when already resident on the GPU. returns false, if any other referenced texture could not be resolved.
+    bool resolve(vierkant::model::model_assets_t &assets, crocore::ThreadPoolClassic *pool = nullptr,
+                 uint32_t max_texture_extent = 0, std::span<const texture_id_t> skip_ids = {}) const;
+
+    /**
+     * @brief   'assign_content_ids' replaces the ids of source-images in 'assets' with content-derived ones
+     *          (see content_id), updating all references. equal images collapse into a single texture.
+     *
+     * only 8-bit images are hashed, others keep their ids. only textures with a content-id must be stored or
+     * loaded, other ids are not derived from content and could refer to stale textures.
+     *
+     * @param   assets      model-assets with source-images
+     * @param   compress    whether textures will be block-compressed
+     * @param   pool        optional thread-pool, used to hash images concurrently
+     * @return  the distinct content-ids assigned
+     */
+    static std::vector<texture_id_t> assign_content_ids(vierkant::model::model_assets_t &assets, bool compress,
+                                                        crocore::ThreadPoolClassic *pool = nullptr);
+
+    //! path of the file for a stored texture
+    [[nodiscard]] std::filesystem::path file_path(const texture_id_t &id) const;
+
+    //! directory containing stored texture-files
+    [[nodiscard]] const std::filesystem::path &directory() const { return m_directory; }
+
+private:
+    std::filesystem::path m_directory;
+    texture_codec_t m_texture_codec;
+};
+
+}// namespace vierkant_cereal
@@ -4,24 +4,141 @@
 #include <iosfwd>
 #include <optional>
 
+#include <cereal/cereal.hpp>
 #include <vierkant/Material.hpp>
 #include <vierkant/model/model_loading.hpp>
+#include <vierkant_cereal/bundle_dedup.hpp>
+#include <vierkant_cereal/bundle_schema.hpp>
+#include <vierkant_cereal/geometry_codec.hpp>
 #include <vierkant_cereal/scene_data.hpp>
+#include <vierkant_cereal/scene_json_reader.hpp>
+#include <vierkant_cereal/texture_codec.hpp>
 
 namespace vierkant_cereal
 {
 
-void save(std::ostream &os, const vierkant::model::model_assets_t &assets);
-std::optional<vierkant::model::model_assets_t> load_model_assets(std::istream &is);
+//! sections of a model-asset-bundle, stored individually and loadable independently
+enum class bundle_section_t : uint32_t
+{
+    Geometry = 0,
+    Materials,
+    Textures,
+    TextureSamplers,
+    Nodes,
+    OmmData,
+    Lights,
+
+    //! levels of block-compressed textures, one section per level (smallest first)
+    TextureLevels
+};
+
+//! bitmask of bundle-sections
+using bundle_section_mask_t = uint32_t;
+
+constexpr bundle_section_mask_t bundle_section_bit(bundle_section_t section)
+{ return 1U << static_cast<uint32_t>(section); }
+
+constexpr bundle_section_mask_t all_bundle_sections = ~0U;
+
+//! map of textures, as contained in model-assets and material-data
+using texture_map_t = decltype(vierkant::model::model_assets_t::textures);
+
+//! time spent saving a model-bundle, summed over all threads (so it can exceed the wall-time)
+struct save_stats_t
+{
+    //! serializing sections into binary archives
+    double serialize_seconds = 0.0;
+
+    //! encoding uncompressed textures (see texture_codec_t) and compressing sections
+    double compress_seconds = 0.0;
+};
+
+//! model-assets are stored as sectioned bundle-container (see bundle_container.hpp).
+//! sections and uncompressed textures are encoded concurrently, if a thread-pool is provided.
+//! levels of block-compressed textures are stored in separate sections, smallest first.
+//! the textures-section only keeps their dimensions and level-counts.
+//! geometry is encoded with 'geometry_codec', loading detects the codec.
+//! optional 'stats' receive serialization- and compression-times.
+void save(std::ostream &os, const vierkant::model::model_assets_t &assets, crocore::ThreadPoolClassic *pool = nullptr,
+          texture_codec_t texture_codec = default_texture_codec,
+          geometry_codec_t geometry_codec = default_geometry_codec, save_stats_t *stats = nullptr);
+
+//! load model-assets, restricted to 'sections'. sections are read sequentially. if a thread-pool is provided,
+//! sections and contained images are decoded concurrently. legacy (non-sectioned) bundles are always loaded entirely.
+//! levels of block-compressed textures exceeding 'max_texture_extent' (0: unlimited) are skipped,
+//! the smallest level of each texture is always loaded. without 'TextureLevels', those textures contain no levels.
+//! bundles with an older schema-version are read through compatibility-paths and migrated (see bundle_schema.hpp),
+//! unsupported schema-versions fail to load.
+std::optional<vierkant::model::model_assets_t> load_model_assets(std::istream &is,
+                                                                 bundle_section_mask_t sections = all_bundle_sections,
+                                                                 crocore::ThreadPoolClassic *pool = nullptr,
+                                                                 uint32_t max_texture_extent = 0);
+
+/**
+ * @brief   'load_texture_levels' streams in higher-resolution levels of block-compressed textures,
+ *          previously loaded from the same model-bundle with a lower 'max_texture_extent'.
+ *          missing levels up to 'max_texture_extent' (0: unlimited) are prepended to the resident ones.
+ *
+ * @param   is                  input-stream for a model-bundle
+ * @param   textures            textures loaded from the same model-bundle
+ * @param   max_texture_extent  maximum extent of loaded levels (0: unlimited)
+ * @param   pool                optional thread-pool, used to decode levels concurrently
+ * @return  the number of loaded levels
+ */
+size_t load_texture_levels(std::istream &is, texture_map_t &textures, uint32_t max_texture_extent = 0,
+                           crocore::ThreadPoolClassic *pool = nullptr);
+
+//! material-data is stored as single-section bundle-container, recording the schema-version.
+void save(std::ostream &os, const vierkant::material_data_t &data,
+          texture_codec_t texture_codec = default_texture_codec);
+//! load material-data, contained images are decoded concurrently if a thread-pool is provided.
+//! material-data with an older schema-version is migrated, legacy (non-sectioned) material-data is still supported.
+std::optional<vierkant::material_data_t> load_material_data(std::istream &is,
+                                                            crocore::ThreadPoolClassic *pool = nullptr);
+
+//! scene-data is stored as json (editable source) or binary (fast loading)
+enum class scene_format_t : uint32_t
+{
+    Json = 0,
+
+    //! zstd-compressed, single-section bundle-container, recording the schema-version
+    Binary
+};
 
-void save(std::ostream &os, const vierkant::material_data_t &data);
-std::optional<vierkant::material_data_t> load_material_data(std::istream &is);
+//! canonical suffix for binary scene-files
+constexpr char scene_binary_suffix[] = "scene4k";
 
-void save_scene_data(std::ostream &os, const scene_data_t &data);
-std::optional<scene_data_t> load_scene_data(std::istream &is);
+//! save scene-data. binary scenes record 'source_hash', the xxh64 of the json they were converted from (0: unknown)
+void save_scene_data(std::ostream &os, const scene_data_t &data, scene_format_t format = scene_format_t::Json,
+                     uint64_t source_hash = 0);
+
+//! load scene-data, json or binary are detected. json is streamed (see read_scene_json),
+//! model-paths are passed to 'model_path_fn' as soon as they were read.
+std::optional<scene_data_t> load_scene_data(std::istream &is, const scene_model_path_fn_t &model_path_fn = {});
+
+//! path of the binary counterpart for a scene-file (e.g. "scene.json" -> "scene.scene4k")
+std::filesystem::path scene_binary_path(const std::filesystem::path &scene_path);
+
+//! load scene-data from 'path'. its binary counterpart (see scene_binary_path) is loaded instead, if present and
+//! converted from the current content of 'path' (by comparing the recorded xxh64, not file-times).
+//! json stays the source of truth: outdated or unreadable binaries are ignored.
+std::optional<scene_data_t> load_scene_file(const std::filesystem::path &path,
+                                            const scene_model_path_fn_t &model_path_fn = {});
+
+/**
+ * @brief   'convert_scene_file' converts a scene-json into its lossless binary form. the file is replaced atomically.
+ *          the binary records the xxh64 of the json, so loaders detect when it is outdated.
+ *
+ * @param   json_path   path to a scene-json
+ * @param   binary_path output-path, by default the binary counterpart (see scene_binary_path)
+ * @return  true, if the scene was converted
+ */
+bool convert_scene_file(const std::filesystem::path &json_path, const std::filesystem::path &binary_path = {});
 
 //! bundle baking --------------------------------------------------------------------------------
 
+class texture_store;
+
 //! parameters controlling how a model-file is baked into a self-contained asset-bundle.
 struct bundle_params_t
 {
@@ -40,46 +157,141 @@ struct bundle_params_t
 
     //! optional thread-pool used to parallelize loading/compression.
     crocore::ThreadPoolClassic *pool = nullptr;
+
+    //! optional content-addressed texture-store. textures get content-derived ids,
+    //! stored textures are loaded instead of compressed again and new ones are added to the store.
+    const vierkant_cereal::texture_store *texture_store = nullptr;
+};
+
+//! statistics of a bake, see create_model_bundle
+struct bake_stats_t
+{
+    //! durations of bake-stages in seconds. 'load' covers parsing the model-file and decoding its images.
+    double load_seconds = 0.0;
+    double mesh_buffers_seconds = 0.0;
+    double dedup_seconds = 0.0;
+    double omm_seconds = 0.0;
+    double texture_store_seconds = 0.0;
+    double compress_textures_seconds = 0.0;
+    double total_seconds = 0.0;
+
+    //! contents of the baked mesh-buffers
+    uint64_t num_entries = 0;
+    uint64_t num_vertices = 0;
+    uint64_t num_indices = 0;
+    uint64_t num_meshlets = 0;
+
+    //! merged duplicates
+    dedup_result_t dedup;
+
+    //! number of textures, thereof loaded from a texture-store
+    uint64_t num_textures = 0;
+    uint64_t num_stored_textures = 0;
+
+    //! texture-bytes before (uncompressed source-images) and after block-compression
+    uint64_t texture_bytes = 0;
+    uint64_t compressed_texture_bytes = 0;
+
+    template<class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(cereal::make_nvp("load_seconds", load_seconds),
+                cereal::make_nvp("mesh_buffers_seconds", mesh_buffers_seconds),
+                cereal::make_nvp("dedup_seconds", dedup_seconds), cereal::make_nvp("omm_seconds", omm_seconds),
+                cereal::make_nvp("texture_store_seconds", texture_store_seconds),
+                cereal::make_nvp("compress_textures_seconds", compress_textures_seconds),
+                cereal::make_nvp("total_seconds", total_seconds), cereal::make_nvp("num_entries", num_entries),
+                cereal::make_nvp("num_vertices", num_vertices), cereal::make_nvp("num_indices", num_indices),
+                cereal::make_nvp("num_meshlets", num_meshlets),
+                cereal::make_nvp("dedup_geometries", dedup.num_geometries),
+                cereal::make_nvp("dedup_materials", dedup.num_materials),
+                cereal::make_nvp("dedup_samplers", dedup.num_samplers),
+                cereal::make_nvp("dedup_bytes", dedup.num_bytes), cereal::make_nvp("num_textures", num_textures),
+                cereal::make_nvp("num_stored_textures", num_stored_textures),
+                cereal::make_nvp("texture_bytes", texture_bytes),
+                cereal::make_nvp("compressed_texture_bytes", compressed_texture_bytes));
+    }
 };
 
 //! canonical suffix for baked asset-bundles.
 constexpr char bundle_file_suffix[] = "4km";
 
-//! schema-version folded into the bundle cache-key; bump on any parsing/serialization change that
-//! would make existing bundles decode wrong, so stale bundles re-bake instead of being mis-read.
-constexpr uint32_t bundle_schema_version = 4;
+//! version folded into the bundle cache-key, independent of the bundle-schema (see bundle_schema.hpp).
+//! bump only if existing bundles can't be migrated, e.g. when baking itself changes (mesh-processing, ids, ...).
+//! started out as the schema-version it replaced in the cache-key, so existing bundle-filenames stay valid.
+constexpr uint32_t bundle_cache_version = 10;
 
-//! compute the canonical bundle-filename for a model (e.g. "model.glb_<hash>.4km"). the hash
-//! covers the filename + bake-parameters + schema-version.
-std::string model_bundle_filename(const std::filesystem::path &model_path,
+//! compute the canonical bundle-filename for a model (e.g. "model.glb_<hash>.4km"). the hash covers the
+//! filename + content-hash (see model_content_hash / bundle_manifest) + bake-parameters + cache-version,
+//! so edited models (or referenced files) re-bake and equally named models in different folders don't collide.
+//! bundles with an older schema-version keep their filename, they are migrated when loaded.
+std::string model_bundle_filename(const std::filesystem::path &model_path, uint64_t content_hash,
                                   const vierkant::mesh_buffer_params_t &mesh_buffer_params, bool compress_textures,
                                   const std::optional<vierkant::model::omm_gen_params_t> &omm_params = {});
 
 //! load a model-file and bake a self-contained asset-bundle (CPU-only, no Vulkan device required).
+//! identical geometries, materials and samplers are merged (see deduplicate_model_assets).
+//! optional 'stats' receive stage-timings and size-statistics.
 std::optional<vierkant::model::model_assets_t> create_model_bundle(const std::filesystem::path &model_path,
-                                                                   const bundle_params_t &params);
+                                                                   const bundle_params_t &params,
+                                                                   bake_stats_t *stats = nullptr);
 
 //! zip-aware bundle file IO ---------------------------------------------------------------------
 //
 // the following helpers (de)serialize bundles to/from a file at 'path'. when an optional
-// 'zip_archive' path is provided, files are stored zstd-compressed inside that archive (the plain
-// file is removed after) and lookups fall back to that archive when the plain file is absent.
+// 'zip_archive' path is provided, files are stored inside that archive instead and lookups fall back
+// to that archive when the plain file is absent. model-bundles are sectioned and compressed per section,
+// they are stored uncompressed in archives (allowing direct seeks), material-bundles are zstd-compressed.
+// plain bundle-files are memory-mapped for loading, so payloads are copied once, straight from the page-cache.
+// bundles are published atomically and writers only serialize per archive: readers never wait for writers.
+
+//! archive-relative entry-name for a bundle-path, keeping machine-local absolute paths out of archives.
+std::filesystem::path bundle_entry_path(const std::filesystem::path &path, const std::filesystem::path &zip_archive);
+
+//! unique path for a temporary file next to 'path', published by renaming it afterwards.
+//! unique across threads and processes writing the same path (e.g. concurrent cache_4km-shards).
+std::filesystem::path temp_file_path(const std::filesystem::path &path);
+
+//! true, if a bundle-file exists at 'path' (or inside 'zip_archive').
+bool has_bundle_file(const std::filesystem::path &path, const std::optional<std::filesystem::path> &zip_archive = {});
 
 //! save a baked model-asset-bundle to 'path' (optionally into 'zip_archive').
+//! for storing many bundles into the same archive, prefer a bundle_archive_writer.
+//! optional 'stats' receive serialization- and compression-times.
 void save_bundle_file(const vierkant::model::model_assets_t &assets, const std::filesystem::path &path,
-                      const std::optional<std::filesystem::path> &zip_archive = {});
+                      const std::optional<std::filesystem::path> &zip_archive = {},
+                      texture_codec_t texture_codec = default_texture_codec,
+                      geometry_codec_t geometry_codec = default_geometry_codec, save_stats_t *stats = nullptr);
+
+//! schema-version of a model- or material-bundle at 'path' (with fallback to 'zip_archive'), read from its header.
+//! bundles written before versioning report 'unversioned_bundle_schema_version'.
+std::optional<uint32_t> load_bundle_schema_version(const std::filesystem::path &path,
+                                                   const std::optional<std::filesystem::path> &zip_archive = {});
 
 //! load a model-asset-bundle from 'path' (with fallback to 'zip_archive').
+//! 'sections' restricts loading to a subset (e.g. only geometry), 'pool' is used to decode sections and
+//! images concurrently. 'max_texture_extent' caps the resolution of block-compressed textures (0: unlimited).
 std::optional<vierkant::model::model_assets_t>
-load_model_bundle_file(const std::filesystem::path &path, const std::optional<std::filesystem::path> &zip_archive = {});
+load_model_bundle_file(const std::filesystem::path &path, const std::optional<std::filesystem::path> &zip_archive = {},
+                       bundle_section_mask_t sections = all_bundle_sections, crocore::ThreadPoolClassic *pool = nullptr,
+                       uint32_t max_texture_extent = 0);
+
+//! stream in higher-resolution levels of block-compressed textures from a model-bundle at 'path'
+//! (with fallback to 'zip_archive'), see 'load_texture_levels'.
+std::optional<size_t> load_texture_levels_file(const std::filesystem::path &path,
+                                               const std::optional<std::filesystem::path> &zip_archive,
+                                               texture_map_t &textures, uint32_t max_texture_extent = 0,
+                                               crocore::ThreadPoolClassic *pool = nullptr);
 
 //! save a material-bundle to 'path' (optionally into 'zip_archive').
 void save_bundle_file(const vierkant::material_data_t &material_data, const std::filesystem::path &path,
-                      const std::optional<std::filesystem::path> &zip_archive = {});
+                      const std::optional<std::filesystem::path> &zip_archive = {},
+                      texture_codec_t texture_codec = default_texture_codec);
 
 //! load a material-bundle from 'path' (with fallback to 'zip_archive').
+//! 'pool' is used to decode contained images concurrently.
 std::optional<vierkant::material_data_t>
-load_material_bundle_file(const std::filesystem::path &path,
-                          const std::optional<std::filesystem::path> &zip_archive = {});
+load_material_bundle_file(const std::filesystem::path &path, const std::optional<std::filesystem::path> &zip_archive = {},
+                          crocore::ThreadPoolClassic *pool = nullptr);
 
 }// namespace vierkant_cereal
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace vierkant_cereal
+{
+
+namespace detail
+{
+constexpr uint64_t xxh64_prime_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t xxh64_prime_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t xxh64_prime_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t xxh64_prime_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t xxh64_prime_5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+//! little-endian loads, compiled into plain loads on little-endian targets
+inline uint64_t read_u64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for(int i = 7; i >= 0; --i) { v = (v << 8) | p[i]; }
+    return v;
+}
+
+inline uint32_t read_u32(const uint8_t *p)
+{
+    uint32_t v = 0;
+    for(int i = 3; i >= 0; --i) { v = (v << 8) | p[i]; }
+    return v;
+}
+
+inline uint64_t xxh64_round(uint64_t acc, uint64_t input)
+{
+    acc += input * xxh64_prime_2;
+    acc = rotl64(acc, 31);
+    return acc * xxh64_prime_1;
+}
+
+inline uint64_t xxh64_merge_round(uint64_t acc, uint64_t val)
+{
+    acc ^= xxh64_round(0, val);
+    return acc * xxh64_prime_1 + xxh64_prime_4;
+}
+}// namespace detail
+
+/**
+ * @brief   'xxh64' computes a 64bit xxHash (XXH64) for a memory-range.
+ *          results are stable across platforms and match the reference implementation.
+ *
+ * @param   data        pointer to data
+ * @param   num_bytes   number of bytes
+ * @param   seed        optional seed
+ * @return  the 64bit hash-value
+ */
+inline uint64_t xxh64(const void *data, size_t num_bytes, uint64_t seed = 0)
+{
+    using namespace detail;
+    auto *p = static_cast<const uint8_t *>(data);
+    const uint8_t *end = p + num_bytes;
+    uint64_t h;
+
+    if(num_bytes >= 32)
+    {
+        uint64_t v1 = seed + xxh64_prime_1 + xxh64_prime_2;
+        uint64_t v2 = seed + xxh64_prime_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - xxh64_prime_1;
+
+        for(const uint8_t *limit = end - 32; p <= limit; p += 32)
+        {
+            v1 = xxh64_round(v1, read_u64(p));
+            v2 = xxh64_round(v2, read_u64(p + 8));
+            v3 = xxh64_round(v3, read_u64(p + 16));
+            v4 = xxh64_round(v4, read_u64(p + 24));
+        }
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh64_merge_round(h, v1);
+        h = xxh64_merge_round(h, v2);
+        h = xxh64_merge_round(h, v3);
+        h = xxh64_merge_round(h, v4);
+    }
+    else { h = seed + xxh64_prime_5; }
+
+    h += static_cast<uint64_t>(num_bytes);
+
+    for(; p + 8 <= end; p += 8)
+    {
+        h ^= xxh64_round(0, read_u64(p));
+        h = rotl64(h, 27) * xxh64_prime_1 + xxh64_prime_4;
+    }
+    if(p + 4 <= end)
+    {
+        h ^= static_cast<uint64_t>(read_u32(p)) * xxh64_prime_1;
+        h = rotl64(h, 23) * xxh64_prime_2 + xxh64_prime_3;
+        p += 4;
+    }
+    for(; p < end; ++p)
+    {
+        h ^= (*p) * xxh64_prime_5;
+        h = rotl64(h, 11) * xxh64_prime_1;
+    }
+
+    h ^= h >> 33;
+    h *= xxh64_prime_2;
+    h ^= h >> 29;
+    h *= xxh64_prime_3;
+    h ^= h >> 32;
+    return h;
+}
+
+//! xxh64 for a string
+inline uint64_t xxh64(std::string_view str, uint64_t seed = 0) { return xxh64(str.data(), str.size(), seed); }
+
+}// namespace vierkant_cereal
@@ -5,6 +5,9 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <vector>
 
 struct zip;
@@ -16,16 +19,66 @@ namespace vierkant
 class ziparchive
 {
 public:
+    /**
+     * @brief   istream for a contained file, reading ahead into an internal buffer.
+     *
+     * seeking is supported, stored (uncompressed) entries seek directly.
+     * compressed entries decode forward to the target-offset (or restart from the beginning for backward seeks).
+     */
     class istream : public std::istream
     {
     public:
-        istream(std::shared_ptr<zip_t> _archive, const std::filesystem::path &file_path);
+        //! default size of the read-ahead buffer in bytes
+        static constexpr size_t default_buffer_size = 1U << 20;
+
+        istream(std::shared_ptr<zip_t> _archive, const std::filesystem::path &file_path,
+                size_t buffer_size = default_buffer_size);
         ~istream() override;
 
     private:
         std::shared_ptr<zip_t> m_archive;
     };
 
+    //! zstd compression-level (1-22) used for archive-entries
+    static constexpr int compression_level = 10;
+
+    //! a zstd-compressed entry, which can be created concurrently and is stored without recompression.
+    struct compressed_entry_t
+    {
+        //! a single zstd-frame or uncompressed data, if 'stored' is set
+        std::vector<uint8_t> data;
+
+        //! data is stored uncompressed, e.g. for already compressed content
+        bool stored = false;
+
+        //! uncompressed size in bytes
+        uint64_t size = 0;
+
+        //! crc32 of the uncompressed data
+        uint32_t crc = 0;
+    };
+
+    /**
+     * @brief   'compress' creates a compressed_entry_t. this is thread-safe and does not require an archive.
+     *
+     * @param   data        pointer to uncompressed data
+     * @param   num_bytes   number of bytes
+     * @param   level       zstd compression-level (1-22)
+     * @return  a compressed entry
+     */
+    static compressed_entry_t compress(const void *data, size_t num_bytes, int level = compression_level);
+
+    /**
+     * @brief   'compress' creates a compressed_entry_t from the output of a writer-function.
+     *          data is compressed while being written, the uncompressed data is never held in memory.
+     *
+     * @param   writer      function writing uncompressed data into the provided std::ostream
+     * @param   level       zstd compression-level (1-22). without a level, the entry is stored uncompressed.
+     * @return  a compressed entry
+     */
+    static compressed_entry_t compress(const std::function<void(std::ostream &)> &writer,
+                                       std::optional<int> level = compression_level);
+
     explicit ziparchive(const std::filesystem::path &archive_path);
 
     /**
@@ -52,15 +105,68 @@ public:
      */
     void add_file(const std::filesystem::path &file_path, const std::filesystem::path &entry_path = {});
 
+    /**
+     * @brief   'add_compressed' will add a pre-compressed entry to the ziparchive, without recompressing it.
+     *
+     * @param   entry       a compressed entry, kept alive until the archive is committed
+     * @param   entry_path  relative path, used as entry-name within the ziparchive.
+     */
+    void add_compressed(std::shared_ptr<const compressed_entry_t> entry, const std::filesystem::path &entry_path);
+
+    /**
+     * @brief   'add_stream' will add an entry, written by a writer-function and compressed while being stored.
+     *          no intermediate file is used, buffered data is bounded to a few compressed chunks.
+     *          'writer' runs on a separate thread during 'commit', everything it references must stay valid until then.
+     *          a throwing writer makes 'commit' fail.
+     *
+     * @param   writer      function writing uncompressed data into the provided std::ostream
+     * @param   entry_path  relative path, used as entry-name within the ziparchive.
+     * @param   level       zstd compression-level (1-22). without a level, the entry is stored uncompressed,
+     *                      which allows direct seeks when reading.
+     */
+    void add_stream(std::function<void(std::ostream &)> writer, const std::filesystem::path &entry_path,
+                    std::optional<int> level = compression_level);
+
+    /**
+     * @brief   'add_archive' will add all entries of another ziparchive, copied without recompression.
+     *          entries with equal names are replaced. 'source' is kept open until committed.
+     *          throws std::runtime_error on failure.
+     *
+     * @param   source  another ziparchive
+     * @return  the number of added entries
+     */
+    size_t add_archive(const ziparchive &source);
+
+    /**
+     * @brief   'remove_file' will remove a contained file from the ziparchive, when committed.
+     *
+     * @param   file_path   a relative path within the ziparchive
+     * @return  true, if the entry was contained and marked for removal
+     */
+    bool remove_file(const std::filesystem::path &file_path);
+
     /**
      * @brief   'open_file' will open a contained file within the ziparchive, referenced by it's relative file_path.
      *
      * @param   file_path    a relative path within the ziparchive
+     * @param   buffer_size  size of the read-ahead buffer in bytes, e.g. 1-4 MiB
      * @return  a std::istream which can be used to read/deflate a contained file
      */
-    [[nodiscard]] ziparchive::istream open_file(const std::filesystem::path &file_path) const;
+    [[nodiscard]] ziparchive::istream open_file(const std::filesystem::path &file_path,
+                                                size_t buffer_size = istream::default_buffer_size) const;
+
+    /**
+     * @brief   'commit' writes all pending changes and closes the ziparchive.
+     *          libzip writes a temporary file and renames it over the archive, so readers which already opened
+     *          the archive keep reading their version. throws std::runtime_error on failure.
+     *          requires all streams returned by 'open_file' to be closed.
+     */
+    void commit();
 
 private:
+    //! archives providing entries added via 'add_archive', closed after m_archive
+    std::vector<std::shared_ptr<zip_t>> m_sources;
+
     std::shared_ptr<zip_t> m_archive;
 };
 
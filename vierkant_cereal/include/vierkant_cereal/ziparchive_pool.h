@@ -0,0 +1,134 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include <vierkant_cereal/ziparchive.h>
+
+namespace vierkant
+{
+
+/**
+ * @brief   ziparchive_pool provides pooled, read-only handles for zip-archives.
+ *
+ * handles and a shared central-directory index are kept per archive-generation,
+ * identified by archive-path, modification-time and file-size. a rewritten archive starts a new generation,
+ * readers of an older generation keep reading from the handles they already hold.
+ * concurrent readers each get their own zip-handle, which is returned to the pool afterwards.
+ */
+class ziparchive_pool
+{
+public:
+    //! central-directory information for a single entry.
+    struct entry_info_t
+    {
+        uint64_t index = 0;
+        uint64_t size = 0;
+        uint64_t compressed_size = 0;
+        uint16_t compression_method = 0;
+    };
+
+    //! maps entry-names to their central-directory information.
+    using index_t = std::unordered_map<std::string, entry_info_t>;
+
+    //! per-archive lock-state
+    struct archive_locks_t
+    {
+        //! serializes writers of the same archive
+        std::mutex write_mutex;
+
+        //! held exclusively while committing. readers only take it when 'snapshot_reads' is unavailable.
+        std::shared_mutex commit_mutex;
+    };
+
+    //! readers keep their generation while an archive is replaced. win32 can't rename over files in use.
+#if defined(_WIN32)
+    static constexpr bool snapshot_reads = false;
+#else
+    static constexpr bool snapshot_reads = true;
+#endif
+
+    //! process-wide pool-instance
+    static ziparchive_pool &global();
+
+    explicit ziparchive_pool(size_t max_idle_handles = 16);
+
+    /**
+     * @brief   'index' provides the shared central-directory index for the current generation of an archive.
+     *
+     * @param   archive_path    path to a zip-archive
+     * @return  the shared index or nullptr, if the archive does not exist or could not be opened.
+     */
+    std::shared_ptr<const index_t> index(const std::filesystem::path &archive_path);
+
+    /**
+     * @brief   'has_file' checks for an entry in the current generation of an archive.
+     *
+     * @param   archive_path    path to a zip-archive
+     * @param   entry_path      a relative path within the ziparchive
+     * @return  true, if the archive contains the entry
+     */
+    bool has_file(const std::filesystem::path &archive_path, const std::filesystem::path &entry_path);
+
+    /**
+     * @brief   'open_file' opens an entry using a pooled handle, which is returned when the stream is destroyed.
+     *          throws std::runtime_error if the archive can not be opened.
+     *
+     * @param   archive_path    path to a zip-archive
+     * @param   entry_path      a relative path within the ziparchive
+     * @param   buffer_size     size of the read-ahead buffer in bytes
+     * @return  a std::istream which can be used to read/deflate a contained file
+     */
+    ziparchive::istream open_file(const std::filesystem::path &archive_path, const std::filesystem::path &entry_path,
+                                  size_t buffer_size = ziparchive::istream::default_buffer_size);
+
+    /**
+     * @brief   'invalidate' drops the current generation for an archive, e.g. after it was rewritten.
+     *
+     * @param   archive_path    path to a zip-archive
+     */
+    void invalidate(const std::filesystem::path &archive_path);
+
+    //! drop all generations and idle handles.
+    void clear();
+
+    /**
+     * @brief   'locks' provides the lock-state for an archive. writers of the same archive are serialized
+     *          via 'write_mutex', writers of different archives and readers do not block each other.
+     *
+     * @param   archive_path    path to a zip-archive
+     * @return  a reference to the archive's lock-state, valid for the lifetime of the pool.
+     */
+    archive_locks_t &locks(const std::filesystem::path &archive_path);
+
+    /**
+     * @brief   'modify' opens an archive for writing under its write-lock, applies 'fn' and commits the result
+     *          with a single archive-rewrite. the current generation is invalidated afterwards.
+     *
+     * @param   archive_path    path to a zip-archive, created if not existing
+     * @param   fn              function adding/removing entries
+     */
+    void modify(const std::filesystem::path &archive_path, const std::function<void(ziparchive &)> &fn);
+
+private:
+    struct generation_t;
+
+    std::shared_ptr<generation_t> generation(const std::filesystem::path &archive_path);
+
+    //! acquire an idle handle from a generation (or open a new one), which is returned to it on release.
+    static std::shared_ptr<zip_t> acquire(const std::shared_ptr<generation_t> &generation);
+
+    size_t m_max_idle_handles;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<generation_t>> m_generations;
+
+    std::mutex m_locks_mutex;
+    std::unordered_map<std::string, std::unique_ptr<archive_locks_t>> m_locks;
+};
+
+}// namespace vierkant
@@ -0,0 +1,28 @@
+#include <algorithm>
+
+#include <vierkant_cereal/bake_memory.hpp>
+#include <vierkant_cereal/model_dependencies.hpp>
+
+namespace vierkant_cereal
+{
+
+uint64_t model_files_size(const std::filesystem::path &model_path)
+{
+    std::error_code ec;
+    uint64_t num_bytes = 0;
+    for(const auto &file: model_dependencies(model_path))
+    {
+        auto file_size = std::filesystem::file_size(file, ec);
+        if(!ec) { num_bytes += file_size; }
+    }
+    auto file_size = std::filesystem::file_size(model_path, ec);
+    if(!ec) { num_bytes += file_size; }
+    return num_bytes;
+}
+
+uint64_t estimate_bake_memory(const std::filesystem::path &model_path)
+{
+    return std::max<uint64_t>(model_files_size(model_path) * bake_memory_factor, 1);
+}
+
+}// namespace vierkant_cereal
@@ -0,0 +1,132 @@
+#include <spdlog/spdlog.h>
+#include <spdlog/stopwatch.h>
+
+#include <vierkant_cereal/bundle_archive_writer.hpp>
+#include <vierkant_cereal/vierkant_cereal.hpp>
+#include <vierkant_cereal/ziparchive_pool.h>
+
+namespace vierkant_cereal
+{
+
+bundle_archive_writer::bundle_archive_writer(std::filesystem::path zip_archive, crocore::ThreadPoolClassic *pool,
+                                             bool async)
+    : m_archive_path(std::move(zip_archive)), m_pool(pool), m_async(async)
+{}
+
+bundle_archive_writer::~bundle_archive_writer()
+{
+    try
+    {
+        checkpoint();
+    } catch(std::exception &e) { spdlog::error(e.what()); }
+}
+
+std::shared_future<bundle_archive_writer::entry_size_t>
+bundle_archive_writer::add(vierkant::model::model_assets_t assets, const std::filesystem::path &path,
+                           texture_codec_t texture_codec, geometry_codec_t geometry_codec)
+{
+    auto assets_ptr = std::make_shared<const vierkant::model::model_assets_t>(std::move(assets));
+    auto save_stats = std::make_shared<save_stats_t>();
+
+    // sections are compressed already, sections and textures are encoded concurrently
+    auto writer = [assets_ptr, texture_codec, geometry_codec, save_stats, pool = m_pool](std::ostream &os) {
+        save(os, *assets_ptr, pool, texture_codec, geometry_codec, save_stats.get());
+    };
+    return enqueue(path, std::nullopt, std::move(writer), save_stats);
+}
+
+std::shared_future<bundle_archive_writer::entry_size_t>
+bundle_archive_writer::add(vierkant::material_data_t material_data, const std::filesystem::path &path,
+                           texture_codec_t texture_codec)
+{
+    auto material_data_ptr = std::make_shared<const vierkant::material_data_t>(std::move(material_data));
+    return enqueue(path, vierkant::ziparchive::compression_level, [material_data_ptr, texture_codec](std::ostream &os) {
+        save(os, *material_data_ptr, texture_codec);
+    });
+}
+
+std::shared_future<bundle_archive_writer::entry_size_t>
+bundle_archive_writer::enqueue(const std::filesystem::path &path, std::optional<int> level,
+                               std::function<void(std::ostream &)> writer,
+                               std::shared_ptr<const save_stats_t> save_stats)
+{
+    auto size_promise = std::make_shared<std::promise<entry_size_t>>();
+    auto size_future = size_promise->get_future().share();
+
+    auto compress_fn = [entry_path = bundle_entry_path(path, m_archive_path), level, writer = std::move(writer),
+                        save_stats = std::move(save_stats), size_promise]() {
+        spdlog::stopwatch sw;
+
+        // compressed while serializing, uncompressed bundles are never held in memory
+        staged_entry_t ret;
+        ret.entry_path = entry_path;
+        try
+        {
+            ret.compressed = std::make_shared<vierkant::ziparchive::compressed_entry_t>(
+                    vierkant::ziparchive::compress(writer, level));
+        } catch(...)
+        {
+            size_promise->set_exception(std::current_exception());
+            throw;
+        }
+        size_promise->set_value(
+                {ret.compressed->size, ret.compressed->data.size(), save_stats ? *save_stats : save_stats_t()});
+        spdlog::debug("staged bundle: {} ({} -> {} bytes, {})", entry_path.string(), ret.compressed->size,
+                      ret.compressed->data.size(), sw.elapsed());
+        return ret;
+    };
+
+    std::future<staged_entry_t> future;
+    if(m_pool && m_async) { future = m_pool->post(compress_fn); }
+    else
+    {
+        std::promise<staged_entry_t> promise;
+        try
+        {
+            promise.set_value(compress_fn());
+        } catch(...) { promise.set_exception(std::current_exception()); }
+        future = promise.get_future();
+    }
+    std::lock_guard lock(m_mutex);
+    m_pending.push_back(std::move(future));
+    return size_future;
+}
+
+size_t bundle_archive_writer::checkpoint()
+{
+    std::lock_guard checkpoint_lock(m_checkpoint_mutex);
+
+    std::vector<std::future<staged_entry_t>> pending;
+    {
+        std::lock_guard lock(m_mutex);
+        pending.swap(m_pending);
+    }
+    if(pending.empty()) { return 0; }
+
+    std::vector<staged_entry_t> staged_entries;
+    staged_entries.reserve(pending.size());
+
+    for(auto &future: pending)
+    {
+        try
+        {
+            staged_entries.push_back(future.get());
+        } catch(std::exception &e) { spdlog::error("could not stage bundle: {}", e.what()); }
+    }
+    if(staged_entries.empty()) { return 0; }
+
+    spdlog::stopwatch sw;
+    vierkant::ziparchive_pool::global().modify(m_archive_path, [&staged_entries](vierkant::ziparchive &archive) {
+        for(const auto &staged: staged_entries) { archive.add_compressed(staged.compressed, staged.entry_path); }
+    });
+    spdlog::debug("committed {} bundle(s) -> {} ({})", staged_entries.size(), m_archive_path.string(), sw.elapsed());
+    return staged_entries.size();
+}
+
+size_t bundle_archive_writer::num_pending() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_pending.size();
+}
+
+}// namespace vierkant_cereal
@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <zstd.h>
+
+#include <vierkant_cereal/bundle_container.hpp>
+#include <vierkant_cereal/xxhash64.hpp>
+
+namespace vierkant_cereal
+{
+
+//! zstd-level for section-data
+constexpr int section_compression_level = 10;
+
+constexpr size_t header_size = 12;
+constexpr size_t section_entry_size = 48;
+
+constexpr uint8_t payload_endianness = std::endian::native == std::endian::little ? 0 : 1;
+
+//! upper bound for the number of sections, rejects garbage before allocating a toc
+constexpr uint32_t max_num_sections = 1U << 20;
+
+//! std::streambuf appending to a std::vector
+struct vector_streambuf : public std::streambuf
+{
+    std::vector<uint8_t> data;
+
+    int_type overflow(int_type c) override
+    {
+        if(c != traits_type::eof()) { data.push_back(static_cast<uint8_t>(c)); }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        data.insert(data.end(), s, s + n);
+        return n;
+    }
+};
+
+template<typename T>
+static void put_le(uint8_t *dst, T value)
+{
+    for(size_t i = 0; i < sizeof(T); ++i) { dst[i] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)); }
+}
+
+template<typename T>
+static T get_le(const uint8_t *src)
+{
+    uint64_t value = 0;
+    for(size_t i = sizeof(T); i > 0; --i) { value = (value << 8) | src[i - 1]; }
+    return static_cast<T>(value);
+}
+
+encoded_section_t encode_section(uint32_t type, uint64_t key, const std::function<void(std::ostream &)> &writer,
+                                 section_codec_t codec)
+{
+    using double_second = std::chrono::duration<double>;
+    auto start = std::chrono::steady_clock::now();
+
+    vector_streambuf streambuf;
+    std::ostream os(&streambuf);
+    os.exceptions(std::ios_base::badbit);
+    writer(os);
+
+    encoded_section_t ret;
+    ret.type = type;
+    ret.key = key;
+    ret.codec = codec;
+    ret.raw_size = streambuf.data.size();
+
+    auto serialized = std::chrono::steady_clock::now();
+    ret.serialize_seconds = double_second(serialized - start).count();
+
+    switch(codec)
+    {
+        case section_codec_t::None: ret.data = std::move(streambuf.data); break;
+
+        case section_codec_t::Zstd:
+        {
+            ret.data.resize(ZSTD_compressBound(streambuf.data.size()));
+            auto num_bytes = ZSTD_compress(ret.data.data(), ret.data.size(), streambuf.data.data(),
+                                           streambuf.data.size(), section_compression_level);
+            if(ZSTD_isError(num_bytes))
+            {
+                throw std::runtime_error(std::string("encode_section: ") + ZSTD_getErrorName(num_bytes));
+            }
+            ret.data.resize(num_bytes);
+            ret.data.shrink_to_fit();
+            break;
+        }
+        default: throw std::runtime_error("encode_section: unknown codec");
+    }
+    ret.compress_seconds = double_second(std::chrono::steady_clock::now() - serialized).count();
+    ret.hash = xxh64(ret.data.data(), ret.data.size());
+    return ret;
+}
+
+void write_bundle_container(std::ostream &os, const std::vector<encoded_section_t> &sections, uint16_t schema_version)
+{
+    std::vector<uint8_t> toc(header_size + sections.size() * section_entry_size);
+    std::memcpy(toc.data(), bundle_container_magic, sizeof(bundle_container_magic));
+    toc[4] = bundle_container_version;
+    toc[5] = payload_endianness;
+    put_le<uint16_t>(toc.data() + 6, schema_version);
+    put_le<uint32_t>(toc.data() + 8, static_cast<uint32_t>(sections.size()));
+
+    uint64_t offset = toc.size();
+    uint8_t *ptr = toc.data() + header_size;
+
+    for(const auto &section: sections)
+    {
+        put_le<uint32_t>(ptr, section.type);
+        put_le<uint32_t>(ptr + 4, static_cast<uint32_t>(section.codec));
+        put_le<uint64_t>(ptr + 8, section.key);
+        put_le<uint64_t>(ptr + 16, offset);
+        put_le<uint64_t>(ptr + 24, section.data.size());
+        put_le<uint64_t>(ptr + 32, section.raw_size);
+        put_le<uint64_t>(ptr + 40, section.hash);
+        offset += section.data.size();
+        ptr += section_entry_size;
+    }
+    os.write(reinterpret_cast<const char *>(toc.data()), static_cast<std::streamsize>(toc.size()));
+
+    for(const auto &section: sections)
+    {
+        os.write(reinterpret_cast<const char *>(section.data.data()), static_cast<std::streamsize>(section.data.size()));
+    }
+    if(!os) { throw std::runtime_error("write_bundle_container: write failed"); }
+}
+
+std::optional<std::vector<section_entry_t>> read_bundle_toc(std::istream &is, uint16_t *schema_version)
+{
+    auto start = is.tellg();
+    uint8_t header[header_size] = {};
+    is.read(reinterpret_cast<char *>(header), header_size);
+
+    if(is.gcount() != static_cast<std::streamsize>(header_size) ||
+       std::memcmp(header, bundle_container_magic, sizeof(bundle_container_magic)) != 0)
+    {
+        is.clear();
+        is.seekg(start);
+        return {};
+    }
+    if(header[4] != bundle_container_version)
+    {
+        throw std::runtime_error("read_bundle_toc: unsupported container-version " + std::to_string(header[4]));
+    }
+    if(header[5] != payload_endianness) { throw std::runtime_error("read_bundle_toc: endianness mismatch"); }
+    if(schema_version) { *schema_version = get_le<uint16_t>(header + 6); }
+
+    auto num_sections = get_le<uint32_t>(header + 8);
+    if(num_sections > max_num_sections) { throw std::runtime_error("read_bundle_toc: corrupt toc"); }
+
+    std::vector<uint8_t> toc_data(num_sections * section_entry_size);
+    is.read(reinterpret_cast<char *>(toc_data.data()), static_cast<std::streamsize>(toc_data.size()));
+    if(is.gcount() != static_cast<std::streamsize>(toc_data.size()))
+    {
+        throw std::runtime_error("read_bundle_toc: truncated toc");
+    }
+
+    std::vector<section_entry_t> ret(num_sections);
+    const uint8_t *ptr = toc_data.data();
+
+    for(auto &entry: ret)
+    {
+        entry.type = get_le<uint32_t>(ptr);
+        entry.codec = static_cast<section_codec_t>(get_le<uint32_t>(ptr + 4));
+        entry.key = get_le<uint64_t>(ptr + 8);
+        entry.offset = get_le<uint64_t>(ptr + 16);
+        entry.size = get_le<uint64_t>(ptr + 24);
+        entry.raw_size = get_le<uint64_t>(ptr + 32);
+        entry.hash = get_le<uint64_t>(ptr + 40);
+        ptr += section_entry_size;
+    }
+    return ret;
+}
+
+std::vector<uint8_t> read_section(std::istream &is, std::streamoff base, const section_entry_t &entry)
+{
+    std::vector<uint8_t> ret(entry.size);
+    is.seekg(base + static_cast<std::streamoff>(entry.offset));
+    is.read(reinterpret_cast<char *>(ret.data()), static_cast<std::streamsize>(ret.size()));
+    if(!is || is.gcount() != static_cast<std::streamsize>(ret.size()))
+    {
+        throw std::runtime_error("read_section: truncated section");
+    }
+    return ret;
+}
+
+std::vector<uint8_t> decode_section(const section_entry_t &entry, std::vector<uint8_t> stored)
+{
+    if(xxh64(stored.data(), stored.size()) != entry.hash) { throw std::runtime_error("decode_section: hash mismatch"); }
+
+    switch(entry.codec)
+    {
+        case section_codec_t::None: return stored;
+
+        case section_codec_t::Zstd:
+        {
+            std::vector<uint8_t> ret(entry.raw_size);
+            auto num_bytes = ZSTD_decompress(ret.data(), ret.size(), stored.data(), stored.size());
+            if(ZSTD_isError(num_bytes) || num_bytes != entry.raw_size)
+            {
+                throw std::runtime_error("decode_section: corrupt section-data");
+            }
+            return ret;
+        }
+        default: throw std::runtime_error("decode_section: unknown codec");
+    }
+}
+
+void parallel_for(size_t num, const std::function<void(size_t)> &fn, crocore::ThreadPoolClassic *pool)
+{
+    struct state_t
+    {
+        const std::function<void(size_t)> *fn = nullptr;
+        size_t num = 0;
+        std::atomic<size_t> next = 0;
+        std::mutex mutex;
+        std::condition_variable cond;
+        size_t num_done = 0;
+        std::exception_ptr exception;
+
+        //! claim and run items until none are left
+        void work()
+        {
+            for(size_t i = next++; i < num; i = next++)
+            {
+                std::exception_ptr item_exception;
+                try
+                {
+                    (*fn)(i);
+                } catch(...) { item_exception = std::current_exception(); }
+
+                std::lock_guard lock(mutex);
+                if(item_exception && !exception) { exception = item_exception; }
+                if(++num_done == num) { cond.notify_all(); }
+            }
+        }
+    };
+    if(!num) { return; }
+
+    auto state = std::make_shared<state_t>();
+    state->fn = &fn;
+    state->num = num;
+
+    // late tasks find no items left and return without touching 'fn'
+    if(pool)
+    {
+        size_t num_tasks = std::min<size_t>(num - 1, pool->num_threads());
+        for(size_t i = 0; i < num_tasks; ++i) { pool->post([state] { state->work(); }); }
+    }
+    state->work();
+
+    std::unique_lock lock(state->mutex);
+    state->cond.wait(lock, [&state] { return state->num_done == state->num; });
+    if(state->exception) { std::rethrow_exception(state->exception); }
+}
+
+}// namespace vierkant_cereal
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+
+#include <vierkant_cereal/bundle_dedup.hpp>
+#include <vierkant_cereal/serialization.hpp>
+#include <vierkant_cereal/xxhash64.hpp>
+
+namespace vierkant_cereal
+{
+
+using byte_span_t = std::span<const uint8_t>;
+
+//! binary serialization of a value, used as exact key for equality
+template<typename T>
+static std::string serialized_key(const T &value)
+{
+    std::ostringstream os(std::ios_base::out | std::ios_base::binary);
+    {
+        cereal::BinaryOutputArchive archive(os);
+        archive(value);
+    }
+    return std::move(os).str();
+}
+
+template<typename T>
+static byte_span_t as_bytes(const T *data, size_t count)
+{ return {reinterpret_cast<const uint8_t *>(data), count * sizeof(T)}; }
+
+template<typename T>
+static bool in_range(const std::vector<T> &v, size_t offset, size_t count)
+{ return offset <= v.size() && count <= v.size() - offset; }
+
+static size_t merge_samplers(vierkant::model::model_assets_t &assets)
+{
+    using sampler_id_t = decltype(assets.texture_samplers)::key_type;
+
+    // first id (in string-order) of equal samplers is kept, independent from container-order
+    std::vector<sampler_id_t> ids;
+    for(const auto &[id, sampler]: assets.texture_samplers) { ids.push_back(id); }
+    std::ranges::sort(ids, [](const auto &lhs, const auto &rhs) { return lhs.str() < rhs.str(); });
+
+    std::unordered_map<std::string, sampler_id_t> unique;
+    std::unordered_map<sampler_id_t, sampler_id_t> remap;
+    for(const auto &id: ids)
+    {
+        auto [it, inserted] = unique.try_emplace(serialized_key(assets.texture_samplers.at(id)), id);
+        if(!inserted) { remap[id] = it->second; }
+    }
+    if(remap.empty()) { return 0; }
+
+    for(const auto &[id, target]: remap) { assets.texture_samplers.erase(id); }
+    for(auto &material: assets.materials)
+    {
+        for(auto &[type, texture_data]: material.texture_data)
+        {
+            auto it = remap.find(texture_data.sampler_id);
+            if(it != remap.end()) { texture_data.sampler_id = it->second; }
+        }
+    }
+    return remap.size();
+}
+
+template<typename Entries>
+static void remap_material_indices(Entries &entries, const std::vector<uint32_t> &remap)
+{
+    for(auto &entry: entries)
+    {
+        if(entry.material_index < remap.size()) { entry.material_index = remap[entry.material_index]; }
+    }
+}
+
+static size_t merge_materials(vierkant::model::model_assets_t &assets)
+{
+    if(assets.materials.size() < 2) { return 0; }
+
+    // ids and names differ for every material, equality covers everything else
+    const auto reference_id = assets.materials.front().id;
+    std::unordered_map<std::string, uint32_t> unique;
+    std::vector<uint32_t> remap(assets.materials.size());
+    decltype(assets.materials) materials;
+
+    for(uint32_t i = 0; i < assets.materials.size(); ++i)
+    {
+        auto key_material = assets.materials[i];
+        key_material.id = reference_id;
+        key_material.name.clear();
+
+        auto [it, inserted] = unique.try_emplace(serialized_key(key_material), static_cast<uint32_t>(materials.size()));
+        if(inserted) { materials.push_back(std::move(assets.materials[i])); }
+        remap[i] = it->second;
+    }
+    size_t num_removed = assets.materials.size() - materials.size();
+    assets.materials = std::move(materials);
+    if(!num_removed) { return 0; }
+
+    if(auto *bundle = std::get_if<vierkant::mesh_buffer_bundle_t>(&assets.geometry_data))
+    {
+        remap_material_indices(bundle->entries, remap);
+        bundle->num_materials = assets.materials.size();
+    }
+    else if(auto *create_infos = std::get_if<std::vector<vierkant::Mesh::entry_create_info_t>>(&assets.geometry_data))
+    {
+        remap_material_indices(*create_infos, remap);
+    }
+    return num_removed;
+}
+
+//! byte-ranges and counts describing an entry's geometry. nothing is returned for out-of-range entries.
+static std::optional<std::vector<byte_span_t>> geometry_spans(const vierkant::mesh_buffer_bundle_t &bundle,
+                                                               const vierkant::Mesh::entry_t &entry,
+                                                               std::vector<uint64_t> &counts)
+{
+    const size_t stride = bundle.vertex_stride;
+    const auto vertex_offset = static_cast<size_t>(entry.vertex_offset);
+    if(static_cast<int64_t>(entry.vertex_offset) < 0 ||
+       !in_range(bundle.vertex_buffer, vertex_offset * stride, entry.num_vertices * stride))
+    {
+        return {};
+    }
+
+    // counts separate the ranges, so equal concatenations of different ranges don't compare equal
+    counts = {static_cast<uint64_t>(entry.primitive_type), entry.num_vertices, entry.lods.size()};
+    std::vector<byte_span_t> ret = {as_bytes(counts.data(), counts.size()),
+                                    as_bytes(bundle.vertex_buffer.data() + vertex_offset * stride,
+                                             entry.num_vertices * stride)};
+
+    if(!bundle.bone_vertex_buffer.empty())
+    {
+        if(!in_range(bundle.bone_vertex_buffer, vertex_offset, entry.num_vertices)) { return {}; }
+        ret.push_back(as_bytes(bundle.bone_vertex_buffer.data() + vertex_offset, entry.num_vertices));
+    }
+
+    for(const auto &lod: entry.lods)
+    {
+        if(!in_range(bundle.index_buffer, lod.base_index, lod.num_indices) ||
+           !in_range(bundle.meshlets, lod.base_meshlet, lod.num_meshlets))
+        {
+            return {};
+        }
+        ret.push_back(as_bytes(bundle.index_buffer.data() + lod.base_index, lod.num_indices));
+
+        for(uint32_t i = 0; i < lod.num_meshlets; ++i)
+        {
+            const auto &meshlet = bundle.meshlets[lod.base_meshlet + i];
+            size_t num_triangle_bytes = meshlet.triangle_count * 3;
+            if(!in_range(bundle.meshlet_vertices, meshlet.vertex_offset, meshlet.vertex_count) ||
+               !in_range(bundle.meshlet_triangles, meshlet.triangle_offset, num_triangle_bytes))
+            {
+                return {};
+            }
+            ret.push_back(as_bytes(bundle.meshlet_vertices.data() + meshlet.vertex_offset, meshlet.vertex_count));
+            ret.push_back(as_bytes(bundle.meshlet_triangles.data() + meshlet.triangle_offset, num_triangle_bytes));
+        }
+    }
+    return ret;
+}
+
+static bool equal_spans(const std::vector<byte_span_t> &lhs, const std::vector<byte_span_t> &rhs)
+{
+    return std::ranges::equal(lhs, rhs, [](const byte_span_t &a, const byte_span_t &b) {
+        return a.size() == b.size() && (a.empty() || !std::memcmp(a.data(), b.data(), a.size()));
+    });
+}
+
+static size_t bundle_num_bytes(const vierkant::mesh_buffer_bundle_t &bundle)
+{
+    return bundle.vertex_buffer.size() + bundle.bone_vertex_buffer.size() * sizeof(bundle.bone_vertex_buffer[0]) +
+           bundle.index_buffer.size() * sizeof(bundle.index_buffer[0]) +
+           bundle.meshlets.size() * sizeof(bundle.meshlets[0]) +
+           bundle.meshlet_vertices.size() * sizeof(bundle.meshlet_vertices[0]) + bundle.meshlet_triangles.size();
+}
+
+//! returns the number of entries sharing the geometry of an earlier entry
+static size_t merge_geometries(vierkant::mesh_buffer_bundle_t &bundle)
+{
+    // only interleaved vertex-buffers (as created by vierkant::create_mesh_buffers) are handled
+    if(!bundle.vertex_stride || bundle.entries.size() < 2) { return 0; }
+    for(const auto &[location, attrib]: bundle.vertex_attribs)
+    {
+        if(attrib.buffer_offset) { return 0; }
+    }
+
+    std::vector<size_t> duplicate_of(bundle.entries.size());
+    std::unordered_map<uint64_t, std::vector<size_t>> unique;
+    std::vector<std::vector<byte_span_t>> spans(bundle.entries.size());
+    std::vector<std::vector<uint64_t>> counts(bundle.entries.size());
+    size_t num_duplicates = 0;
+
+    for(size_t i = 0; i < bundle.entries.size(); ++i)
+    {
+        const auto &entry = bundle.entries[i];
+        duplicate_of[i] = i;
+
+        auto entry_spans = geometry_spans(bundle, entry, counts[i]);
+        if(!entry_spans) { return 0; }
+        spans[i] = std::move(*entry_spans);
+
+        // morph-targets are addressed per entry, those entries keep their own geometry
+        if(!entry.morph_weights.empty()) { continue; }
+
+        uint64_t hash = 0;
+        for(const auto &span: spans[i]) { hash = xxh64(span.data(), span.size(), hash); }
+
+        auto &candidates = unique[hash];
+        auto it = std::ranges::find_if(candidates, [&](size_t j) { return equal_spans(spans[i], spans[j]); });
+        if(it != candidates.end())
+        {
+            duplicate_of[i] = *it;
+            ++num_duplicates;
+        }
+        else { candidates.push_back(i); }
+    }
+    if(!num_duplicates) { return 0; }
+
+    // copy referenced ranges into compacted buffers, duplicates share the ranges of their first occurrence
+    const size_t stride = bundle.vertex_stride;
+    decltype(bundle.vertex_buffer) vertex_buffer;
+    decltype(bundle.bone_vertex_buffer) bone_vertex_buffer;
+    decltype(bundle.index_buffer) index_buffer;
+    decltype(bundle.meshlets) meshlets;
+    decltype(bundle.meshlet_vertices) meshlet_vertices;
+    decltype(bundle.meshlet_triangles) meshlet_triangles;
+
+    for(size_t i = 0; i < bundle.entries.size(); ++i)
+    {
+        auto &entry = bundle.entries[i];
+
+        if(duplicate_of[i] != i)
+        {
+            const auto &first = bundle.entries[duplicate_of[i]];
+            entry.vertex_offset = first.vertex_offset;
+            for(size_t l = 0; l < entry.lods.size(); ++l)
+            {
+                entry.lods[l].base_index = first.lods[l].base_index;
+                entry.lods[l].base_meshlet = first.lods[l].base_meshlet;
+            }
+            continue;
+        }
+
+        auto vertex_offset = static_cast<size_t>(entry.vertex_offset);
+        auto vertices_begin = bundle.vertex_buffer.begin() + static_cast<std::ptrdiff_t>(vertex_offset * stride);
+        entry.vertex_offset = static_cast<decltype(entry.vertex_offset)>(vertex_buffer.size() / stride);
+        vertex_buffer.insert(vertex_buffer.end(), vertices_begin,
+                             vertices_begin + static_cast<std::ptrdiff_t>(entry.num_vertices * stride));
+
+        if(!bundle.bone_vertex_buffer.empty())
+        {
+            auto bones_begin = bundle.bone_vertex_buffer.begin() + static_cast<std::ptrdiff_t>(vertex_offset);
+            bone_vertex_buffer.insert(bone_vertex_buffer.end(), bones_begin,
+                                      bones_begin + static_cast<std::ptrdiff_t>(entry.num_vertices));
+        }
+
+        for(auto &lod: entry.lods)
+        {
+            auto indices_begin = bundle.index_buffer.begin() + lod.base_index;
+            lod.base_index = static_cast<decltype(lod.base_index)>(index_buffer.size());
+            index_buffer.insert(index_buffer.end(), indices_begin, indices_begin + lod.num_indices);
+
+            auto base_meshlet = lod.base_meshlet;
+            lod.base_meshlet = static_cast<decltype(lod.base_meshlet)>(meshlets.size());
+
+            for(uint32_t m = 0; m < lod.num_meshlets; ++m)
+            {
+                auto meshlet = bundle.meshlets[base_meshlet + m];
+
+                auto meshlet_vertices_begin = bundle.meshlet_vertices.begin() + meshlet.vertex_offset;
+                meshlet.vertex_offset = static_cast<decltype(meshlet.vertex_offset)>(meshlet_vertices.size());
+                meshlet_vertices.insert(meshlet_vertices.end(), meshlet_vertices_begin,
+                                        meshlet_vertices_begin + meshlet.vertex_count);
+
+                // keep triangle-offsets 4-byte aligned, like meshoptimizer does
+                meshlet_triangles.resize((meshlet_triangles.size() + 3) & ~size_t(3));
+                auto triangles_begin = bundle.meshlet_triangles.begin() + meshlet.triangle_offset;
+                meshlet.triangle_offset = static_cast<decltype(meshlet.triangle_offset)>(meshlet_triangles.size());
+                meshlet_triangles.insert(meshlet_triangles.end(), triangles_begin,
+                                         triangles_begin + meshlet.triangle_count * 3);
+                meshlets.push_back(meshlet);
+            }
+        }
+    }
+
+    bundle.vertex_buffer = std::move(vertex_buffer);
+    bundle.bone_vertex_buffer = std::move(bone_vertex_buffer);
+    bundle.index_buffer = std::move(index_buffer);
+    bundle.meshlets = std::move(meshlets);
+    bundle.meshlet_vertices = std::move(meshlet_vertices);
+    bundle.meshlet_triangles = std::move(meshlet_triangles);
+    return num_duplicates;
+}
+
+dedup_result_t deduplicate_model_assets(vierkant::model::model_assets_t &assets)
+{
+    dedup_result_t ret;
+
+    // samplers first, materials referencing merged samplers may become equal
+    ret.num_samplers = merge_samplers(assets);
+    ret.num_materials = merge_materials(assets);
+
+    if(auto *bundle = std::get_if<vierkant::mesh_buffer_bundle_t>(&assets.geometry_data))
+    {
+        size_t num_bytes = bundle_num_bytes(*bundle);
+        ret.num_geometries = merge_geometries(*bundle);
+        ret.num_bytes = num_bytes - std::min(num_bytes, bundle_num_bytes(*bundle));
+    }
+    return ret;
+}
+
+}// namespace vierkant_cereal
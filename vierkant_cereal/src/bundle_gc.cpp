@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <vierkant_cereal/bundle_container.hpp>
+#include <vierkant_cereal/bundle_gc.hpp>
+#include <vierkant_cereal/texture_store.hpp>
+#include <vierkant_cereal/ziparchive_pool.h>
+
+namespace vierkant_cereal
+{
+
+//! a model-bundle, stored as plain file and/or archive-entry
+struct gc_bundle_t
+{
+    //! size of the plain file, if any
+    std::optional<uint64_t> file_size;
+
+    //! name and stored size of the archive-entry, if any
+    std::optional<std::string> entry_name;
+    uint64_t entry_size = 0;
+
+    int64_t last_access = 0;
+
+    //! paths of referenced, stored textures
+    std::vector<std::filesystem::path> textures;
+
+    bool stale = false;
+    bool evicted = false;
+
+    [[nodiscard]] uint64_t size() const { return file_size.value_or(0) + entry_size; }
+};
+
+//! a texture-file in the texture-store
+struct gc_texture_t
+{
+    uint64_t size = 0;
+    uint32_t num_references = 0;
+    bool removed = false;
+};
+
+//! file-time in seconds since epoch
+static int64_t to_seconds(std::filesystem::file_time_type file_time)
+{
+    auto now = std::chrono::system_clock::now() +
+               std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                       file_time - std::filesystem::file_time_type::clock::now());
+    return std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+}
+
+//! reason for a recorded bundle being stale, if any
+static const char *stale_reason(bundle_manifest &manifest, const bundle_manifest::bundle_record_t &record)
+{
+    // unknown for records upgraded from manifest-version 1
+    if(record.schema_version && !bundle_schema_supported(record.schema_version))
+    {
+        return "unsupported schema-version";
+    }
+    std::error_code ec;
+    if(!std::filesystem::exists(record.model_path, ec)) { return "missing model-file"; }
+    if(manifest.content_hash(record.model_path) != record.content_hash) { return "modified model-file"; }
+    return nullptr;
+}
+
+bundle_gc_result_t collect_bundle_garbage(bundle_manifest &manifest, const bundle_gc_params_t &params)
+{
+    bundle_gc_result_t ret;
+    const std::string suffix = std::string(".") + bundle_file_suffix;
+
+    // bundles by filename
+    std::map<std::string, gc_bundle_t> bundles;
+    std::error_code ec;
+
+    for(const auto &entry: std::filesystem::directory_iterator(params.bundle_dir, ec))
+    {
+        if(!entry.is_regular_file(ec) || entry.path().extension() != suffix) { continue; }
+        auto &bundle = bundles[entry.path().filename().string()];
+        bundle.file_size = entry.file_size(ec);
+        bundle.last_access = to_seconds(entry.last_write_time(ec));
+    }
+
+    if(params.zip_archive)
+    {
+        if(auto index = vierkant::ziparchive_pool::global().index(*params.zip_archive))
+        {
+            auto archive_time = to_seconds(std::filesystem::last_write_time(*params.zip_archive, ec));
+            auto entry_dir = bundle_entry_path(params.bundle_dir / "_", *params.zip_archive).parent_path();
+
+            for(const auto &[name, info]: *index)
+            {
+                std::filesystem::path entry_path = name;
+                if(entry_path.parent_path() != entry_dir || entry_path.extension() != suffix) { continue; }
+                auto &bundle = bundles[entry_path.filename().string()];
+                bundle.entry_name = name;
+                bundle.entry_size = info.compressed_size;
+                bundle.last_access = std::max(bundle.last_access, archive_time);
+            }
+        }
+    }
+    ret.num_bundles = bundles.size();
+
+    // records without bundles are dropped, recorded last-access takes precedence over file-times
+    std::vector<std::string> dangling_records;
+    for(const auto &[filename, record]: manifest.records())
+    {
+        auto it = bundles.find(filename);
+        if(it == bundles.end())
+        {
+            dangling_records.push_back(filename);
+            continue;
+        }
+        auto &bundle = it->second;
+        if(record.last_access) { bundle.last_access = record.last_access; }
+
+        const char *reason = params.remove_stale ? stale_reason(manifest, record) : nullptr;
+        if(reason)
+        {
+            spdlog::debug("stale bundle '{}' ({})", filename, reason);
+            bundle.stale = true;
+        }
+    }
+
+    // stored textures and their references. unless references of all remaining bundles are known,
+    // textures are left untouched and don't count towards the size
+    std::map<std::filesystem::path, gc_texture_t> textures;
+
+    if(params.texture_store)
+    {
+        const std::string texture_suffix = std::string(".") + texture_store::file_suffix;
+        for(const auto &entry: std::filesystem::directory_iterator(params.texture_store->directory(), ec))
+        {
+            if(!entry.is_regular_file(ec) || entry.path().extension() != texture_suffix) { continue; }
+            textures[entry.path()].size = entry.file_size(ec);
+        }
+
+        std::vector<std::pair<const std::string, gc_bundle_t> *> remaining;
+        for(auto &item: bundles)
+        {
+            if(!item.second.stale) { remaining.push_back(&item); }
+        }
+
+        // materials only, textures of stripped bundles are referenced by id
+        std::vector<char> loaded(remaining.size(), false);
+        parallel_for(
+                remaining.size(),
+                [&](size_t i) {
+                    auto &[filename, bundle] = *remaining[i];
+                    auto assets = load_model_bundle_file(params.bundle_dir / filename, params.zip_archive,
+                                                         bundle_section_bit(bundle_section_t::Materials));
+                    if(!assets) { return; }
+                    for(const auto &id: texture_store::referenced_ids(*assets))
+                    {
+                        bundle.textures.push_back(params.texture_store->file_path(id));
+                    }
+                    loaded[i] = true;
+                },
+                params.pool);
+
+        if(std::ranges::find(loaded, false) != loaded.end())
+        {
+            spdlog::warn("could not read all bundles, keeping texture-store '{}'",
+                         params.texture_store->directory().string());
+            textures.clear();
+        }
+
+        for(auto *item: remaining)
+        {
+            std::erase_if(item->second.textures, [&textures](const auto &path) { return !textures.contains(path); });
+            for(const auto &path: item->second.textures) { textures[path].num_references++; }
+        }
+    }
+
+    uint64_t total_size = 0;
+    for(const auto &[filename, bundle]: bundles) { total_size += bundle.size(); }
+    for(const auto &[path, texture]: textures) { total_size += texture.size; }
+    ret.size_before = total_size;
+
+    for(auto &[filename, bundle]: bundles)
+    {
+        if(bundle.stale)
+        {
+            total_size -= bundle.size();
+            ret.num_stale++;
+        }
+    }
+
+    // unreferenced textures, e.g. only used by stale bundles
+    for(auto &[path, texture]: textures)
+    {
+        if(!texture.num_references)
+        {
+            texture.removed = true;
+            total_size -= texture.size;
+        }
+    }
+
+    // least-recently used first
+    if(params.max_size && total_size > params.max_size)
+    {
+        std::vector<gc_bundle_t *> lru;
+        for(auto &[filename, bundle]: bundles)
+        {
+            if(!bundle.stale) { lru.push_back(&bundle); }
+        }
+        std::ranges::stable_sort(lru, {}, &gc_bundle_t::last_access);
+
+        for(auto *bundle: lru)
+        {
+            if(total_size <= params.max_size) { break; }
+            bundle->evicted = true;
+            total_size -= bundle->size();
+            ret.num_evicted++;
+
+            for(const auto &path: bundle->textures)
+            {
+                auto &texture = textures[path];
+                if(!--texture.num_references)
+                {
+                    texture.removed = true;
+                    total_size -= texture.size;
+                }
+            }
+        }
+    }
+    ret.size_after = total_size;
+    for(const auto &[path, texture]: textures) { ret.num_textures += texture.removed; }
+
+    if(params.dry_run) { return ret; }
+
+    // remove archive-entries with a single rewrite
+    std::vector<std::string> removed_bundles;
+    std::vector<std::string> removed_entries;
+    for(const auto &[filename, bundle]: bundles)
+    {
+        if(!bundle.stale && !bundle.evicted) { continue; }
+        if(bundle.file_size) { std::filesystem::remove(params.bundle_dir / filename, ec); }
+        if(bundle.entry_name) { removed_entries.push_back(*bundle.entry_name); }
+        else { removed_bundles.push_back(filename); }
+    }
+
+    // textures stay referenced by bundles remaining in a failed archive
+    bool entries_removed = true;
+    if(!removed_entries.empty())
+    {
+        try
+        {
+            vierkant::ziparchive_pool::global().modify(*params.zip_archive, [&](vierkant::ziparchive &archive) {
+                for(const auto &entry_name: removed_entries) { archive.remove_file(entry_name); }
+            });
+            for(const auto &entry_name: removed_entries)
+            {
+                removed_bundles.push_back(std::filesystem::path(entry_name).filename().string());
+            }
+        } catch(const std::exception &e)
+        {
+            spdlog::error("could not compact '{}': {}", params.zip_archive->string(), e.what());
+            entries_removed = false;
+        }
+    }
+
+    for(const auto &[path, texture]: textures)
+    {
+        if(entries_removed && texture.removed) { std::filesystem::remove(path, ec); }
+    }
+
+    for(const auto &filename: removed_bundles) { manifest.remove(filename); }
+    for(const auto &filename: dangling_records) { manifest.remove(filename); }
+    return ret;
+}
+
+}// namespace vierkant_cereal
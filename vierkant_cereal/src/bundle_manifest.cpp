@@ -0,0 +1,269 @@
+#include <chrono>
+#include <fstream>
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <spdlog/spdlog.h>
+
+#include <vierkant_cereal/bundle_manifest.hpp>
+#include <vierkant_cereal/mapped_file.hpp>
+#include <vierkant_cereal/model_dependencies.hpp>
+#include <vierkant_cereal/vierkant_cereal.hpp>
+#include <vierkant_cereal/xxhash64.hpp>
+
+namespace vierkant_cereal
+{
+
+//! contributed to content-hashes by missing files
+constexpr uint64_t missing_file_hash = 0x4d495353494e4721ULL;
+
+namespace
+{
+
+//! bundle-record of manifest-version 1, without schema-version and last-access
+struct bundle_record_v1_t
+{
+    std::string model_path;
+    uint64_t content_hash = 0;
+    std::vector<std::string> dependencies;
+
+    template<class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(cereal::make_nvp("model_path", model_path), cereal::make_nvp("content_hash", content_hash),
+                cereal::make_nvp("dependencies", dependencies));
+    }
+};
+
+}// namespace
+
+//! current time in seconds since epoch
+static int64_t now_seconds()
+{
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::seconds>(now).count();
+}
+
+static std::optional<bundle_manifest::file_stamp_t> file_stamp(const std::filesystem::path &path)
+{
+    std::error_code ec;
+    bundle_manifest::file_stamp_t ret;
+    ret.size = std::filesystem::file_size(path, ec);
+    if(ec) { return {}; }
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    if(ec) { return {}; }
+    ret.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return ret;
+}
+
+//! hash of a file's contents, read via memory-mapping
+static uint64_t hash_file_contents(const std::filesystem::path &path)
+{
+    if(auto mapped = mapped_file::open(path)) { return xxh64(mapped->data(), mapped->size()); }
+
+    // empty or unmappable files
+    std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
+    if(!ifs) { return missing_file_hash; }
+    std::vector<char> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    return xxh64(data.data(), data.size());
+}
+
+template<typename FileHash>
+static uint64_t content_hash(const std::filesystem::path &model_path, FileHash &&file_hash)
+{
+    uint64_t ret = file_hash(model_path);
+    for(const auto &dependency: model_dependencies(model_path))
+    {
+        uint64_t hash = file_hash(dependency);
+        ret = xxh64(&hash, sizeof(hash), ret);
+    }
+    return ret;
+}
+
+uint64_t model_content_hash(const std::filesystem::path &model_path)
+{
+    return content_hash(model_path, [](const std::filesystem::path &path) {
+        return std::filesystem::exists(path) ? hash_file_contents(path) : missing_file_hash;
+    });
+}
+
+bundle_manifest::bundle_manifest(std::filesystem::path path) : m_path(std::move(path))
+{
+    std::ifstream ifs(m_path);
+    if(!ifs.is_open()) { return; }
+
+    try
+    {
+        uint32_t file_version = 0;
+        cereal::JSONInputArchive archive(ifs);
+        archive(cereal::make_nvp("version", file_version));
+
+        if(file_version == 1)
+        {
+            // schema-version and last-access are unknown, collect_bundle_garbage falls back to file-times.
+            // model-paths were stored as passed, possibly relative to the working-directory.
+            std::map<std::string, bundle_record_v1_t> records_v1;
+            archive(cereal::make_nvp("files", m_files), cereal::make_nvp("bundles", records_v1));
+            for(auto &[filename, record_v1]: records_v1)
+            {
+                auto &record = m_bundles[filename];
+                record.model_path =
+                        std::filesystem::absolute(record_v1.model_path).lexically_normal().generic_string();
+                record.content_hash = record_v1.content_hash;
+                record.dependencies = std::move(record_v1.dependencies);
+            }
+            m_modified = true;
+            spdlog::debug("upgraded manifest '{}' from version 1: {} bundle(s)", m_path.string(), m_bundles.size());
+            return;
+        }
+        if(file_version != version)
+        {
+            spdlog::debug("discarding manifest '{}' with version {}", m_path.string(), file_version);
+            return;
+        }
+        archive(cereal::make_nvp("files", m_files), cereal::make_nvp("bundles", m_bundles));
+    } catch(const std::exception &e)
+    {
+        spdlog::warn("could not read manifest '{}': {}", m_path.string(), e.what());
+        m_files.clear();
+        m_bundles.clear();
+        m_modified = false;
+    }
+}
+
+uint64_t bundle_manifest::file_hash(const std::filesystem::path &path)
+{
+    auto stamp = file_stamp(path);
+    if(!stamp) { return missing_file_hash; }
+
+    auto key = std::filesystem::absolute(path).lexically_normal().generic_string();
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_files.find(key);
+        if(it != m_files.end() && it->second.size == stamp->size && it->second.mtime == stamp->mtime)
+        {
+            return it->second.hash;
+        }
+    }
+
+    // hashed without holding the lock
+    stamp->hash = hash_file_contents(path);
+
+    std::lock_guard lock(m_mutex);
+    m_files[key] = *stamp;
+    m_modified = true;
+    return stamp->hash;
+}
+
+uint64_t bundle_manifest::content_hash(const std::filesystem::path &model_path)
+{
+    return vierkant_cereal::content_hash(model_path,
+                                         [this](const std::filesystem::path &path) { return file_hash(path); });
+}
+
+void bundle_manifest::record(const std::filesystem::path &bundle_path, const std::filesystem::path &model_path,
+                             uint64_t content_hash)
+{
+    bundle_record_t record;
+    record.model_path = std::filesystem::absolute(model_path).lexically_normal().generic_string();
+    record.content_hash = content_hash;
+    for(const auto &dependency: model_dependencies(model_path))
+    {
+        record.dependencies.push_back(dependency.generic_string());
+    }
+    record.schema_version = bundle_schema_version;
+    record.last_access = now_seconds();
+
+    std::lock_guard lock(m_mutex);
+    m_bundles[bundle_path.filename().string()] = std::move(record);
+    m_modified = true;
+}
+
+void bundle_manifest::touch(const std::filesystem::path &bundle_path)
+{
+    auto now = now_seconds();
+    std::lock_guard lock(m_mutex);
+    auto it = m_bundles.find(bundle_path.filename().string());
+    if(it != m_bundles.end() && it->second.last_access != now)
+    {
+        it->second.last_access = now;
+        m_modified = true;
+    }
+}
+
+bool bundle_manifest::set_schema_version(const std::filesystem::path &bundle_path, uint32_t schema_version)
+{
+    std::lock_guard lock(m_mutex);
+    auto it = m_bundles.find(bundle_path.filename().string());
+    if(it == m_bundles.end()) { return false; }
+    if(it->second.schema_version != schema_version)
+    {
+        it->second.schema_version = schema_version;
+        m_modified = true;
+    }
+    return true;
+}
+
+bool bundle_manifest::remove(const std::filesystem::path &bundle_path)
+{
+    std::lock_guard lock(m_mutex);
+    if(!m_bundles.erase(bundle_path.filename().string())) { return false; }
+    m_modified = true;
+    return true;
+}
+
+std::optional<bundle_manifest::bundle_record_t> bundle_manifest::find(const std::filesystem::path &bundle_path) const
+{
+    std::lock_guard lock(m_mutex);
+    auto it = m_bundles.find(bundle_path.filename().string());
+    if(it != m_bundles.end()) { return it->second; }
+    return {};
+}
+
+std::map<std::string, bundle_manifest::bundle_record_t> bundle_manifest::records() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_bundles;
+}
+
+bool bundle_manifest::modified() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_modified;
+}
+
+bool bundle_manifest::save()
+{
+    std::lock_guard lock(m_mutex);
+    if(!m_modified) { return true; }
+
+    // unique across processes, shards of a cache_4km-run may share the manifest-directory
+    auto tmp_path = temp_file_path(m_path);
+
+    try
+    {
+        if(m_path.has_parent_path()) { std::filesystem::create_directories(m_path.parent_path()); }
+        {
+            std::ofstream ofs(tmp_path);
+            {
+                cereal::JSONOutputArchive archive(ofs);
+                archive(cereal::make_nvp("version", version), cereal::make_nvp("files", m_files),
+                        cereal::make_nvp("bundles", m_bundles));
+            }
+            if(!ofs) { throw std::runtime_error("write failed"); }
+        }
+        std::filesystem::rename(tmp_path, m_path);
+        m_modified = false;
+        return true;
+    } catch(const std::exception &e)
+    {
+        spdlog::error("could not write manifest '{}': {}", m_path.string(), e.what());
+        std::error_code ec;
+        std::filesystem::remove(tmp_path, ec);
+    }
+    return false;
+}
+
+}// namespace vierkant_cereal
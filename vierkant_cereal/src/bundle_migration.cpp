@@ -0,0 +1,196 @@
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <vierkant_cereal/bundle_archive_writer.hpp>
+#include <vierkant_cereal/bundle_migration.hpp>
+#include <vierkant_cereal/texture_store.hpp>
+#include <vierkant_cereal/vierkant_cereal.hpp>
+#include <vierkant_cereal/ziparchive_pool.h>
+
+namespace vierkant_cereal
+{
+
+//! upgrade the texture-files of a store, they are plain bundle-files containing textures only
+static void migrate_texture_store(const texture_store &store, const bundle_migration_params_t &params,
+                                  bundle_migration_result_t &result)
+{
+    const std::string suffix = std::string(".") + texture_store::file_suffix;
+    std::error_code ec;
+
+    for(const auto &entry: std::filesystem::directory_iterator(store.directory(), ec))
+    {
+        if(!entry.is_regular_file(ec) || entry.path().extension() != suffix) { continue; }
+        result.num_textures++;
+
+        const auto &path = entry.path();
+        auto schema_version = load_bundle_schema_version(path);
+        if(!schema_version)
+        {
+            result.num_failed++;
+            continue;
+        }
+        if(*schema_version == bundle_schema_version) { continue; }
+        if(!bundle_schema_supported(*schema_version))
+        {
+            spdlog::debug("texture-file '{}' has unsupported schema-version {}", path.string(), *schema_version);
+            result.num_unsupported++;
+            continue;
+        }
+        if(params.dry_run)
+        {
+            result.num_textures_migrated++;
+            continue;
+        }
+
+        auto assets = load_model_bundle_file(path, {}, all_bundle_sections, params.pool);
+        if(!assets)
+        {
+            result.num_failed++;
+            continue;
+        }
+
+        // failed writes keep the previous file
+        save_bundle_file(*assets, path, {}, params.texture_codec);
+        if(load_bundle_schema_version(path) != bundle_schema_version)
+        {
+            result.num_failed++;
+            continue;
+        }
+        result.num_textures_migrated++;
+    }
+}
+
+bundle_migration_result_t migrate_bundles(bundle_manifest &manifest, const bundle_migration_params_t &params)
+{
+    bundle_migration_result_t ret;
+    const std::string suffix = std::string(".") + bundle_file_suffix;
+
+    // bundle-filenames, mapped to whether they are only stored as archive-entry
+    std::map<std::string, bool> bundles;
+    std::error_code ec;
+
+    for(const auto &entry: std::filesystem::directory_iterator(params.bundle_dir, ec))
+    {
+        if(entry.is_regular_file(ec) && entry.path().extension() == suffix)
+        {
+            bundles[entry.path().filename().string()] = false;
+        }
+    }
+
+    if(params.zip_archive)
+    {
+        if(auto index = vierkant::ziparchive_pool::global().index(*params.zip_archive))
+        {
+            auto entry_dir = bundle_entry_path(params.bundle_dir / "_", *params.zip_archive).parent_path();
+
+            for(const auto &[name, info]: *index)
+            {
+                std::filesystem::path entry_path = name;
+                if(entry_path.parent_path() != entry_dir || entry_path.extension() != suffix) { continue; }
+                bundles.try_emplace(entry_path.filename().string(), true);
+            }
+        }
+    }
+    ret.num_bundles = bundles.size();
+
+    // migrated archive-entries are committed in batches, each with a single rewrite.
+    // staged entries are held in memory until then
+    std::unique_ptr<bundle_archive_writer> archive_writer;
+    std::vector<std::filesystem::path> migrated_entries;
+    uint64_t staged_bytes = 0;
+    if(params.zip_archive && !params.dry_run)
+    {
+        archive_writer = std::make_unique<bundle_archive_writer>(*params.zip_archive, params.pool, false);
+    }
+
+    auto commit_entries = [&] {
+        if(migrated_entries.empty()) { return; }
+        try
+        {
+            archive_writer->checkpoint();
+            for(const auto &path: migrated_entries) { manifest.set_schema_version(path, bundle_schema_version); }
+            ret.num_migrated += migrated_entries.size();
+        } catch(const std::exception &e)
+        {
+            spdlog::error("could not commit '{}': {}", params.zip_archive->string(), e.what());
+            ret.num_failed += migrated_entries.size();
+        }
+        migrated_entries.clear();
+        staged_bytes = 0;
+    };
+
+    for(const auto &[filename, in_archive]: bundles)
+    {
+        auto bundle_path = params.bundle_dir / filename;
+        auto zip_archive = in_archive ? params.zip_archive : std::nullopt;
+
+        auto schema_version = load_bundle_schema_version(bundle_path, zip_archive);
+        if(!schema_version)
+        {
+            ret.num_failed++;
+            continue;
+        }
+        if(*schema_version == bundle_schema_version) { continue; }
+        if(!bundle_schema_supported(*schema_version))
+        {
+            spdlog::debug("bundle '{}' has unsupported schema-version {}", filename, *schema_version);
+            ret.num_unsupported++;
+            continue;
+        }
+        if(params.dry_run)
+        {
+            ret.num_migrated++;
+            continue;
+        }
+
+        // one bundle at a time, sections and images are decoded/encoded concurrently
+        auto assets = load_model_bundle_file(bundle_path, zip_archive, all_bundle_sections, params.pool);
+        if(!assets)
+        {
+            ret.num_failed++;
+            continue;
+        }
+
+        if(archive_writer)
+        {
+            try
+            {
+                auto entry = archive_writer->add(std::move(*assets), bundle_path, params.texture_codec,
+                                                 params.geometry_codec);
+                staged_bytes += entry.get().stored_size;
+                migrated_entries.push_back(bundle_path);
+            } catch(const std::exception &e)
+            {
+                spdlog::error("could not migrate '{}': {}", filename, e.what());
+                ret.num_failed++;
+            }
+            if((params.checkpoint_interval && migrated_entries.size() >= params.checkpoint_interval) ||
+               (params.checkpoint_bytes && staged_bytes >= params.checkpoint_bytes))
+            {
+                commit_entries();
+            }
+            continue;
+        }
+
+        // failed writes keep the previous bundle
+        save_bundle_file(*assets, bundle_path, {}, params.texture_codec, params.geometry_codec);
+        if(load_bundle_schema_version(bundle_path) != bundle_schema_version)
+        {
+            ret.num_failed++;
+            continue;
+        }
+        spdlog::debug("migrated '{}' from schema-version {}", filename, *schema_version);
+        manifest.set_schema_version(bundle_path, bundle_schema_version);
+        ret.num_migrated++;
+    }
+
+    if(archive_writer) { commit_entries(); }
+    if(params.texture_store) { migrate_texture_store(*params.texture_store, params, ret); }
+    return ret;
+}
+
+}// namespace vierkant_cereal
@@ -0,0 +1,90 @@
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <vierkant_cereal/bundle_schema.hpp>
+
+namespace vierkant_cereal
+{
+
+static thread_local const bundle_schema_scope_t *g_current_scope = nullptr;
+
+//! registered migrations, by their 'from_version'
+template<typename Fn>
+struct migration_registry_t
+{
+    std::mutex mutex;
+    std::multimap<uint32_t, Fn> migrations;
+
+    void add(uint32_t from_version, Fn fn)
+    {
+        std::lock_guard lock(mutex);
+        migrations.emplace(from_version, std::move(fn));
+    }
+
+    //! migrations from 'schema_version' up to the current one, in order
+    std::vector<Fn> path(uint32_t schema_version)
+    {
+        if(!bundle_schema_supported(schema_version))
+        {
+            throw std::runtime_error("unsupported bundle schema-version " + std::to_string(schema_version));
+        }
+        std::lock_guard lock(mutex);
+        std::vector<Fn> ret;
+        for(auto it = migrations.lower_bound(schema_version);
+            it != migrations.end() && it->first < bundle_schema_version; ++it)
+        {
+            ret.push_back(it->second);
+        }
+        return ret;
+    }
+};
+
+static migration_registry_t<model_migration_fn_t> &model_migrations()
+{
+    static migration_registry_t<model_migration_fn_t> registry;
+    return registry;
+}
+
+static migration_registry_t<material_migration_fn_t> &material_migrations()
+{
+    static migration_registry_t<material_migration_fn_t> registry;
+    return registry;
+}
+
+bundle_schema_scope_t::bundle_schema_scope_t(uint32_t schema_version)
+    : m_version(schema_version), m_previous(g_current_scope)
+{
+    g_current_scope = this;
+}
+
+bundle_schema_scope_t::~bundle_schema_scope_t() { g_current_scope = m_previous; }
+
+uint32_t bundle_schema_scope_t::version()
+{
+    return g_current_scope ? g_current_scope->m_version : bundle_schema_version;
+}
+
+void register_model_migration(uint32_t from_version, model_migration_fn_t fn)
+{
+    model_migrations().add(from_version, std::move(fn));
+}
+
+void register_material_migration(uint32_t from_version, material_migration_fn_t fn)
+{
+    material_migrations().add(from_version, std::move(fn));
+}
+
+void migrate_model_assets(vierkant::model::model_assets_t &assets, uint32_t schema_version)
+{
+    for(const auto &fn: model_migrations().path(schema_version)) { fn(assets); }
+}
+
+void migrate_material_data(vierkant::material_data_t &material_data, uint32_t schema_version)
+{
+    for(const auto &fn: material_migrations().path(schema_version)) { fn(material_data); }
+}
+
+}// namespace vierkant_cereal
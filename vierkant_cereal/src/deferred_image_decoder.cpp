@@ -0,0 +1,60 @@
+#include <spdlog/spdlog.h>
+
+#include <vierkant_cereal/bundle_container.hpp>
+#include <vierkant_cereal/deferred_image_decoder.hpp>
+#include <vierkant_cereal/texture_codec.hpp>
+
+namespace vierkant_cereal
+{
+
+static thread_local deferred_image_decoder *g_current_decoder = nullptr;
+
+deferred_image_decoder::scope_t::scope_t(deferred_image_decoder &decoder) : m_previous(g_current_decoder)
+{
+    g_current_decoder = &decoder;
+}
+
+deferred_image_decoder::scope_t::~scope_t() { g_current_decoder = m_previous; }
+
+deferred_image_decoder::~deferred_image_decoder()
+{
+    try
+    {
+        run(nullptr);
+    } catch(std::exception &e) { spdlog::error(e.what()); }
+}
+
+deferred_image_decoder *deferred_image_decoder::current() { return g_current_decoder; }
+
+void deferred_image_decoder::push(crocore::Image_<uint8_t> *image, std::vector<uint8_t> payload)
+{
+    std::lock_guard lock(m_mutex);
+    m_tasks.push_back({image, std::move(payload)});
+}
+
+void deferred_image_decoder::run(crocore::ThreadPoolClassic *pool)
+{
+    std::vector<task_t> tasks;
+    {
+        std::lock_guard lock(m_mutex);
+        tasks.swap(m_tasks);
+    }
+    parallel_for(
+            tasks.size(),
+            [&tasks](size_t i) {
+                auto &task = tasks[i];
+                *task.image = decode_texture(task.payload);
+
+                // release encoded data early
+                task.payload = {};
+            },
+            pool);
+}
+
+size_t deferred_image_decoder::size() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_tasks.size();
+}
+
+}// namespace vierkant_cereal
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <cereal/types/vector.hpp>
+
+#if defined(VIERKANT_CEREAL_MESHOPT)
+#include <meshoptimizer.h>
+#endif
+
+#include <vierkant_cereal/geometry_codec.hpp>
+#include <vierkant_cereal/serialization.hpp>
+
+namespace vierkant_cereal
+{
+
+//! encodings of a single buffer
+enum class buffer_encoding_t : uint32_t
+{
+    Raw = 0,
+    Vertices,
+    Triangles,
+    IndexSequence
+};
+
+//! an encoded buffer, with enough information to decode it
+struct encoded_buffer_t
+{
+    buffer_encoding_t encoding = buffer_encoding_t::Raw;
+    uint64_t count = 0;
+    uint32_t element_size = 0;
+    std::vector<uint8_t> data;
+
+    template<class Archive>
+    void serialize(Archive &archive)
+    {
+        archive(encoding, count, element_size, data);
+    }
+};
+
+bool geometry_codec_supported(geometry_codec_t codec)
+{
+#if defined(VIERKANT_CEREAL_MESHOPT)
+    return codec == geometry_codec_t::Zstd || codec == geometry_codec_t::Meshopt;
+#else
+    return codec == geometry_codec_t::Zstd;
+#endif
+}
+
+template<typename T>
+static encoded_buffer_t raw_buffer(const std::vector<T> &buffer)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    encoded_buffer_t ret;
+    ret.count = buffer.size();
+    ret.element_size = sizeof(T);
+    ret.data.resize(buffer.size() * sizeof(T));
+    if(!buffer.empty()) { std::memcpy(ret.data.data(), buffer.data(), ret.data.size()); }
+    return ret;
+}
+
+#if defined(VIERKANT_CEREAL_MESHOPT)
+
+//! vertex-codec for buffers of 'vertex_size' bytes per element
+static encoded_buffer_t encode_vertices(const uint8_t *data, size_t num_vertices, size_t vertex_size)
+{
+    encoded_buffer_t ret;
+    ret.encoding = buffer_encoding_t::Vertices;
+    ret.count = num_vertices;
+    ret.element_size = static_cast<uint32_t>(vertex_size);
+    ret.data.resize(meshopt_encodeVertexBufferBound(num_vertices, vertex_size));
+    ret.data.resize(meshopt_encodeVertexBuffer(ret.data.data(), ret.data.size(), data, num_vertices, vertex_size));
+    ret.data.shrink_to_fit();
+    return ret;
+}
+
+template<typename T>
+static encoded_buffer_t encode_vertices(const std::vector<T> &buffer)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    if(buffer.empty() || sizeof(T) % 4 || sizeof(T) > 256) { return raw_buffer(buffer); }
+    return encode_vertices(reinterpret_cast<const uint8_t *>(buffer.data()), buffer.size(), sizeof(T));
+}
+
+//! index-codec for triangle-lists, sequence-codec for other index-buffers
+template<typename T>
+static encoded_buffer_t encode_indices(const std::vector<T> &buffer, bool triangles)
+{
+    static_assert(std::is_integral_v<T> && sizeof(T) == sizeof(unsigned int));
+    if(buffer.empty()) { return raw_buffer(buffer); }
+    std::span<const unsigned int> indices(reinterpret_cast<const unsigned int *>(buffer.data()), buffer.size());
+
+    encoded_buffer_t ret;
+    ret.count = indices.size();
+    ret.element_size = sizeof(uint32_t);
+    size_t num_vertices = *std::ranges::max_element(indices) + size_t(1);
+
+    if(triangles && indices.size() % 3 == 0)
+    {
+        ret.encoding = buffer_encoding_t::Triangles;
+        ret.data.resize(meshopt_encodeIndexBufferBound(indices.size(), num_vertices));
+        ret.data.resize(meshopt_encodeIndexBuffer(ret.data.data(), ret.data.size(), indices.data(), indices.size()));
+    }
+    else
+    {
+        ret.encoding = buffer_encoding_t::IndexSequence;
+        ret.data.resize(meshopt_encodeIndexSequenceBound(indices.size(), num_vertices));
+        ret.data.resize(meshopt_encodeIndexSequence(ret.data.data(), ret.data.size(), indices.data(), indices.size()));
+    }
+    ret.data.shrink_to_fit();
+    return ret;
+}
+
+#endif
+
+template<typename T>
+static void decode_buffer(const encoded_buffer_t &encoded, std::vector<T> &buffer)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    uint64_t num_bytes = encoded.count * encoded.element_size;
+    if(num_bytes % sizeof(T)) { throw std::runtime_error("decode_geometry: buffer-size mismatch"); }
+    buffer.resize(num_bytes / sizeof(T));
+    if(!num_bytes) { return; }
+
+    // parameters meshoptimizer would assert on
+    bool valid_size = encoded.encoding == buffer_encoding_t::Vertices
+                              ? encoded.element_size % 4 == 0 && encoded.element_size <= 256
+                              : encoded.encoding == buffer_encoding_t::Raw || encoded.element_size == sizeof(uint32_t);
+    if(!valid_size) { throw std::runtime_error("decode_geometry: invalid element-size"); }
+
+    int result = -1;
+    switch(encoded.encoding)
+    {
+        case buffer_encoding_t::Raw:
+            if(encoded.data.size() == num_bytes)
+            {
+                std::memcpy(buffer.data(), encoded.data.data(), num_bytes);
+                result = 0;
+            }
+            break;
+#if defined(VIERKANT_CEREAL_MESHOPT)
+        case buffer_encoding_t::Vertices:
+            result = meshopt_decodeVertexBuffer(buffer.data(), encoded.count, encoded.element_size,
+                                                encoded.data.data(), encoded.data.size());
+            break;
+        case buffer_encoding_t::Triangles:
+            result = meshopt_decodeIndexBuffer(buffer.data(), encoded.count, encoded.element_size,
+                                               encoded.data.data(), encoded.data.size());
+            break;
+        case buffer_encoding_t::IndexSequence:
+            result = meshopt_decodeIndexSequence(buffer.data(), encoded.count, encoded.element_size,
+                                                 encoded.data.data(), encoded.data.size());
+            break;
+#endif
+        default: throw std::runtime_error("decode_geometry: unsupported buffer-encoding");
+    }
+    if(result != 0) { throw std::runtime_error("decode_geometry: corrupt buffer"); }
+}
+
+void encode_geometry(cereal::BinaryOutputArchive &archive, const vierkant::mesh_buffer_bundle_t &bundle,
+                     bool preserve_triangles)
+{
+#if defined(VIERKANT_CEREAL_MESHOPT)
+    // vertex-buffer with the bundle's stride
+    encoded_buffer_t vertices;
+    const auto &vertex_buffer = bundle.vertex_buffer;
+    if(bundle.vertex_stride && bundle.vertex_stride % 4 == 0 && bundle.vertex_stride <= 256 &&
+       vertex_buffer.size() % bundle.vertex_stride == 0 && !vertex_buffer.empty())
+    {
+        vertices = encode_vertices(reinterpret_cast<const uint8_t *>(vertex_buffer.data()),
+                                   vertex_buffer.size() / bundle.vertex_stride, bundle.vertex_stride);
+    }
+    else { vertices = raw_buffer(vertex_buffer); }
+
+    // the triangle-codec rotates triangles, only valid if all entries are triangle-lists
+    bool triangle_lists = !preserve_triangles && std::ranges::all_of(bundle.entries, [](const auto &entry) {
+        return entry.primitive_type == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    });
+
+    // remaining fields as in 'serialize(Archive &, mesh_buffer_bundle_t &)'
+    archive(bundle.vertex_stride, bundle.vertex_attribs, bundle.entries, bundle.num_materials, bundle.morph_buffer,
+            bundle.num_morph_targets, bundle.meshlets, bundle.meshlet_triangles);
+    archive(vertices, encode_indices(bundle.index_buffer, triangle_lists),
+            encode_vertices(bundle.bone_vertex_buffer), encode_indices(bundle.meshlet_vertices, false));
+#else
+    (void) archive;
+    (void) bundle;
+    (void) preserve_triangles;
+    throw std::runtime_error("encode_geometry: meshoptimizer not available");
+#endif
+}
+
+void decode_geometry(cereal::BinaryInputArchive &archive, vierkant::mesh_buffer_bundle_t &bundle)
+{
+    archive(bundle.vertex_stride, bundle.vertex_attribs, bundle.entries, bundle.num_materials, bundle.morph_buffer,
+            bundle.num_morph_targets, bundle.meshlets, bundle.meshlet_triangles);
+
+    encoded_buffer_t vertices, indices, bone_vertices, meshlet_vertices;
+    archive(vertices, indices, bone_vertices, meshlet_vertices);
+    decode_buffer(vertices, bundle.vertex_buffer);
+    decode_buffer(indices, bundle.index_buffer);
+    decode_buffer(bone_vertices, bundle.bone_vertex_buffer);
+    decode_buffer(meshlet_vertices, bundle.meshlet_vertices);
+}
+
+}// namespace vierkant_cereal
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <vierkant_cereal/mapped_file.hpp>
+
+namespace vierkant_cereal
+{
+
+//! granularity for releasing consumed pages while streaming from a mapping
+constexpr size_t g_release_chunk_size = 1U << 24;
+
+mapped_file_ptr mapped_file::open(const std::filesystem::path &path)
+{
+    auto ret = std::shared_ptr<mapped_file>(new mapped_file());
+
+#if defined(_WIN32)
+    HANDLE file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file_handle == INVALID_HANDLE_VALUE) { return nullptr; }
+    ret->m_file_handle = file_handle;
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file_handle, &file_size) || !file_size.QuadPart) { return nullptr; }
+    ret->m_size = static_cast<size_t>(file_size.QuadPart);
+
+    ret->m_mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!ret->m_mapping_handle) { return nullptr; }
+
+    ret->m_data = static_cast<const uint8_t *>(MapViewOfFile(ret->m_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if(!ret->m_data) { return nullptr; }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) { return nullptr; }
+
+    struct stat file_stat = {};
+    if(fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || !file_stat.st_size)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+    ret->m_size = static_cast<size_t>(file_stat.st_size);
+
+    // the mapping holds its own reference to the file, the descriptor is not needed afterwards
+    void *ptr = mmap(nullptr, ret->m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if(ptr == MAP_FAILED) { return nullptr; }
+    ret->m_data = static_cast<const uint8_t *>(ptr);
+    madvise(ptr, ret->m_size, MADV_SEQUENTIAL);
+#endif
+    return ret;
+}
+
+mapped_file::~mapped_file()
+{
+#if defined(_WIN32)
+    if(m_data) { UnmapViewOfFile(m_data); }
+    if(m_mapping_handle) { CloseHandle(m_mapping_handle); }
+    if(m_file_handle) { CloseHandle(m_file_handle); }
+#else
+    if(m_data) { munmap(const_cast<uint8_t *>(m_data), m_size); }
+#endif
+}
+
+void mapped_file::release(size_t offset, size_t num_bytes) const
+{
+#if !defined(_WIN32)
+    // madvise requires page-aligned addresses, only release fully covered pages
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t begin = (offset + page_size - 1) / page_size * page_size;
+    size_t end = std::min(offset + num_bytes, m_size) / page_size * page_size;
+    if(end > begin) { madvise(const_cast<uint8_t *>(m_data) + begin, end - begin, MADV_DONTNEED); }
+#else
+    (void) offset;
+    (void) num_bytes;
+#endif
+}
+
+memory_streambuf::memory_streambuf(const uint8_t *data, size_t num_bytes, mapped_file_ptr owner)
+    : m_owner(std::move(owner))
+{
+    auto ptr = const_cast<char *>(reinterpret_cast<const char *>(data));
+    setg(ptr, ptr, ptr + num_bytes);
+}
+
+std::streamsize memory_streambuf::xsgetn(char *s, std::streamsize n)
+{
+    auto num_bytes = std::min<std::streamsize>(n, egptr() - gptr());
+    if(num_bytes <= 0) { return 0; }
+    std::memcpy(s, gptr(), num_bytes);
+    setg(eback(), gptr() + num_bytes, egptr());
+    release_consumed();
+    return num_bytes;
+}
+
+std::streambuf::pos_type memory_streambuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                  std::ios_base::openmode which)
+{
+    if(!(which & std::ios_base::in)) { return pos_type(off_type(-1)); }
+
+    off_type base = 0;
+    if(dir == std::ios_base::cur) { base = gptr() - eback(); }
+    else if(dir == std::ios_base::end) { base = egptr() - eback(); }
+    return seekpos(pos_type(base + off), which);
+}
+
+std::streambuf::pos_type memory_streambuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    off_type offset = pos;
+    if(!(which & std::ios_base::in) || offset < 0 || offset > egptr() - eback()) { return pos_type(off_type(-1)); }
+    setg(eback(), eback() + offset, egptr());
+
+    // seeking backwards re-faults previously released pages
+    m_num_released = std::min<size_t>(m_num_released, offset);
+    return pos;
+}
+
+void memory_streambuf::release_consumed()
+{
+    if(!m_owner) { return; }
+    auto num_consumed = static_cast<size_t>(gptr() - eback());
+    if(num_consumed >= m_num_released + g_release_chunk_size)
+    {
+        auto base = reinterpret_cast<const uint8_t *>(eback()) - m_owner->data();
+        m_owner->release(base + m_num_released, num_consumed - m_num_released);
+        m_num_released = num_consumed;
+    }
+}
+
+mapped_istream::mapped_istream(mapped_file_ptr mapped_file)
+    : std::istream(nullptr), m_file(std::move(mapped_file)),
+      m_streambuf(m_file ? m_file->data() : nullptr, m_file ? m_file->size() : 0, m_file)
+{
+    rdbuf(&m_streambuf);
+}
+
+}// namespace vierkant_cereal
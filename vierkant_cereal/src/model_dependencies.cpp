@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <cereal/archives/json.hpp>
+
+#include <vierkant_cereal/model_dependencies.hpp>
+
+namespace vierkant_cereal
+{
+
+//! magic and chunk-type for binary glTF
+constexpr char glb_magic[4] = {'g', 'l', 'T', 'F'};
+constexpr uint32_t glb_chunk_json = 0x4E4F534A;
+
+//! texture-keys in OBJ material-libraries, referencing a file with their last argument
+constexpr const char *mtl_texture_keys[] = {"map_", "bump", "disp", "decal", "refl", "norm"};
+
+static std::string read_file(const std::filesystem::path &path)
+{
+    std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
+    if(!ifs) { return {}; }
+    std::ostringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+static uint32_t get_le_u32(const char *src)
+{
+    uint32_t value = 0;
+    for(size_t i = 4; i > 0; --i) { value = (value << 8) | static_cast<uint8_t>(src[i - 1]); }
+    return value;
+}
+
+//! decode %-escapes in a relative URI
+static std::string decode_uri(const std::string &uri)
+{
+    std::string ret;
+    ret.reserve(uri.size());
+
+    for(size_t i = 0; i < uri.size(); ++i)
+    {
+        if(uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(static_cast<uint8_t>(uri[i + 1])) &&
+           std::isxdigit(static_cast<uint8_t>(uri[i + 2])))
+        {
+            ret.push_back(static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16)));
+            i += 2;
+        }
+        else { ret.push_back(uri[i]); }
+    }
+    return ret;
+}
+
+//! external buffers/images referenced by a glTF json-document
+static std::vector<std::filesystem::path> gltf_dependencies(const std::string &json,
+                                                            const std::filesystem::path &base_dir)
+{
+    CEREAL_RAPIDJSON_NAMESPACE::Document doc;
+    doc.Parse(json.c_str(), json.size());
+    if(doc.HasParseError() || !doc.IsObject()) { return {}; }
+
+    std::vector<std::filesystem::path> ret;
+    for(const char *key: {"buffers", "images"})
+    {
+        auto it = doc.FindMember(key);
+        if(it == doc.MemberEnd() || !it->value.IsArray()) { continue; }
+
+        for(const auto &element: it->value.GetArray())
+        {
+            if(!element.IsObject()) { continue; }
+            auto uri_it = element.FindMember("uri");
+            if(uri_it == element.MemberEnd() || !uri_it->value.IsString()) { continue; }
+
+            std::string uri(uri_it->value.GetString(), uri_it->value.GetStringLength());
+            if(uri.starts_with("data:") || uri.find("://") != std::string::npos) { continue; }
+
+            // uris are utf-8
+            auto decoded = decode_uri(uri);
+            ret.push_back((base_dir / std::u8string(decoded.begin(), decoded.end())).lexically_normal());
+        }
+    }
+    return ret;
+}
+
+static std::vector<std::filesystem::path> glb_dependencies(const std::filesystem::path &path)
+{
+    // header (magic, version, length) followed by a json-chunk (length, type, data)
+    constexpr size_t header_size = 12, chunk_header_size = 8;
+    char header[header_size + chunk_header_size] = {};
+
+    std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
+    if(!ifs.read(header, sizeof(header)) || std::memcmp(header, glb_magic, sizeof(glb_magic)) != 0) { return {}; }
+
+    auto glb_size = get_le_u32(header + 8);
+    auto chunk_size = get_le_u32(header + header_size);
+    auto chunk_type = get_le_u32(header + header_size + 4);
+    if(chunk_type != glb_chunk_json || chunk_size > glb_size) { return {}; }
+
+    std::string json(chunk_size, '\0');
+    if(!ifs.read(json.data(), static_cast<std::streamsize>(json.size()))) { return {}; }
+    return gltf_dependencies(json, path.parent_path());
+}
+
+static std::vector<std::filesystem::path> obj_dependencies(const std::filesystem::path &path)
+{
+    std::vector<std::filesystem::path> ret;
+    auto base_dir = path.parent_path();
+
+    std::ifstream obj_stream(path);
+    std::string line, token;
+
+    while(std::getline(obj_stream, line))
+    {
+        std::istringstream line_stream(line);
+        if(!(line_stream >> token) || token != "mtllib") { continue; }
+
+        while(line_stream >> token)
+        {
+            auto mtl_path = (base_dir / token).lexically_normal();
+            ret.push_back(mtl_path);
+
+            std::ifstream mtl_stream(mtl_path);
+            std::string mtl_line, key;
+
+            while(std::getline(mtl_stream, mtl_line))
+            {
+                std::istringstream mtl_line_stream(mtl_line);
+                if(!(mtl_line_stream >> key)) { continue; }
+
+                bool is_texture = false;
+                for(const char *texture_key: mtl_texture_keys) { is_texture = is_texture || key.starts_with(texture_key); }
+                if(!is_texture) { continue; }
+
+                // options precede the filename
+                std::string arg, file;
+                while(mtl_line_stream >> arg) { file = arg; }
+                if(!file.empty()) { ret.push_back((mtl_path.parent_path() / file).lexically_normal()); }
+            }
+        }
+    }
+    return ret;
+}
+
+std::vector<std::filesystem::path> model_dependencies(const std::filesystem::path &model_path)
+{
+    auto ext = model_path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if(ext == ".gltf") { return gltf_dependencies(read_file(model_path), model_path.parent_path()); }
+    if(ext == ".glb") { return glb_dependencies(model_path); }
+    if(ext == ".obj") { return obj_dependencies(model_path); }
+    return {};
+}
+
+}// namespace vierkant_cereal
@@ -0,0 +1,80 @@
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cereal/version.hpp>
+#include <vierkant_cereal/optional_nvp_cereal.hpp>
+
+// json_has_member reads private members of cereal's JSONInputArchive. they were verified against the pinned
+// cereal-release (extern/cereal, v1.3.2). before updating cereal, compare with JSONInputArchive::Iterator::search
+// and adjust the version below.
+static_assert(CEREAL_VERSION_MAJOR == 1 && CEREAL_VERSION_MINOR == 3 && CEREAL_VERSION_PATCH == 2,
+              "json_has_member relies on private members of cereal::JSONInputArchive, verify them for this version");
+
+namespace vierkant_cereal
+{
+
+namespace
+{
+//! explicit instantiations are exempt from access-checks, 'member_pointer' exposes a private member through a tag
+template<typename Tag, auto Member>
+struct member_access_t
+{
+    friend constexpr auto member_pointer(Tag) { return Member; }
+};
+
+struct iterator_stack_tag
+{
+    friend constexpr auto member_pointer(iterator_stack_tag);
+};
+
+struct member_begin_tag
+{
+    friend constexpr auto member_pointer(member_begin_tag);
+};
+
+struct member_end_tag
+{
+    friend constexpr auto member_pointer(member_end_tag);
+};
+}// namespace
+
+// JSONInputArchive offers no way to look up members without throwing
+template struct member_access_t<iterator_stack_tag, &cereal::JSONInputArchive::itsIteratorStack>;
+template struct member_access_t<member_begin_tag, &cereal::JSONInputArchive::Iterator::itsMemberItBegin>;
+template struct member_access_t<member_end_tag, &cereal::JSONInputArchive::Iterator::itsMemberItEnd>;
+
+namespace
+{
+//! types of the accessed members, as used below
+using iterator_stack_t = std::remove_cvref_t<decltype(std::declval<const cereal::JSONInputArchive &>().*
+                                                      member_pointer(iterator_stack_tag{}))>;
+using iterator_t = iterator_stack_t::value_type;
+using member_iterator_t = CEREAL_RAPIDJSON_NAMESPACE::Value::ConstMemberIterator;
+
+static_assert(std::is_same_v<iterator_stack_t, std::vector<iterator_t>>);
+static_assert(std::is_same_v<std::remove_cvref_t<decltype(std::declval<const iterator_t &>().*
+                                                          member_pointer(member_begin_tag{}))>,
+                             member_iterator_t>);
+static_assert(std::is_same_v<std::remove_cvref_t<decltype(std::declval<const iterator_t &>().*
+                                                          member_pointer(member_end_tag{}))>,
+                             member_iterator_t>);
+}// namespace
+
+bool json_has_member(const cereal::JSONInputArchive &archive, const char *name)
+{
+    const auto &iterator_stack = archive.*member_pointer(iterator_stack_tag{});
+    if(iterator_stack.empty() || !name) { return false; }
+
+    // member-range is empty for arrays and values, same lookup as JSONInputArchive::Iterator::search
+    const auto &current = iterator_stack.back();
+    const auto end = current.*member_pointer(member_end_tag{});
+    for(auto it = current.*member_pointer(member_begin_tag{}); it != end; ++it)
+    {
+        if(std::strcmp(it->name.GetString(), name) == 0) { return true; }
+    }
+    return false;
+}
+
+}// namespace vierkant_cereal
@@ -0,0 +1,300 @@
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <vierkant_cereal/mapped_file.hpp>
+#include <vierkant_cereal/scene_cereal.hpp>
+#include <vierkant_cereal/scene_json_reader.hpp>
+#include <vierkant_cereal/serialization.hpp>
+
+// cereal's bundled rapidjson, namespaced by cereal/archives/json.hpp
+#include <cereal/external/rapidjson/reader.h>
+#include <cereal/external/rapidjson/stringbuffer.h>
+#include <cereal/external/rapidjson/writer.h>
+
+namespace vierkant_cereal
+{
+
+namespace rj = CEREAL_RAPIDJSON_NAMESPACE;
+
+//! numbers are forwarded verbatim, so captured elements are parsed exactly like the original document
+constexpr unsigned scene_json_parse_flags =
+        rj::kParseDefaultFlags | rj::kParseNumbersAsStringsFlag | rj::kParseIterativeFlag;
+
+//! captured elements are deserialized once a batch exceeds this size (or their member ends)
+constexpr size_t scene_json_batch_size = 1U << 16;
+
+//! size of the read-buffer for the input-stream
+constexpr size_t scene_json_read_buffer_size = 1U << 16;
+
+namespace
+{
+
+//! a member of scene_data_t, loaded from its json-value (or from single elements of it)
+struct scene_member_t
+{
+    const char *name;
+    std::function<void(cereal::JSONInputArchive &)> load;
+
+    //! true, if the member is a json-array loaded element by element
+    bool elements = false;
+
+    //! true, if the member is mandatory (make_nvp in serialize(Archive &, scene_data_t &))
+    bool required = false;
+
+    bool found = false;
+};
+
+//! load a map-element, stored by cereal as {"key": .., "value": ..}
+template<typename Map>
+std::function<void(cereal::JSONInputArchive &)> map_element_loader(Map &map)
+{
+    return [&map](cereal::JSONInputArchive &archive) {
+        typename Map::key_type key;
+        typename Map::mapped_type value;
+        archive(cereal::make_map_item(key, value));
+        map.emplace(std::move(key), std::move(value));
+    };
+}
+
+/**
+ * @brief   scene_json_handler_t is a rapidjson SAX-handler for scene-json.
+ *
+ * the document is '{"value0": {<scene-members>}}'. values of scene-members (or elements of array-members) are
+ * captured as json-text and deserialized in batches with cereal::JSONInputArchive, so per-type
+ * serialize-functions stay the only place defining the json-layout.
+ */
+class scene_json_handler_t
+{
+public:
+    scene_json_handler_t(scene_data_t &data, const scene_model_path_fn_t &model_path_fn)
+        : m_writer(m_buffer)
+    {
+        auto model_path_loader = [&data, &model_path_fn](cereal::JSONInputArchive &archive) {
+            vierkant::MeshId mesh_id;
+            std::string path;
+            archive(cereal::make_map_item(mesh_id, path));
+            if(model_path_fn) { model_path_fn(mesh_id, path); }
+            data.model_paths.emplace(mesh_id, std::move(path));
+        };
+
+        // clang-format off
+        m_members = {
+                {"name", [&data](auto &ar) { ar(data.name); }},
+                {"environment_path", [&data](auto &ar) { ar(data.environment_path); }},
+                {"environment_factor", [&data](auto &ar) { ar(data.environment_factor); }},
+                {"scene_paths", map_element_loader(data.scene_paths), true},
+                {"model_paths", model_path_loader, true, true},
+                {"nodes", [&data](auto &ar) { ar(data.nodes.emplace_back()); }, true, true},
+                {"scene_roots", [&data](auto &ar) { ar(data.scene_roots); }, false, true},
+                {"material_bundle_path", [&data](auto &ar) { ar(data.material_bundle_path); }},
+                {"lights", map_element_loader(data.lights), true},
+                {"materials", map_element_loader(data.materials), true},
+                {"texture_samplers", map_element_loader(data.texture_samplers), true},
+                {"active_camera", [&data](auto &ar) { ar(data.active_camera); }}};
+        // clang-format on
+    }
+
+    //! throws std::runtime_error, if a mandatory member was not found
+    void check_complete() const
+    {
+        if(!m_scene_found) { throw std::runtime_error("read_scene_json: missing scene-object"); }
+        for(const auto &member: m_members)
+        {
+            if(member.required && !member.found)
+            {
+                throw std::runtime_error(std::string("read_scene_json: missing member '") + member.name + "'");
+            }
+        }
+    }
+
+    // rapidjson handler-interface
+    bool Null() { return scalar([](auto &w) { return w.Null(); }); }
+    bool Bool(bool b) { return scalar([b](auto &w) { return w.Bool(b); }); }
+    bool Int(int i) { return scalar([i](auto &w) { return w.Int(i); }); }
+    bool Uint(unsigned u) { return scalar([u](auto &w) { return w.Uint(u); }); }
+    bool Int64(int64_t i) { return scalar([i](auto &w) { return w.Int64(i); }); }
+    bool Uint64(uint64_t u) { return scalar([u](auto &w) { return w.Uint64(u); }); }
+    bool Double(double d) { return scalar([d](auto &w) { return w.Double(d); }); }
+
+    bool RawNumber(const char *str, rj::SizeType length, bool)
+    {
+        // Writer::RawNumber would quote the number
+        return scalar([str, length](auto &w) { return w.RawValue(str, length, rj::kNumberType); });
+    }
+
+    bool String(const char *str, rj::SizeType length, bool copy)
+    {
+        return scalar([str, length, copy](auto &w) { return w.String(str, length, copy); });
+    }
+
+    bool Key(const char *str, rj::SizeType length, bool copy)
+    {
+        if(m_capturing) { return m_writer.Key(str, length, copy); }
+        if(m_depth == 2)
+        {
+            m_member = nullptr;
+            for(auto &member: m_members)
+            {
+                if(std::strlen(member.name) == length && !std::memcmp(member.name, str, length))
+                {
+                    member.found = true;
+                    m_member = &member;
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool StartObject() { return start_container(true); }
+    bool StartArray() { return start_container(false); }
+
+    bool EndObject(rj::SizeType count) { return end_container(true, count); }
+    bool EndArray(rj::SizeType count) { return end_container(false, count); }
+
+private:
+    bool start_container(bool object)
+    {
+        if(!m_capturing)
+        {
+            // root-object, containing the scene-object as its only value
+            if(m_depth == 0 || (m_depth == 1 && !m_scene_found))
+            {
+                m_scene_found = m_depth == 1;
+                m_depth++;
+                return object;
+            }
+            if(m_depth == 1) { return false; }
+
+            // array-member, loaded element by element
+            if(m_depth == 2 && !object && m_member && m_member->elements)
+            {
+                m_in_elements = true;
+                m_depth++;
+                return true;
+            }
+            begin_value();
+        }
+        m_depth++;
+        return object ? m_writer.StartObject() : m_writer.StartArray();
+    }
+
+    bool end_container(bool object, rj::SizeType count)
+    {
+        m_depth--;
+        if(!m_capturing)
+        {
+            // end of an array-member
+            if(m_depth == 2 && m_in_elements)
+            {
+                m_in_elements = false;
+                flush();
+            }
+            return true;
+        }
+        bool ret = object ? m_writer.EndObject(count) : m_writer.EndArray(count);
+        if(m_depth == m_capture_depth) { end_value(); }
+        return ret;
+    }
+
+    template<typename Fn>
+    bool scalar(Fn &&write)
+    {
+        if(m_capturing) { return write(m_writer); }
+
+        // root- and scene-level only contain objects
+        if(m_depth < 2) { return false; }
+        begin_value();
+        bool ret = write(m_writer);
+        end_value();
+        return ret;
+    }
+
+    //! start capturing a member-value or array-element
+    void begin_value()
+    {
+        if(m_depth == 2 && m_member && m_member->elements)
+        {
+            throw std::runtime_error(std::string("read_scene_json: expected an array for '") + m_member->name + "'");
+        }
+
+        // batch of values, as members of one json-object
+        m_buffer.Put(m_num_pending ? ',' : '{');
+        for(char c: {'"', 'v', '"', ':'}) { m_buffer.Put(c); }
+        m_writer.Reset(m_buffer);
+        m_capturing = true;
+        m_capture_depth = m_depth;
+    }
+
+    void end_value()
+    {
+        m_capturing = false;
+        m_num_pending++;
+
+        // values of unknown members are skipped
+        if(!m_member)
+        {
+            m_buffer.Clear();
+            m_num_pending = 0;
+            return;
+        }
+        if(!m_in_elements || m_buffer.GetSize() >= scene_json_batch_size) { flush(); }
+    }
+
+    //! deserialize all captured values
+    void flush()
+    {
+        if(!m_num_pending) { return; }
+        m_buffer.Put('}');
+
+        memory_streambuf streambuf(reinterpret_cast<const uint8_t *>(m_buffer.GetString()), m_buffer.GetSize());
+        std::istream is(&streambuf);
+        {
+            cereal::JSONInputArchive archive(is);
+            for(size_t i = 0; i < m_num_pending; ++i) { m_member->load(archive); }
+        }
+        m_buffer.Clear();
+        m_num_pending = 0;
+    }
+
+    std::vector<scene_member_t> m_members;
+    scene_member_t *m_member = nullptr;
+
+    //! current nesting-depth (0: outside root-object, 1: root-object, 2: scene-object)
+    uint32_t m_depth = 0;
+    bool m_scene_found = false;
+    bool m_in_elements = false;
+
+    //! captured json-values, pending deserialization
+    rj::StringBuffer m_buffer;
+    rj::Writer<rj::StringBuffer> m_writer;
+    bool m_capturing = false;
+    uint32_t m_capture_depth = 0;
+    size_t m_num_pending = 0;
+};
+
+}// namespace
+
+scene_data_t read_scene_json(std::istream &is, const scene_model_path_fn_t &model_path_fn)
+{
+    scene_data_t ret;
+    scene_json_handler_t handler(ret, model_path_fn);
+
+    std::vector<char> read_buffer(scene_json_read_buffer_size);
+    rj::IStreamWrapper stream(is, read_buffer.data(), read_buffer.size());
+    rj::Reader reader;
+
+    if(!reader.Parse<scene_json_parse_flags>(stream, handler))
+    {
+        throw std::runtime_error("read_scene_json: parse-error " + std::to_string(reader.GetParseErrorCode()) +
+                                 " at offset " + std::to_string(reader.GetErrorOffset()));
+    }
+    handler.check_complete();
+    return ret;
+}
+
+}// namespace vierkant_cereal
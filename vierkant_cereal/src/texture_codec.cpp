@@ -0,0 +1,307 @@
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <zstd.h>
+
+#include <vierkant_cereal/texture_codec.hpp>
+
+namespace vierkant_cereal
+{
+
+constexpr uint8_t png_signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+constexpr uint8_t qoi_magic[] = {'q', 'o', 'i', 'f'};
+constexpr uint8_t raw_zstd_magic[] = {'4', 'K', 'R', 'Z'};
+
+constexpr size_t qoi_header_size = 14;
+constexpr uint8_t qoi_padding[] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+//! magic + width + height + num_components (u32, little-endian)
+constexpr size_t raw_zstd_header_size = 16;
+constexpr int raw_zstd_level = 3;
+
+static thread_local const texture_codec_scope_t *g_current_scope = nullptr;
+
+namespace
+{
+enum qoi_op : uint8_t
+{
+    QOI_OP_INDEX = 0x00,
+    QOI_OP_DIFF = 0x40,
+    QOI_OP_LUMA = 0x80,
+    QOI_OP_RUN = 0xc0,
+    QOI_OP_RGB = 0xfe,
+    QOI_OP_RGBA = 0xff,
+    QOI_MASK_2 = 0xc0
+};
+
+struct qoi_rgba_t
+{
+    uint8_t r = 0, g = 0, b = 0, a = 0;
+
+    bool operator==(const qoi_rgba_t &) const = default;
+};
+
+inline uint32_t qoi_hash(const qoi_rgba_t &c) { return (c.r * 3 + c.g * 5 + c.b * 7 + c.a * 11) % 64; }
+
+template<size_t N>
+inline bool has_prefix(const std::vector<uint8_t> &payload, const uint8_t (&prefix)[N])
+{ return payload.size() >= N && std::memcmp(payload.data(), prefix, N) == 0; }
+
+inline void put_u32_be(uint8_t *dst, uint32_t v)
+{
+    for(int i = 0; i < 4; ++i) { dst[i] = static_cast<uint8_t>(v >> (24 - 8 * i)); }
+}
+
+inline uint32_t get_u32_be(const uint8_t *src)
+{ return uint32_t(src[0]) << 24 | uint32_t(src[1]) << 16 | uint32_t(src[2]) << 8 | uint32_t(src[3]); }
+
+inline void put_u32_le(uint8_t *dst, uint32_t v)
+{
+    for(int i = 0; i < 4; ++i) { dst[i] = static_cast<uint8_t>(v >> (8 * i)); }
+}
+
+inline uint32_t get_u32_le(const uint8_t *src)
+{ return uint32_t(src[3]) << 24 | uint32_t(src[2]) << 16 | uint32_t(src[1]) << 8 | uint32_t(src[0]); }
+}// namespace
+
+static std::vector<uint8_t> encode_qoi(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t channels)
+{
+    size_t num_pixels = size_t(width) * height;
+    std::vector<uint8_t> ret(qoi_header_size + num_pixels * (channels + 1) + sizeof(qoi_padding));
+    uint8_t *out = ret.data();
+    std::memcpy(out, qoi_magic, sizeof(qoi_magic));
+    put_u32_be(out + 4, width);
+    put_u32_be(out + 8, height);
+    out[12] = static_cast<uint8_t>(channels);
+    out[13] = 0;
+    size_t p = qoi_header_size;
+
+    std::array<qoi_rgba_t, 64> index = {};
+    qoi_rgba_t px_prev = {0, 0, 0, 255}, px = px_prev;
+    uint32_t run = 0;
+
+    for(size_t i = 0; i < num_pixels; ++i)
+    {
+        const uint8_t *src = pixels + i * channels;
+        px = {src[0], src[1], src[2], channels == 4 ? src[3] : px_prev.a};
+
+        if(px == px_prev)
+        {
+            if(++run == 62 || i + 1 == num_pixels)
+            {
+                out[p++] = QOI_OP_RUN | (run - 1);
+                run = 0;
+            }
+            continue;
+        }
+        if(run)
+        {
+            out[p++] = QOI_OP_RUN | (run - 1);
+            run = 0;
+        }
+        uint32_t index_pos = qoi_hash(px);
+
+        if(index[index_pos] == px) { out[p++] = QOI_OP_INDEX | index_pos; }
+        else
+        {
+            index[index_pos] = px;
+
+            if(px.a == px_prev.a)
+            {
+                int8_t vr = static_cast<int8_t>(px.r - px_prev.r);
+                int8_t vg = static_cast<int8_t>(px.g - px_prev.g);
+                int8_t vb = static_cast<int8_t>(px.b - px_prev.b);
+                int8_t vg_r = static_cast<int8_t>(vr - vg);
+                int8_t vg_b = static_cast<int8_t>(vb - vg);
+
+                if(vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+                {
+                    out[p++] = QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+                }
+                else if(vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8)
+                {
+                    out[p++] = QOI_OP_LUMA | (vg + 32);
+                    out[p++] = (vg_r + 8) << 4 | (vg_b + 8);
+                }
+                else
+                {
+                    out[p++] = QOI_OP_RGB;
+                    out[p++] = px.r;
+                    out[p++] = px.g;
+                    out[p++] = px.b;
+                }
+            }
+            else
+            {
+                out[p++] = QOI_OP_RGBA;
+                out[p++] = px.r;
+                out[p++] = px.g;
+                out[p++] = px.b;
+                out[p++] = px.a;
+            }
+        }
+        px_prev = px;
+    }
+    std::memcpy(out + p, qoi_padding, sizeof(qoi_padding));
+    ret.resize(p + sizeof(qoi_padding));
+    return ret;
+}
+
+static crocore::Image_<uint8_t> decode_qoi(const std::vector<uint8_t> &payload)
+{
+    if(payload.size() < qoi_header_size + sizeof(qoi_padding)) { throw std::runtime_error("decode_qoi: truncated"); }
+    const uint8_t *in = payload.data();
+    uint32_t width = get_u32_be(in + 4), height = get_u32_be(in + 8), channels = in[12];
+    if(channels < 3 || channels > 4 || !width || !height) { throw std::runtime_error("decode_qoi: invalid header"); }
+
+    size_t num_pixels = size_t(width) * height;
+    std::vector<uint8_t> pixels(num_pixels * channels);
+
+    std::array<qoi_rgba_t, 64> index = {};
+    qoi_rgba_t px = {0, 0, 0, 255};
+    size_t p = qoi_header_size, chunks_end = payload.size() - sizeof(qoi_padding);
+    uint32_t run = 0;
+
+    for(size_t i = 0; i < num_pixels; ++i)
+    {
+        if(run) { --run; }
+        else if(p < chunks_end)
+        {
+            uint8_t b1 = in[p++];
+
+            if(b1 == QOI_OP_RGB)
+            {
+                px.r = in[p++];
+                px.g = in[p++];
+                px.b = in[p++];
+            }
+            else if(b1 == QOI_OP_RGBA)
+            {
+                px.r = in[p++];
+                px.g = in[p++];
+                px.b = in[p++];
+                px.a = in[p++];
+            }
+            else if((b1 & QOI_MASK_2) == QOI_OP_INDEX) { px = index[b1]; }
+            else if((b1 & QOI_MASK_2) == QOI_OP_DIFF)
+            {
+                px.r += ((b1 >> 4) & 0x03) - 2;
+                px.g += ((b1 >> 2) & 0x03) - 2;
+                px.b += (b1 & 0x03) - 2;
+            }
+            else if((b1 & QOI_MASK_2) == QOI_OP_LUMA)
+            {
+                uint8_t b2 = in[p++];
+                int vg = (b1 & 0x3f) - 32;
+                px.r += vg - 8 + ((b2 >> 4) & 0x0f);
+                px.g += vg;
+                px.b += vg - 8 + (b2 & 0x0f);
+            }
+            else if((b1 & QOI_MASK_2) == QOI_OP_RUN) { run = (b1 & 0x3f); }
+            index[qoi_hash(px)] = px;
+        }
+        else { throw std::runtime_error("decode_qoi: truncated"); }
+
+        uint8_t *dst = pixels.data() + i * channels;
+        dst[0] = px.r;
+        dst[1] = px.g;
+        dst[2] = px.b;
+        if(channels == 4) { dst[3] = px.a; }
+    }
+    return std::move(*crocore::Image_<uint8_t>::create(pixels.data(), width, height, channels));
+}
+
+static std::vector<uint8_t> encode_raw_zstd(const uint8_t *pixels, uint32_t width, uint32_t height,
+                                            uint32_t channels)
+{
+    size_t num_bytes = size_t(width) * height * channels;
+    std::vector<uint8_t> ret(raw_zstd_header_size + ZSTD_compressBound(num_bytes));
+    std::memcpy(ret.data(), raw_zstd_magic, sizeof(raw_zstd_magic));
+    put_u32_le(ret.data() + 4, width);
+    put_u32_le(ret.data() + 8, height);
+    put_u32_le(ret.data() + 12, channels);
+
+    auto num_compressed = ZSTD_compress(ret.data() + raw_zstd_header_size, ret.size() - raw_zstd_header_size, pixels,
+                                        num_bytes, raw_zstd_level);
+    if(ZSTD_isError(num_compressed))
+    {
+        throw std::runtime_error(std::string("encode_raw_zstd: ") + ZSTD_getErrorName(num_compressed));
+    }
+    ret.resize(raw_zstd_header_size + num_compressed);
+    return ret;
+}
+
+static crocore::Image_<uint8_t> decode_raw_zstd(const std::vector<uint8_t> &payload)
+{
+    if(payload.size() < raw_zstd_header_size) { throw std::runtime_error("decode_raw_zstd: truncated"); }
+    uint32_t width = get_u32_le(payload.data() + 4), height = get_u32_le(payload.data() + 8),
+             channels = get_u32_le(payload.data() + 12);
+    if(!width || !height || !channels || channels > 4) { throw std::runtime_error("decode_raw_zstd: invalid header"); }
+
+    std::vector<uint8_t> pixels(size_t(width) * height * channels);
+    auto num_bytes = ZSTD_decompress(pixels.data(), pixels.size(), payload.data() + raw_zstd_header_size,
+                                     payload.size() - raw_zstd_header_size);
+    if(ZSTD_isError(num_bytes) || num_bytes != pixels.size())
+    {
+        throw std::runtime_error("decode_raw_zstd: corrupt image-data");
+    }
+    return std::move(*crocore::Image_<uint8_t>::create(pixels.data(), width, height, channels));
+}
+
+std::vector<uint8_t> encode_texture(const crocore::Image_<uint8_t> &img, texture_codec_t codec)
+{
+    auto *pixels = static_cast<const uint8_t *>(img.data());
+    uint32_t channels = img.num_components();
+
+    switch(codec)
+    {
+        case texture_codec_t::Png: return crocore::encode_png(img);
+
+        case texture_codec_t::Qoi:
+            if(channels == 3 || channels == 4) { return encode_qoi(pixels, img.width(), img.height(), channels); }
+            return encode_raw_zstd(pixels, img.width(), img.height(), channels);
+
+        case texture_codec_t::RawZstd: return encode_raw_zstd(pixels, img.width(), img.height(), channels);
+    }
+    throw std::runtime_error("encode_texture: unknown codec");
+}
+
+crocore::Image_<uint8_t> decode_texture(const std::vector<uint8_t> &payload)
+{
+    auto codec = detect_texture_codec(payload);
+    if(codec == texture_codec_t::Qoi) { return decode_qoi(payload); }
+    if(codec == texture_codec_t::RawZstd) { return decode_raw_zstd(payload); }
+
+    // PNG and other formats supported by crocore
+    auto img = std::dynamic_pointer_cast<crocore::Image_<uint8_t>>(crocore::create_image_from_data(payload));
+    if(!img) { throw std::runtime_error("decode_texture: could not decode image-data"); }
+    return std::move(*img);
+}
+
+std::optional<texture_codec_t> detect_texture_codec(const std::vector<uint8_t> &payload)
+{
+    if(has_prefix(payload, png_signature)) { return texture_codec_t::Png; }
+    if(has_prefix(payload, qoi_magic)) { return texture_codec_t::Qoi; }
+    if(has_prefix(payload, raw_zstd_magic)) { return texture_codec_t::RawZstd; }
+    return {};
+}
+
+texture_codec_scope_t::texture_codec_scope_t(texture_codec_t codec, const texture_payload_map_t *payloads)
+    : m_codec(codec), m_payloads(payloads), m_previous(g_current_scope)
+{
+    g_current_scope = this;
+}
+
+texture_codec_scope_t::~texture_codec_scope_t() { g_current_scope = m_previous; }
+
+const texture_codec_scope_t *texture_codec_scope_t::current() { return g_current_scope; }
+
+const std::vector<uint8_t> *texture_codec_scope_t::payload(const crocore::Image *img) const
+{
+    if(!m_payloads) { return nullptr; }
+    auto it = m_payloads->find(img);
+    return it != m_payloads->end() ? &it->second : nullptr;
+}
+
+}// namespace vierkant_cereal
@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <vierkant_cereal/bundle_container.hpp>
+#include <vierkant_cereal/texture_store.hpp>
+#include <vierkant_cereal/xxhash64.hpp>
+
+namespace vierkant_cereal
+{
+
+constexpr bundle_section_mask_t texture_sections =
+        bundle_section_bit(bundle_section_t::Textures) | bundle_section_bit(bundle_section_t::TextureLevels);
+
+//! elements of id-keyed maps and plain sequences alike
+template<typename T>
+static auto &element_value(T &element)
+{
+    if constexpr(requires { element.second; }) { return element.second; }
+    else { return element; }
+}
+
+texture_store::texture_store(std::filesystem::path directory, texture_codec_t texture_codec)
+    : m_directory(std::move(directory)), m_texture_codec(texture_codec)
+{}
+
+std::filesystem::path texture_store::default_directory(const std::filesystem::path &bundle_directory)
+{
+    auto directory = std::filesystem::absolute(bundle_directory).lexically_normal();
+
+    // trailing separator: empty filename
+    if(!directory.has_filename()) { directory = directory.parent_path(); }
+    return directory.parent_path() / default_directory_name;
+}
+
+texture_store::texture_id_t texture_store::content_id(const crocore::Image_<uint8_t> &img, bool compress)
+{
+    uint32_t header[4] = {static_cast<uint32_t>(img.width()), static_cast<uint32_t>(img.height()),
+                          static_cast<uint32_t>(img.num_components()), compress ? 1U : 0U};
+    size_t num_bytes = static_cast<size_t>(img.width()) * img.height() * img.num_components();
+    auto hash = xxh64(static_cast<const uint8_t *>(img.data()), num_bytes, xxh64(header, sizeof(header)));
+    return texture_id_t::from_name(std::format("texture_{:016x}", hash));
+}
+
+std::filesystem::path texture_store::file_path(const texture_id_t &id) const
+{
+    return m_directory / std::format("{}.{}", id.str(), file_suffix);
+}
+
+bool texture_store::contains(const texture_id_t &id) const
+{
+    std::error_code ec;
+    return std::filesystem::exists(file_path(id), ec);
+}
+
+bool texture_store::store(const texture_id_t &id, const texture_t &texture) const
+{
+    if(contains(id)) { return true; }
+
+    vierkant::model::model_assets_t assets;
+    assets.textures[id] = texture;
+    save_bundle_file(assets, file_path(id), {}, m_texture_codec);
+    return contains(id);
+}
+
+std::optional<texture_store::texture_t> texture_store::load(const texture_id_t &id, crocore::ThreadPoolClassic *pool,
+                                                            uint32_t max_texture_extent) const
+{
+    auto assets = load_model_bundle_file(file_path(id), {}, texture_sections, pool, max_texture_extent);
+    if(!assets) { return {}; }
+
+    auto it = assets->textures.find(id);
+    if(it == assets->textures.end()) { return {}; }
+    return std::move(it->second);
+}
+
+size_t texture_store::merge(const std::filesystem::path &directory) const
+{
+    if(!std::filesystem::is_directory(directory)) { throw std::runtime_error("not a directory: " + directory.string()); }
+    std::filesystem::create_directories(m_directory);
+
+    const std::string suffix = std::string(".") + file_suffix;
+    size_t ret = 0;
+    std::error_code ec;
+    for(const auto &entry: std::filesystem::directory_iterator(directory))
+    {
+        if(!entry.is_regular_file(ec) || entry.path().extension() != suffix) { continue; }
+        auto path = m_directory / entry.path().filename();
+        if(std::filesystem::exists(path, ec)) { continue; }
+
+        // published atomically, like stored textures
+        auto tmp_path = temp_file_path(path);
+        try
+        {
+            std::filesystem::copy_file(entry.path(), tmp_path);
+            std::filesystem::rename(tmp_path, path);
+        } catch(...)
+        {
+            std::filesystem::remove(tmp_path, ec);
+            throw;
+        }
+        ret++;
+    }
+    return ret;
+}
+
+size_t texture_store::strip(texture_map_t &textures) const
+{
+    return std::erase_if(textures, [this](const auto &item) { return contains(item.first); });
+}
+
+std::vector<texture_store::texture_id_t>
+texture_store::referenced_ids(const vierkant::model::model_assets_t &assets)
+{
+    std::vector<texture_id_t> ret;
+    for(const auto &material: assets.materials)
+    {
+        for(const auto &[type, texture_data]: element_value(material).texture_data)
+        {
+            if(std::ranges::find(ret, texture_data.texture_id) == ret.end()) { ret.push_back(texture_data.texture_id); }
+        }
+    }
+    return ret;
+}
+
+bool texture_store::resolve(vierkant::model::model_assets_t &assets, crocore::ThreadPoolClassic *pool,
+                            uint32_t max_texture_extent, std::span<const texture_id_t> skip_ids) const
+{
+    std::vector<texture_id_t> missing;
+    for(const auto &id: referenced_ids(assets))
+    {
+        if(!assets.textures.contains(id) && std::ranges::find(skip_ids, id) == skip_ids.end())
+        {
+            missing.push_back(id);
+        }
+    }
+
+    std::vector<std::optional<texture_t>> loaded(missing.size());
+    parallel_for(missing.size(), [&](size_t i) { loaded[i] = load(missing[i], pool, max_texture_extent); }, pool);
+
+    bool ret = true;
+    for(size_t i = 0; i < missing.size(); ++i)
+    {
+        if(loaded[i]) { assets.textures[missing[i]] = std::move(*loaded[i]); }
+        else
+        {
+            spdlog::warn("texture-store '{}': missing texture '{}'", m_directory.string(), missing[i].str());
+            ret = false;
+        }
+    }
+    return ret;
+}
+
+std::vector<texture_store::texture_id_t> texture_store::assign_content_ids(vierkant::model::model_assets_t &assets,
+                                                                          bool compress,
+                                                                          crocore::ThreadPoolClassic *pool)
+{
+    std::vector<std::pair<texture_id_t, const crocore::Image_<uint8_t> *>> images;
+    for(const auto &[id, texture]: assets.textures)
+    {
+        if(const auto *img_ptr = std::get_if<crocore::ImagePtr>(&texture))
+        {
+            if(const auto *img = dynamic_cast<const crocore::Image_<uint8_t> *>(img_ptr->get()))
+            {
+                images.emplace_back(id, img);
+            }
+        }
+    }
+
+    std::vector<texture_id_t> content_ids(images.size());
+    parallel_for(images.size(), [&](size_t i) { content_ids[i] = content_id(*images[i].second, compress); }, pool);
+
+    std::unordered_map<texture_id_t, texture_id_t> remap;
+    for(size_t i = 0; i < images.size(); ++i) { remap[images[i].first] = content_ids[i]; }
+    auto remap_id = [&remap](texture_id_t &id) {
+        if(auto it = remap.find(id); it != remap.end()) { id = it->second; }
+    };
+
+    // equal textures collapse into a single entry
+    texture_map_t textures;
+    for(auto &[id, texture]: assets.textures)
+    {
+        auto new_id = id;
+        remap_id(new_id);
+        textures[new_id] = std::move(texture);
+    }
+    assets.textures = std::move(textures);
+
+    for(auto &material: assets.materials)
+    {
+        for(auto &[type, texture_data]: element_value(material).texture_data) { remap_id(texture_data.texture_id); }
+    }
+    for(auto &omm_data: assets.omm_data) { remap_id(element_value(omm_data).color_texture_id); }
+
+    std::unordered_set<texture_id_t> distinct_ids(content_ids.begin(), content_ids.end());
+    return {distinct_ids.begin(), distinct_ids.end()};
+}
+
+}// namespace vierkant_cereal
@@ -1,6 +1,11 @@
+#include <algorithm>
+#include <atomic>
 #include <format>
 #include <fstream>
+#include <numeric>
+#include <random>
 #include <shared_mutex>
+#include <unordered_set>
 
 #include <crocore/filesystem.hpp>
 #include <spdlog/spdlog.h>
@@ -8,53 +13,63 @@
 
 #include <vierkant/hash.hpp>
 
+#include <vierkant_cereal/bundle_container.hpp>
+#include <vierkant_cereal/bundle_dedup.hpp>
+#include <vierkant_cereal/geometry_codec.hpp>
+#include <vierkant_cereal/mapped_file.hpp>
 #include <vierkant_cereal/scene_cereal.hpp>
 #include <vierkant_cereal/serialization.hpp>
+#include <vierkant_cereal/texture_codec.hpp>
+#include <vierkant_cereal/texture_store.hpp>
 #include <vierkant_cereal/vierkant_cereal.hpp>
+#include <vierkant_cereal/xxhash64.hpp>
 #include <vierkant_cereal/ziparchive.h>
+#include <vierkant_cereal/ziparchive_pool.h>
 
 namespace vierkant_cereal
 {
 
-//! guards concurrent access to the shared zip-archive(s) used for bundle storage.
-static std::shared_mutex g_bundle_rw_mutex;
-
-//! archive-relative entry-name for a bundle-path, keeping machine-local absolute paths out of archives.
-static std::filesystem::path zip_entry_path(const std::filesystem::path &path,
-                                            const std::filesystem::path &zip_archive)
-{
-    auto rel = path.lexically_relative(zip_archive.parent_path());
-    if(rel.empty() || *rel.begin() == "..") { return path.generic_string(); }
-    return rel.generic_string();
-}
-
 template<typename T, typename Reader>
 static std::optional<T> load_from_stream(const std::filesystem::path &path,
                                          const std::optional<std::filesystem::path> &zip_archive, Reader &&reader)
 {
+    // plain files are memory-mapped and deserialized straight from the page-cache
+    if(auto mapped = mapped_file::open(path))
+    {
+        try
+        {
+            spdlog::debug("loading bundle '{}' (memory-mapped)", path.string());
+            mapped_istream is(std::move(mapped));
+            return reader(is);
+        } catch(std::exception &e) { spdlog::error(e.what()); }
+    }
+    else
     {
-        std::ifstream f(path);
+        std::ifstream f(path, std::ios_base::in | std::ios_base::binary);
         if(f.is_open())
         {
             try
             {
                 spdlog::debug("loading bundle '{}'", path.string());
-                std::shared_lock lock(g_bundle_rw_mutex);
                 return reader(f);
             } catch(std::exception &e) { spdlog::error(e.what()); }
         }
     }
     if(zip_archive)
     {
-        vierkant::ziparchive zip(*zip_archive);
-        auto entry_path = zip_entry_path(path, *zip_archive);
-        if(zip.has_file(entry_path))
+        // pooled handles + shared central-directory, instead of re-opening the archive per bundle
+        auto &zip_pool = vierkant::ziparchive_pool::global();
+        auto entry_path = bundle_entry_path(path, *zip_archive);
+        if(zip_pool.has_file(*zip_archive, entry_path))
         {
             try
             {
                 spdlog::debug("loading bundle '{}' from archive '{}'", entry_path.string(), zip_archive->string());
-                std::shared_lock lock(g_bundle_rw_mutex);
-                auto zipstream = zip.open_file(entry_path);
+
+                // readers keep the archive-generation they opened, no need to wait for in-flight writers
+                std::shared_lock commit_lock(zip_pool.locks(*zip_archive).commit_mutex, std::defer_lock);
+                if(!vierkant::ziparchive_pool::snapshot_reads) { commit_lock.lock(); }
+                auto zipstream = zip_pool.open_file(*zip_archive, entry_path);
                 return reader(zipstream);
             } catch(std::exception &e) { spdlog::error(e.what()); }
         }
@@ -62,84 +77,596 @@ static std::optional<T> load_from_stream(const std::filesystem::path &path,
     return {};
 }
 
+std::filesystem::path temp_file_path(const std::filesystem::path &path)
+{
+    // random per process, keeps concurrent processes apart. the counter keeps concurrent writers apart.
+    static const uint64_t process_token = [] {
+        std::random_device rd;
+        return (uint64_t(rd()) << 32) | rd();
+    }();
+    static std::atomic<uint64_t> counter = 0;
+    return std::format("{}.{:x}.{:x}.tmp", path.string(), process_token, counter++);
+}
+
 template<typename Writer>
 static void save_to_stream(const std::filesystem::path &path, const std::optional<std::filesystem::path> &zip_archive,
-                           Writer &&writer)
+                           std::optional<int> zip_level, Writer &&writer)
 {
+    if(zip_archive)
+    {
+        // serialized output is compressed straight into the archive-entry, no intermediate file
+        try
+        {
+            spdlog::stopwatch sw;
+            spdlog::debug("serializing bundle into compressed archive: {} -> {}", path.string(),
+                          zip_archive->string());
+            vierkant::ziparchive_pool::global().modify(*zip_archive, [&](vierkant::ziparchive &archive) {
+                archive.add_stream([&writer](std::ostream &os) { writer(os); }, bundle_entry_path(path, *zip_archive),
+                                   zip_level);
+            });
+            spdlog::debug("done serializing bundle: {} -> {} ({})", path.string(), zip_archive->string(), sw.elapsed());
+        } catch(std::exception &e) { spdlog::error(e.what()); }
+        return;
+    }
+
+    // written to a temporary first, concurrent readers never observe partially written bundles
+    auto tmp_path = temp_file_path(path);
+
     try
     {
         {
             spdlog::stopwatch sw;
             if(auto dir = crocore::filesystem::get_directory_part(path); !dir.empty())
                 std::filesystem::create_directories(dir);
-            std::ofstream ofs(path.string(), std::ios_base::out | std::ios_base::binary);
+            std::ofstream ofs(tmp_path.string(), std::ios_base::out | std::ios_base::binary);
             spdlog::debug("serializing/writing bundle: {}", path.string());
             writer(ofs);
             spdlog::debug("done serializing/writing bundle: {} ({})", path.string(), sw.elapsed());
         }
-        if(zip_archive)
+        std::filesystem::rename(tmp_path, path);
+    } catch(std::exception &e)
+    {
+        spdlog::error(e.what());
+        std::error_code ec;
+        std::filesystem::remove(tmp_path, ec);
+    }
+}
+
+constexpr bundle_section_t model_bundle_sections[] = {
+        bundle_section_t::Geometry, bundle_section_t::Materials, bundle_section_t::Textures,
+        bundle_section_t::TextureSamplers, bundle_section_t::Nodes, bundle_section_t::OmmData,
+        bundle_section_t::Lights};
+
+//! (de)serialize the fields of model-assets belonging to a section
+template<typename Archive, typename Assets>
+static void serialize_section(Archive &archive, Assets &assets, bundle_section_t section)
+{
+    switch(section)
+    {
+        case bundle_section_t::Geometry: archive(assets.geometry_data); break;
+        case bundle_section_t::Materials: archive(assets.materials); break;
+        case bundle_section_t::Textures: archive(assets.textures); break;
+        case bundle_section_t::TextureSamplers: archive(assets.texture_samplers); break;
+        case bundle_section_t::Nodes: archive(assets.root_node, assets.root_bone, assets.node_animations); break;
+        case bundle_section_t::OmmData: archive(assets.omm_data); break;
+        case bundle_section_t::Lights: archive(assets.lights, assets.light_instances); break;
+        default: break;
+    }
+}
+
+//! schema-version of a container, verified to be supported. containers without one were written before versioning.
+static uint32_t container_schema_version(uint16_t schema_version)
+{
+    uint32_t ret = schema_version ? schema_version : unversioned_bundle_schema_version;
+    if(!bundle_schema_supported(ret))
+    {
+        throw std::runtime_error(std::format("unsupported bundle schema-version {} (supported: {} - {})", ret,
+                                             min_bundle_schema_version, bundle_schema_version));
+    }
+    return ret;
+}
+
+//! texture-levels ---------------------------------------------------------------------------------
+
+//! toc-key of a texture-level section: texture-hash (40 bits) | level (8 bits) | level-extent (16 bits).
+//! levels are selected from the toc alone, without reading any section.
+struct texture_level_key_t
+{
+    uint64_t texture_hash = 0;
+    uint32_t level = 0;
+    uint32_t extent = 0;
+
+    static texture_level_key_t from_key(uint64_t key)
+    {
+        return {key >> 24, static_cast<uint32_t>((key >> 16) & 0xFF), static_cast<uint32_t>(key & 0xFFFF)};
+    }
+
+    [[nodiscard]] uint64_t key() const
+    {
+        return (texture_hash << 24) | (static_cast<uint64_t>(level & 0xFF) << 16) | std::min<uint32_t>(extent, 0xFFFF);
+    }
+};
+
+using texture_level_blocks_t = decltype(vierkant::bcn::compress_result_t::levels)::value_type;
+
+//! a decoded texture-level
+struct texture_level_t
+{
+    texture_level_key_t key;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    texture_level_blocks_t blocks;
+};
+
+static uint64_t texture_hash(const texture_map_t::key_type &id) { return xxh64(id.str()) >> 24; }
+
+/**
+ * @brief   'select_texture_levels' selects level-sections to load. levels exceeding 'max_extent' (0: unlimited) are
+ *          skipped, except the smallest level of each texture.
+ *
+ * @param   toc             table of contents of a model-bundle
+ * @param   max_extent      maximum level-extent
+ * @param   num_resident    optional number of resident (coarsest) levels by texture-hash. if provided,
+ *                          other textures are skipped.
+ * @return  the selected entries, in stored order (smallest first).
+ */
+static std::vector<section_entry_t>
+select_texture_levels(const std::vector<section_entry_t> &toc, uint32_t max_extent,
+                      const std::unordered_map<uint64_t, size_t> *num_resident = nullptr)
+{
+    std::unordered_map<uint64_t, std::vector<const section_entry_t *>> levels_by_texture;
+    for(const auto &entry: toc)
+    {
+        if(entry.type == static_cast<uint32_t>(bundle_section_t::TextureLevels))
+        {
+            levels_by_texture[texture_level_key_t::from_key(entry.key).texture_hash].push_back(&entry);
+        }
+    }
+
+    std::vector<section_entry_t> ret;
+    for(auto &[hash, levels]: levels_by_texture)
+    {
+        size_t num_levels = levels.size();
+        if(num_resident)
         {
-            spdlog::stopwatch sw;
+            auto it = num_resident->find(hash);
+            if(it == num_resident->end()) { continue; }
+            num_levels -= std::min(num_levels, it->second);
+        }
+
+        // finest level first
+        std::ranges::sort(levels, {}, [](const auto *entry) { return texture_level_key_t::from_key(entry->key).level; });
+
+        for(size_t i = 0; i < num_levels; ++i)
+        {
+            auto extent = texture_level_key_t::from_key(levels[i]->key).extent;
+            if(!max_extent || extent <= max_extent || i + 1 == levels.size()) { ret.push_back(*levels[i]); }
+        }
+    }
+    std::ranges::sort(ret, {}, &section_entry_t::offset);
+    return ret;
+}
+
+static texture_level_t decode_texture_level(const section_entry_t &entry, std::vector<uint8_t> stored)
+{
+    auto data = decode_section(entry, std::move(stored));
+    memory_streambuf streambuf(data.data(), data.size());
+    std::istream is(&streambuf);
+    cereal::BinaryInputArchive archive(is);
+
+    texture_level_t ret;
+    ret.key = texture_level_key_t::from_key(entry.key);
+    archive(ret.width, ret.height, ret.blocks);
+    return ret;
+}
+
+//! prepend loaded levels to the resident levels of block-compressed textures, returns the number of applied levels
+static size_t apply_texture_levels(texture_map_t &textures, std::vector<texture_level_t> &levels)
+{
+    std::unordered_map<uint64_t, std::vector<texture_level_t *>> levels_by_texture;
+    for(auto &level: levels) { levels_by_texture[level.key.texture_hash].push_back(&level); }
+
+    size_t ret = 0;
+    for(auto &[id, texture]: textures)
+    {
+        auto *compressed = std::get_if<vierkant::bcn::compress_result_t>(&texture);
+        if(!compressed) { continue; }
+
+        // separately stored levels are empty placeholders in the textures-section
+        std::erase_if(compressed->levels, [](const auto &level) { return level.empty(); });
+
+        auto it = levels_by_texture.find(texture_hash(id));
+        if(it == levels_by_texture.end()) { continue; }
+
+        auto &new_levels = it->second;
+        std::ranges::sort(new_levels, {}, [](const auto *level) { return level->key.level; });
+
+        decltype(compressed->levels) merged;
+        merged.reserve(new_levels.size() + compressed->levels.size());
+        for(auto *level: new_levels) { merged.push_back(std::move(level->blocks)); }
+        std::ranges::move(compressed->levels, std::back_inserter(merged));
+
+        compressed->levels = std::move(merged);
+        compressed->base_width = new_levels.front()->width;
+        compressed->base_height = new_levels.front()->height;
+        ret += new_levels.size();
+    }
+    return ret;
+}
+
+//! encode all uncompressed textures concurrently, ahead of serialization. optionally sums up the encoding-times.
+template<typename TextureMap>
+static texture_payload_map_t encode_textures(const TextureMap &textures, texture_codec_t codec,
+                                             crocore::ThreadPoolClassic *pool, double *seconds = nullptr)
+{
+    std::vector<const crocore::Image_<uint8_t> *> images;
+    for(const auto &[id, texture]: textures)
+    {
+        if(const auto *img_ptr = std::get_if<crocore::ImagePtr>(&texture))
+        {
+            if(const auto *img = dynamic_cast<const crocore::Image_<uint8_t> *>(img_ptr->get()))
             {
-                std::unique_lock lock(g_bundle_rw_mutex);
-                spdlog::debug("adding bundle to compressed archive: {} -> {}", path.string(), zip_archive->string());
-                vierkant::ziparchive zipstream(*zip_archive);
-                zipstream.add_file(path, zip_entry_path(path, *zip_archive));
+                images.push_back(img);
             }
-            spdlog::debug("done compressing bundle: {} -> {} ({})", path.string(), zip_archive->string(), sw.elapsed());
-            std::filesystem::remove(path);
         }
-    } catch(std::exception &e) { spdlog::error(e.what()); }
-}
+    }
+    std::vector<std::vector<uint8_t>> payloads(images.size());
+    std::vector<double> durations(images.size());
+    parallel_for(
+            images.size(),
+            [&](size_t i) {
+                spdlog::stopwatch sw;
+                payloads[i] = encode_texture(*images[i], codec);
+                durations[i] = sw.elapsed().count();
+            },
+            pool);
 
+    texture_payload_map_t ret;
+    for(size_t i = 0; i < images.size(); ++i) { ret[images[i]] = std::move(payloads[i]); }
+    if(seconds) { *seconds += std::accumulate(durations.begin(), durations.end(), 0.0); }
+    return ret;
+}
 
-void save(std::ostream &os, const vierkant::model::model_assets_t &assets)
+void save(std::ostream &os, const vierkant::model::model_assets_t &assets, crocore::ThreadPoolClassic *pool,
+          texture_codec_t texture_codec, geometry_codec_t geometry_codec, save_stats_t *stats)
 {
-    cereal::BinaryOutputArchive archive(os);
-    archive(assets);
+    constexpr size_t num_sections = std::size(model_bundle_sections);
+
+    struct level_ref_t
+    {
+        texture_level_key_t key;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        const texture_level_blocks_t *blocks = nullptr;
+    };
+
+    // levels of block-compressed textures go into separate sections, the textures-section keeps placeholders
+    texture_map_t textures;
+    std::vector<level_ref_t> texture_levels;
+
+    for(const auto &[id, texture]: assets.textures)
+    {
+        const auto *compressed = std::get_if<vierkant::bcn::compress_result_t>(&texture);
+        if(!compressed)
+        {
+            textures[id] = texture;
+            continue;
+        }
+        vierkant::bcn::compress_result_t placeholder;
+        placeholder.mode = compressed->mode;
+        placeholder.base_width = compressed->base_width;
+        placeholder.base_height = compressed->base_height;
+        placeholder.levels.resize(compressed->levels.size());
+        textures[id] = std::move(placeholder);
+
+        for(uint32_t lvl = 0; lvl < compressed->levels.size(); ++lvl)
+        {
+            uint32_t width = std::max<uint32_t>(compressed->base_width >> lvl, 1);
+            uint32_t height = std::max<uint32_t>(compressed->base_height >> lvl, 1);
+            texture_levels.push_back(
+                    {{texture_hash(id), lvl, std::max(width, height)}, width, height, &compressed->levels[lvl]});
+        }
+    }
+
+    // smallest first, coarse levels are available after reading a short prefix
+    std::ranges::stable_sort(texture_levels, {}, [](const auto &level) { return level.key.extent; });
+
+    // without a pool, textures are encoded while serializing. with stats they are encoded ahead
+    // (on the calling thread), so encoding isn't accounted as serialization.
+    texture_payload_map_t texture_payloads;
+    if(pool || stats)
+    {
+        texture_payloads = encode_textures(assets.textures, texture_codec, pool,
+                                           stats ? &stats->compress_seconds : nullptr);
+    }
+
+    // a schema-scope bound by the caller selects the written layout, also on worker-threads
+    const uint32_t schema_version = bundle_schema_scope_t::version();
+    std::vector<encoded_section_t> sections(num_sections + texture_levels.size());
+
+    parallel_for(
+            sections.size(),
+            [&](size_t i) {
+                bundle_schema_scope_t schema_scope(schema_version);
+                if(i >= num_sections)
+                {
+                    const auto &level = texture_levels[i - num_sections];
+                    sections[i] = encode_section(static_cast<uint32_t>(bundle_section_t::TextureLevels),
+                                                 level.key.key(), [&level](std::ostream &section_os) {
+                                                     cereal::BinaryOutputArchive archive(section_os);
+                                                     archive(level.width, level.height, *level.blocks);
+                                                 });
+                    return;
+                }
+                auto section = model_bundle_sections[i];
+
+                // geometry-sections are keyed by their geometry-codec
+                const auto *mesh_bundle = std::get_if<vierkant::mesh_buffer_bundle_t>(&assets.geometry_data);
+                if(section == bundle_section_t::Geometry && mesh_bundle &&
+                   geometry_codec == geometry_codec_t::Meshopt && geometry_codec_supported(geometry_codec))
+                {
+                    sections[i] = encode_section(static_cast<uint32_t>(section), static_cast<uint64_t>(geometry_codec),
+                                                 [&](std::ostream &section_os) {
+                                                     cereal::BinaryOutputArchive archive(section_os);
+                                                     encode_geometry(archive, *mesh_bundle, !assets.omm_data.empty());
+                                                 });
+                    return;
+                }
+                texture_codec_scope_t codec_scope(texture_codec, &texture_payloads);
+                sections[i] = encode_section(static_cast<uint32_t>(section), 0, [&](std::ostream &section_os) {
+                    cereal::BinaryOutputArchive archive(section_os);
+                    if(section == bundle_section_t::Textures) { archive(textures); }
+                    else { serialize_section(archive, assets, section); }
+                });
+            },
+            pool);
+
+    if(stats)
+    {
+        for(const auto &section: sections)
+        {
+            stats->serialize_seconds += section.serialize_seconds;
+            stats->compress_seconds += section.compress_seconds;
+        }
+    }
+    write_bundle_container(os, sections, schema_version);
 }
 
-std::optional<vierkant::model::model_assets_t> load_model_assets(std::istream &is)
+std::optional<vierkant::model::model_assets_t> load_model_assets(std::istream &is, bundle_section_mask_t sections,
+                                                                 crocore::ThreadPoolClassic *pool,
+                                                                 uint32_t max_texture_extent)
 {
     try
     {
         vierkant::model::model_assets_t ret;
-        cereal::BinaryInputArchive archive(is);
-        archive(ret);
+        auto base = is.tellg();
+        uint16_t schema_version = 0;
+        auto toc = read_bundle_toc(is, &schema_version);
+
+        // with a pool, images are decoded concurrently after deserialization
+        deferred_image_decoder image_decoder;
+
+        // legacy bundles: one positional blob
+        if(!toc)
+        {
+            {
+                std::optional<deferred_image_decoder::scope_t> decode_scope;
+                if(pool) { decode_scope.emplace(image_decoder); }
+                bundle_schema_scope_t schema_scope(unversioned_bundle_schema_version);
+                cereal::BinaryInputArchive archive(is);
+                archive(ret);
+            }
+            image_decoder.run(pool);
+            migrate_model_assets(ret, unversioned_bundle_schema_version);
+            return ret;
+        }
+
+        // older schema-versions are read through compatibility-paths and migrated afterwards
+        const uint32_t bundle_version = container_schema_version(schema_version);
+
+        // stored bytes are read sequentially, decoding runs concurrently. unknown section-types are skipped.
+        std::vector<section_entry_t> entries;
+        std::vector<std::vector<uint8_t>> stored;
+
+        for(const auto &entry: *toc)
+        {
+            if(entry.type < std::size(model_bundle_sections) &&
+               (sections & bundle_section_bit(static_cast<bundle_section_t>(entry.type))))
+            {
+                stored.push_back(read_section(is, base, entry));
+                entries.push_back(entry);
+            }
+        }
+        const size_t num_sections = entries.size();
+
+        constexpr auto texture_sections =
+                bundle_section_bit(bundle_section_t::Textures) | bundle_section_bit(bundle_section_t::TextureLevels);
+        if((sections & texture_sections) == texture_sections)
+        {
+            for(const auto &entry: select_texture_levels(*toc, max_texture_extent))
+            {
+                stored.push_back(read_section(is, base, entry));
+                entries.push_back(entry);
+            }
+        }
+        std::vector<texture_level_t> texture_levels(entries.size() - num_sections);
+
+        // sections deserialize into disjoint fields
+        parallel_for(
+                entries.size(),
+                [&](size_t i) {
+                    bundle_schema_scope_t schema_scope(bundle_version);
+                    if(i >= num_sections)
+                    {
+                        texture_levels[i - num_sections] = decode_texture_level(entries[i], std::move(stored[i]));
+                        return;
+                    }
+                    std::optional<deferred_image_decoder::scope_t> decode_scope;
+                    if(pool) { decode_scope.emplace(image_decoder); }
+                    auto data = decode_section(entries[i], std::move(stored[i]));
+                    memory_streambuf streambuf(data.data(), data.size());
+                    std::istream section_is(&streambuf);
+                    cereal::BinaryInputArchive archive(section_is);
+
+                    auto section = static_cast<bundle_section_t>(entries[i].type);
+                    if(section == bundle_section_t::Geometry &&
+                       entries[i].key == static_cast<uint64_t>(geometry_codec_t::Meshopt))
+                    {
+                        vierkant::mesh_buffer_bundle_t mesh_bundle;
+                        decode_geometry(archive, mesh_bundle);
+                        ret.geometry_data = std::move(mesh_bundle);
+                    }
+                    else { serialize_section(archive, ret, section); }
+                },
+                pool);
+        image_decoder.run(pool);
+        apply_texture_levels(ret.textures, texture_levels);
+        migrate_model_assets(ret, bundle_version);
         return ret;
-    } catch(const std::exception &) { return {}; }
+    } catch(const std::exception &e)
+    {
+        spdlog::error("could not load model-assets: {}", e.what());
+        return {};
+    }
 }
 
-void save(std::ostream &os, const vierkant::material_data_t &data)
+size_t load_texture_levels(std::istream &is, texture_map_t &textures, uint32_t max_texture_extent,
+                           crocore::ThreadPoolClassic *pool)
 {
-    cereal::BinaryOutputArchive archive(os);
-    archive(data);
+    auto base = is.tellg();
+    uint16_t schema_version = 0;
+    auto toc = read_bundle_toc(is, &schema_version);
+
+    // legacy bundles store all levels inline
+    if(!toc) { return 0; }
+    const uint32_t bundle_version = container_schema_version(schema_version);
+
+    std::unordered_map<uint64_t, size_t> num_resident;
+    for(const auto &[id, texture]: textures)
+    {
+        if(const auto *compressed = std::get_if<vierkant::bcn::compress_result_t>(&texture))
+        {
+            num_resident[texture_hash(id)] =
+                    std::ranges::count_if(compressed->levels, [](const auto &level) { return !level.empty(); });
+        }
+    }
+
+    auto entries = select_texture_levels(*toc, max_texture_extent, &num_resident);
+    std::vector<std::vector<uint8_t>> stored;
+    for(const auto &entry: entries) { stored.push_back(read_section(is, base, entry)); }
+
+    std::vector<texture_level_t> levels(entries.size());
+    parallel_for(
+            entries.size(),
+            [&](size_t i) {
+                bundle_schema_scope_t schema_scope(bundle_version);
+                levels[i] = decode_texture_level(entries[i], std::move(stored[i]));
+            },
+            pool);
+    return apply_texture_levels(textures, levels);
+}
+
+//! section-type of material-data
+constexpr uint32_t material_data_section = 0;
+
+void save(std::ostream &os, const vierkant::material_data_t &data, texture_codec_t texture_codec)
+{
+    // uncompressed, material-bundles are compressed by archives
+    std::vector<encoded_section_t> sections;
+    sections.push_back(encode_section(
+            material_data_section, 0,
+            [&data, texture_codec](std::ostream &section_os) {
+                texture_codec_scope_t codec_scope(texture_codec);
+                cereal::BinaryOutputArchive archive(section_os);
+                archive(data);
+            },
+            section_codec_t::None));
+    write_bundle_container(os, sections, bundle_schema_scope_t::version());
 }
 
-std::optional<vierkant::material_data_t> load_material_data(std::istream &is)
+std::optional<vierkant::material_data_t> load_material_data(std::istream &is, crocore::ThreadPoolClassic *pool)
 {
     try
     {
         vierkant::material_data_t ret;
-        cereal::BinaryInputArchive archive(is);
-        archive(ret);
+        auto base = is.tellg();
+        uint16_t schema_version = 0;
+        auto toc = read_bundle_toc(is, &schema_version);
+        const uint32_t bundle_version = container_schema_version(schema_version);
+
+        deferred_image_decoder image_decoder;
+        auto deserialize = [&](std::istream &data_is) {
+            std::optional<deferred_image_decoder::scope_t> decode_scope;
+            if(pool) { decode_scope.emplace(image_decoder); }
+            bundle_schema_scope_t schema_scope(bundle_version);
+            cereal::BinaryInputArchive archive(data_is);
+            archive(ret);
+        };
+
+        // legacy material-data: one positional blob
+        if(!toc) { deserialize(is); }
+        else
+        {
+            auto it = std::ranges::find(*toc, material_data_section, &section_entry_t::type);
+            if(it == toc->end()) { throw std::runtime_error("load_material_data: missing material-section"); }
+            auto data = decode_section(*it, read_section(is, base, *it));
+            memory_streambuf streambuf(data.data(), data.size());
+            std::istream section_is(&streambuf);
+            deserialize(section_is);
+        }
+        image_decoder.run(pool);
+        migrate_material_data(ret, bundle_version);
         return ret;
-    } catch(const std::exception &) { return {}; }
+    } catch(const std::exception &e)
+    {
+        spdlog::error("could not load material-data: {}", e.what());
+        return {};
+    }
 }
 
-void save_scene_data(std::ostream &os, const scene_data_t &data)
+//! section-type of binary scene-data, keyed by the xxh64 of its source-json
+constexpr uint32_t scene_data_section = 0;
+
+void save_scene_data(std::ostream &os, const scene_data_t &data, scene_format_t format, uint64_t source_hash)
 {
-    cereal::JSONOutputArchive archive(os);
-    archive(data);
+    if(format == scene_format_t::Json)
+    {
+        cereal::JSONOutputArchive archive(os);
+        archive(data);
+        return;
+    }
+    std::vector<encoded_section_t> sections;
+    sections.push_back(encode_section(scene_data_section, source_hash, [&data](std::ostream &section_os) {
+        cereal::BinaryOutputArchive archive(section_os);
+        archive(data);
+    }));
+    write_bundle_container(os, sections, bundle_schema_scope_t::version());
 }
 
-std::optional<scene_data_t> load_scene_data(std::istream &is)
+std::optional<scene_data_t> load_scene_data(std::istream &is, const scene_model_path_fn_t &model_path_fn)
 {
     try
     {
+        auto base = is.tellg();
+        uint16_t schema_version = 0;
+        auto toc = read_bundle_toc(is, &schema_version);
+
+        if(!toc) { return read_scene_json(is, model_path_fn); }
+        auto it = std::ranges::find(*toc, scene_data_section, &section_entry_t::type);
+        if(it == toc->end()) { throw std::runtime_error("load_scene_data: missing scene-section"); }
+
+        bundle_schema_scope_t schema_scope(container_schema_version(schema_version));
+        auto data = decode_section(*it, read_section(is, base, *it));
+        memory_streambuf streambuf(data.data(), data.size());
+        std::istream section_is(&streambuf);
         scene_data_t scene_data;
-        cereal::JSONInputArchive archive(is);
+        cereal::BinaryInputArchive archive(section_is);
         archive(scene_data);
+
+        if(model_path_fn)
+        {
+            for(const auto &[mesh_id, path]: scene_data.model_paths) { model_path_fn(mesh_id, path); }
+        }
         return scene_data;
     } catch(const std::exception &e)
     {
@@ -148,12 +675,109 @@ std::optional<scene_data_t> load_scene_data(std::istream &is)
     }
 }
 
-std::string model_bundle_filename(const std::filesystem::path &model_path,
+std::filesystem::path scene_binary_path(const std::filesystem::path &scene_path)
+{
+    auto ret = scene_path;
+    ret.replace_extension(scene_binary_suffix);
+    return ret;
+}
+
+//! xxh64 of a file's content, nothing if it can't be read
+static std::optional<uint64_t> file_hash(const std::filesystem::path &path)
+{
+    std::error_code ec;
+    if(!std::filesystem::is_regular_file(path, ec)) { return {}; }
+    if(!std::filesystem::file_size(path, ec) && !ec) { return xxh64(nullptr, 0); }
+    auto mapped = mapped_file::open(path);
+    if(!mapped) { return {}; }
+    return xxh64(mapped->data(), mapped->size());
+}
+
+//! source-hash recorded in a binary scene (0: unknown), nothing if it is not a binary scene
+static std::optional<uint64_t> scene_source_hash(const std::filesystem::path &binary_path)
+{
+    try
+    {
+        std::ifstream ifs(binary_path, std::ios_base::in | std::ios_base::binary);
+        auto toc = ifs.is_open() ? read_bundle_toc(ifs) : std::nullopt;
+        if(!toc) { return {}; }
+        auto it = std::ranges::find(*toc, scene_data_section, &section_entry_t::type);
+        if(it == toc->end()) { return {}; }
+        return it->key;
+    } catch(const std::exception &) { return {}; }
+}
+
+std::optional<scene_data_t> load_scene_file(const std::filesystem::path &path,
+                                            const scene_model_path_fn_t &model_path_fn)
+{
+    auto binary_path = scene_binary_path(path);
+    std::error_code ec;
+
+    if(binary_path != path && std::filesystem::exists(binary_path, ec))
+    {
+        // without a json, the binary is all there is
+        auto json_hash = file_hash(path);
+        if(!json_hash || scene_source_hash(binary_path) == json_hash)
+        {
+            std::ifstream ifs(binary_path, std::ios_base::in | std::ios_base::binary);
+            if(auto ret = load_scene_data(ifs, model_path_fn))
+            {
+                spdlog::debug("loaded binary scene '{}'", binary_path.string());
+                return ret;
+            }
+            if(!json_hash) { return {}; }
+            spdlog::warn("could not load binary scene '{}', loading '{}'", binary_path.string(), path.string());
+        }
+        else { spdlog::warn("binary scene '{}' is outdated, loading '{}'", binary_path.string(), path.string()); }
+    }
+
+    std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
+    if(!ifs.is_open()) { return {}; }
+    return load_scene_data(ifs, model_path_fn);
+}
+
+bool convert_scene_file(const std::filesystem::path &json_path, const std::filesystem::path &binary_path)
+{
+    // always parsed from json, never from an existing binary. the hashed bytes are the parsed ones
+    auto mapped = mapped_file::open(json_path);
+    if(!mapped)
+    {
+        spdlog::error("could not open scene '{}'", json_path.string());
+        return false;
+    }
+    memory_streambuf streambuf(mapped->data(), mapped->size());
+    std::istream is(&streambuf);
+    auto scene_data = load_scene_data(is);
+    if(!scene_data) { return false; }
+    const uint64_t source_hash = xxh64(mapped->data(), mapped->size());
+
+    auto out_path = binary_path.empty() ? scene_binary_path(json_path) : binary_path;
+    auto tmp_path = temp_file_path(out_path);
+    try
+    {
+        {
+            std::ofstream ofs(tmp_path, std::ios_base::out | std::ios_base::binary);
+            ofs.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+            save_scene_data(ofs, *scene_data, scene_format_t::Binary, source_hash);
+        }
+        std::filesystem::rename(tmp_path, out_path);
+        return true;
+    } catch(const std::exception &e)
+    {
+        spdlog::error("could not write binary scene '{}': {}", out_path.string(), e.what());
+        std::error_code ec;
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+}
+
+std::string model_bundle_filename(const std::filesystem::path &model_path, uint64_t content_hash,
                                   const vierkant::mesh_buffer_params_t &mesh_buffer_params, bool compress_textures,
                                   const std::optional<vierkant::model::omm_gen_params_t> &omm_params)
 {
     size_t hash_val = std::hash<std::string>()(model_path.filename().string());
-    vierkant::hash_combine(hash_val, bundle_schema_version);
+    vierkant::hash_combine(hash_val, content_hash);
+    vierkant::hash_combine(hash_val, bundle_cache_version);
     vierkant::hash_combine(hash_val, mesh_buffer_params);
     vierkant::hash_combine(hash_val, compress_textures);
 
@@ -168,11 +792,40 @@ std::string model_bundle_filename(const std::filesystem::path &model_path,
     return std::format("{}_{}.{}", model_path.filename().string(), hash_val, bundle_file_suffix);
 }
 
+//! number of bytes of a texture, source-images count uncompressed
+static uint64_t texture_num_bytes(const texture_map_t::mapped_type &texture)
+{
+    if(const auto *compressed = std::get_if<vierkant::bcn::compress_result_t>(&texture))
+    {
+        uint64_t ret = 0;
+        for(const auto &level: compressed->levels) { ret += level.size() * sizeof(level[0]); }
+        return ret;
+    }
+    if(const auto *img_ptr = std::get_if<crocore::ImagePtr>(&texture))
+    {
+        if(const auto *img = dynamic_cast<const crocore::Image_<uint8_t> *>(img_ptr->get()))
+        {
+            return static_cast<uint64_t>(img->width()) * img->height() * img->num_components();
+        }
+    }
+    return 0;
+}
+
+static uint64_t texture_num_bytes(const texture_map_t &textures)
+{
+    uint64_t ret = 0;
+    for(const auto &[id, texture]: textures) { ret += texture_num_bytes(texture); }
+    return ret;
+}
+
 std::optional<vierkant::model::model_assets_t> create_model_bundle(const std::filesystem::path &model_path,
-                                                                   const bundle_params_t &params)
+                                                                   const bundle_params_t &params,
+                                                                   bake_stats_t *stats)
 {
-    spdlog::stopwatch sw;
+    bake_stats_t bake_stats;
+    spdlog::stopwatch sw, stage_sw;
     auto model_assets = vierkant::model::load_model(model_path, params.pool, params.id_seed);
+    bake_stats.load_seconds = stage_sw.elapsed().count();
 
     if(!model_assets)
     {
@@ -186,51 +839,164 @@ std::optional<vierkant::model::model_assets_t> create_model_bundle(const std::fi
                   params.compress_textures);
 
     // run compression of geometries, creation of meshlets, lods, etc.
+    stage_sw.reset();
     model_assets->geometry_data = vierkant::create_mesh_buffers(
             std::get<std::vector<vierkant::Mesh::entry_create_info_t>>(model_assets->geometry_data),
             params.mesh_buffer_params);
+    bake_stats.mesh_buffers_seconds = stage_sw.elapsed().count();
+
+    // merge repeated geometries, materials and samplers (e.g. CAD-exports with many identical parts)
+    stage_sw.reset();
+    bake_stats.dedup = deduplicate_model_assets(*model_assets);
+    bake_stats.dedup_seconds = stage_sw.elapsed().count();
+    spdlog::debug("deduplicated '{}' - geometries: {} - materials: {} - samplers: {} - saved: {} bytes",
+                  model_path.string(), bake_stats.dedup.num_geometries, bake_stats.dedup.num_materials,
+                  bake_stats.dedup.num_samplers, bake_stats.dedup.num_bytes);
 
     // bake opacity-micromaps now: the packed bundle AND CPU alpha coexist only here, before
     // the block-compression below destroys CPU alpha. baked data is cached into the bundle.
     if(params.omm_params)
     {
+        stage_sw.reset();
         const auto &bundle = std::get<vierkant::mesh_buffer_bundle_t>(model_assets->geometry_data);
         model_assets->omm_data = vierkant::model::generate_omm_data(*model_assets, bundle, *params.omm_params);
+        bake_stats.omm_seconds = stage_sw.elapsed().count();
         spdlog::debug("baked opacity-micromaps for '{}': {} entry(ies)", model_path.string(),
                       model_assets->omm_data.size());
     }
 
+    // content-derived texture-ids. after OMM-baking, which still requires the source-images
+    std::unordered_set<texture_store::texture_id_t> content_ids;
+    if(params.texture_store)
+    {
+        stage_sw.reset();
+        auto ids = texture_store::assign_content_ids(*model_assets, params.compress_textures, params.pool);
+        content_ids.insert(ids.begin(), ids.end());
+
+        // stored textures are loaded instead of compressed again
+        for(auto &[id, texture]: model_assets->textures)
+        {
+            if(!content_ids.contains(id) || !params.texture_store->contains(id)) { continue; }
+            if(auto stored = params.texture_store->load(id, params.pool))
+            {
+                texture = std::move(*stored);
+                ++bake_stats.num_stored_textures;
+            }
+        }
+        bake_stats.texture_store_seconds = stage_sw.elapsed().count();
+        spdlog::debug("'{}': {}/{} texture(s) from store", model_path.string(), bake_stats.num_stored_textures,
+                      model_assets->textures.size());
+    }
+    bake_stats.num_textures = model_assets->textures.size();
+    bake_stats.texture_bytes = texture_num_bytes(model_assets->textures);
+
     // run in-place block-compression on all textures, store compressed textures in bundle
-    if(params.compress_textures) { vierkant::model::compress_textures(*model_assets, params.pool); }
+    if(params.compress_textures)
+    {
+        stage_sw.reset();
+        vierkant::model::compress_textures(*model_assets, params.pool);
+        bake_stats.compress_textures_seconds = stage_sw.elapsed().count();
+    }
+    bake_stats.compressed_texture_bytes = texture_num_bytes(model_assets->textures);
+
+    if(params.texture_store)
+    {
+        stage_sw.reset();
+        std::vector<const texture_map_t::value_type *> textures;
+        for(const auto &item: model_assets->textures)
+        {
+            // textures without content-id (e.g. non 8-bit) stay in the bundle
+            if(content_ids.contains(item.first)) { textures.push_back(&item); }
+        }
+        parallel_for(
+                textures.size(),
+                [&](size_t i) { params.texture_store->store(textures[i]->first, textures[i]->second); },
+                params.pool);
+        bake_stats.texture_store_seconds += stage_sw.elapsed().count();
+    }
+
+    if(const auto *bundle = std::get_if<vierkant::mesh_buffer_bundle_t>(&model_assets->geometry_data))
+    {
+        bake_stats.num_entries = bundle->entries.size();
+        bake_stats.num_vertices = bundle->vertex_stride ? bundle->vertex_buffer.size() / bundle->vertex_stride : 0;
+        bake_stats.num_indices = bundle->index_buffer.size();
+        bake_stats.num_meshlets = bundle->meshlets.size();
+    }
+    bake_stats.total_seconds = sw.elapsed().count();
+    if(stats) { *stats = bake_stats; }
 
     spdlog::debug("asset-bundle '{}' done -> {}", model_path.string(), sw.elapsed());
     return model_assets;
 }
 
+std::filesystem::path bundle_entry_path(const std::filesystem::path &path, const std::filesystem::path &zip_archive)
+{
+    auto rel = path.lexically_relative(zip_archive.parent_path());
+    if(rel.empty() || *rel.begin() == "..") { return path.generic_string(); }
+    return rel.generic_string();
+}
+
+bool has_bundle_file(const std::filesystem::path &path, const std::optional<std::filesystem::path> &zip_archive)
+{
+    std::error_code ec;
+    if(std::filesystem::exists(path, ec)) { return true; }
+    return zip_archive && vierkant::ziparchive_pool::global().has_file(*zip_archive, bundle_entry_path(path, *zip_archive));
+}
+
 void save_bundle_file(const vierkant::model::model_assets_t &assets, const std::filesystem::path &path,
-                      const std::optional<std::filesystem::path> &zip_archive)
+                      const std::optional<std::filesystem::path> &zip_archive, texture_codec_t texture_codec,
+                      geometry_codec_t geometry_codec, save_stats_t *stats)
+{
+    // sections are compressed already
+    save_to_stream(path, zip_archive, std::nullopt,
+                   [&assets, texture_codec, geometry_codec, stats](std::ostream &os) {
+                       save(os, assets, nullptr, texture_codec, geometry_codec, stats);
+                   });
+}
+
+std::optional<uint32_t> load_bundle_schema_version(const std::filesystem::path &path,
+                                                   const std::optional<std::filesystem::path> &zip_archive)
 {
-    save_to_stream(path, zip_archive, [&assets](std::ostream &os) { save(os, assets); });
+    return load_from_stream<uint32_t>(path, zip_archive, [](std::istream &is) -> uint32_t {
+        uint16_t schema_version = 0;
+        read_bundle_toc(is, &schema_version);
+        return schema_version ? schema_version : unversioned_bundle_schema_version;
+    });
 }
 
 std::optional<vierkant::model::model_assets_t>
-load_model_bundle_file(const std::filesystem::path &path, const std::optional<std::filesystem::path> &zip_archive)
+load_model_bundle_file(const std::filesystem::path &path, const std::optional<std::filesystem::path> &zip_archive,
+                       bundle_section_mask_t sections, crocore::ThreadPoolClassic *pool, uint32_t max_texture_extent)
+{
+    return load_from_stream<vierkant::model::model_assets_t>(
+            path, zip_archive, [sections, pool, max_texture_extent](std::istream &is) {
+                return load_model_assets(is, sections, pool, max_texture_extent);
+            });
+}
+
+std::optional<size_t> load_texture_levels_file(const std::filesystem::path &path,
+                                               const std::optional<std::filesystem::path> &zip_archive,
+                                               texture_map_t &textures, uint32_t max_texture_extent,
+                                               crocore::ThreadPoolClassic *pool)
 {
-    return load_from_stream<vierkant::model::model_assets_t>(path, zip_archive,
-                                                             [](std::istream &is) { return load_model_assets(is); });
+    return load_from_stream<size_t>(path, zip_archive, [&textures, max_texture_extent, pool](std::istream &is) {
+        return load_texture_levels(is, textures, max_texture_extent, pool);
+    });
 }
 
 void save_bundle_file(const vierkant::material_data_t &material_data, const std::filesystem::path &path,
-                      const std::optional<std::filesystem::path> &zip_archive)
+                      const std::optional<std::filesystem::path> &zip_archive, texture_codec_t texture_codec)
 {
-    save_to_stream(path, zip_archive, [&material_data](std::ostream &os) { save(os, material_data); });
+    save_to_stream(path, zip_archive, vierkant::ziparchive::compression_level,
+                   [&material_data, texture_codec](std::ostream &os) { save(os, material_data, texture_codec); });
 }
 
 std::optional<vierkant::material_data_t>
-load_material_bundle_file(const std::filesystem::path &path, const std::optional<std::filesystem::path> &zip_archive)
+load_material_bundle_file(const std::filesystem::path &path, const std::optional<std::filesystem::path> &zip_archive,
+                          crocore::ThreadPoolClassic *pool)
 {
-    return load_from_stream<vierkant::material_data_t>(path, zip_archive,
-                                                       [](std::istream &is) { return load_material_data(is); });
+    return load_from_stream<vierkant::material_data_t>(
+            path, zip_archive, [pool](std::istream &is) { return load_material_data(is, pool); });
 }
 
 }// namespace vierkant_cereal
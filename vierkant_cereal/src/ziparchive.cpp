@@ -2,9 +2,19 @@
 // Created by crocdialer on 25.08.22.
 //
 
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <deque>
 #include <fstream>
 #include <functional>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
 #include <zip.h>
+#include <zlib.h>
+#include <zstd.h>
 
 #include <vierkant_cereal/ziparchive.h>
 
@@ -12,29 +22,434 @@ namespace vierkant
 {
 
 // maaaybe need those later
-//zip_int64_t zip_source_callback(void *_Nullable, void *_Nullable, zip_uint64_t, zip_source_cmd_t);
-//
 //void zip_progress_callback(zip_t *archive, double, void *_Nullable);
 //
 //int zip_cancel_callback(zip_t *archive, void *_Nullable);
 
-struct zipstreambuffer : public std::streambuf
+//! state for a zip_source serving a pre-compressed entry
+struct compressed_source_t
+{
+    std::shared_ptr<const ziparchive::compressed_entry_t> entry;
+    uint64_t offset = 0;
+    time_t mtime = 0;
+    zip_error_t error = {};
+};
+
+static zip_int64_t compressed_source_callback(void *userdata, void *data, zip_uint64_t len, zip_source_cmd_t cmd)
 {
-    zipstreambuffer(zip_t *_archive, const std::filesystem::path &file_path) : archive(_archive)
-    { zip_file = {zip_fopen(archive, file_path.string().c_str(), 0), zip_fclose}; }
+    auto *src = static_cast<compressed_source_t *>(userdata);
+
+    switch(cmd)
+    {
+        case ZIP_SOURCE_OPEN: src->offset = 0; return 0;
+
+        case ZIP_SOURCE_READ:
+        {
+            auto num_bytes = std::min<uint64_t>(len, src->entry->data.size() - src->offset);
+            std::memcpy(data, src->entry->data.data() + src->offset, num_bytes);
+            src->offset += num_bytes;
+            return static_cast<zip_int64_t>(num_bytes);
+        }
+
+        case ZIP_SOURCE_CLOSE: return 0;
+
+        case ZIP_SOURCE_STAT:
+        {
+            // reporting the compression-method makes libzip copy the data as-is
+            auto *st = static_cast<zip_stat_t *>(data);
+            zip_stat_init(st);
+            st->valid = ZIP_STAT_SIZE | ZIP_STAT_COMP_SIZE | ZIP_STAT_CRC | ZIP_STAT_COMP_METHOD | ZIP_STAT_MTIME;
+            st->size = src->entry->size;
+            st->comp_size = src->entry->data.size();
+            st->crc = src->entry->crc;
+            st->comp_method = src->entry->stored ? ZIP_CM_STORE : ZIP_CM_ZSTD;
+            st->mtime = src->mtime;
+            return sizeof(zip_stat_t);
+        }
+
+        case ZIP_SOURCE_ERROR: return zip_error_to_data(&src->error, data, len);
+
+        case ZIP_SOURCE_FREE: delete src; return 0;
+
+        case ZIP_SOURCE_SUPPORTS:
+            return zip_source_make_command_bitmap(ZIP_SOURCE_OPEN, ZIP_SOURCE_READ, ZIP_SOURCE_CLOSE, ZIP_SOURCE_STAT,
+                                                  ZIP_SOURCE_ERROR, ZIP_SOURCE_FREE, -1);
+
+        default: zip_error_set(&src->error, ZIP_ER_OPNOTSUPP, 0); return -1;
+    }
+}
+
+//! std::streambuf passing all output on chunk-wise to a sink, optionally compressed into a single zstd-frame
+class entry_streambuf : public std::streambuf
+{
+public:
+    using sink_fn_t = std::function<void(const uint8_t *data, size_t num_bytes)>;
+
+    //! without a compression-level, data is passed on uncompressed
+    entry_streambuf(sink_fn_t sink, std::optional<int> level)
+        : m_sink(std::move(sink)), m_cctx(nullptr, ZSTD_freeCCtx), m_in(ZSTD_CStreamInSize()),
+          m_out(ZSTD_CStreamOutSize())
+    {
+        if(level)
+        {
+            m_cctx.reset(ZSTD_createCCtx());
+            if(!m_cctx) { throw std::runtime_error("entry_streambuf: could not create compression-context"); }
+            ZSTD_CCtx_setParameter(m_cctx.get(), ZSTD_c_compressionLevel, *level);
+        }
+        setp(m_in.data(), m_in.data() + m_in.size());
+    }
+
+    //! pass on remaining input and end the zstd-frame
+    void finish() { compress(ZSTD_e_end); }
+
+    //! uncompressed size in bytes
+    [[nodiscard]] uint64_t size() const { return m_size; }
+
+    //! crc32 of the uncompressed data
+    [[nodiscard]] uint32_t crc() const { return m_crc; }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        compress(ZSTD_e_continue);
+        if(c != traits_type::eof())
+        {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+private:
+    void compress(ZSTD_EndDirective mode)
+    {
+        auto num_bytes = static_cast<size_t>(pptr() - pbase());
+        m_crc = crc32_z(m_crc, reinterpret_cast<const Bytef *>(pbase()), num_bytes);
+        m_size += num_bytes;
+
+        if(!m_cctx)
+        {
+            if(num_bytes) { m_sink(reinterpret_cast<const uint8_t *>(pbase()), num_bytes); }
+            setp(m_in.data(), m_in.data() + m_in.size());
+            return;
+        }
+        ZSTD_inBuffer input = {pbase(), num_bytes, 0};
+        bool done = false;
+
+        while(!done)
+        {
+            ZSTD_outBuffer output = {m_out.data(), m_out.size(), 0};
+            size_t remaining = ZSTD_compressStream2(m_cctx.get(), &output, &input, mode);
+            if(ZSTD_isError(remaining))
+            {
+                throw std::runtime_error(std::string("entry_streambuf: ") + ZSTD_getErrorName(remaining));
+            }
+            if(output.pos) { m_sink(m_out.data(), output.pos); }
+            done = mode == ZSTD_e_end ? remaining == 0 : input.pos == input.size;
+        }
+        setp(m_in.data(), m_in.data() + m_in.size());
+    }
+
+    sink_fn_t m_sink;
+    std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> m_cctx;
+    std::vector<char> m_in;
+    std::vector<uint8_t> m_out;
+    uint64_t m_size = 0;
+    uint32_t m_crc = 0;
+};
+
+//! state for a zip_source, compressing the output of a writer-function while libzip is consuming it
+struct stream_source_t
+{
+    //! upper bound for buffered, compressed chunks (ZSTD_CStreamOutSize() each, ~128kB)
+    static constexpr size_t max_chunks = 32;
+
+    std::function<void(std::ostream &)> writer;
+    std::optional<int> level = ziparchive::compression_level;
+    time_t mtime = 0;
+    zip_error_t error = {};
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<std::vector<uint8_t>> chunks;
+    size_t chunk_offset = 0;
+    bool done = false, cancelled = false;
+    std::string error_str;
+    uint64_t size = 0;
+    uint32_t crc = 0;
+    std::thread producer;
+
+    ~stream_source_t() { stop(); }
+
+    void start()
+    {
+        stop();
+        chunks.clear();
+        chunk_offset = 0;
+        done = cancelled = false;
+        error_str.clear();
+
+        producer = std::thread([this] {
+            std::string producer_error;
+            try
+            {
+                entry_streambuf streambuf([this](const uint8_t *data, size_t num_bytes) { push(data, num_bytes); },
+                                         level);
+                std::ostream os(&streambuf);
+                os.exceptions(std::ios_base::badbit);
+                writer(os);
+                os.flush();
+                streambuf.finish();
+
+                std::lock_guard lock(mutex);
+                size = streambuf.size();
+                crc = streambuf.crc();
+            } catch(std::exception &e) { producer_error = e.what(); }
+
+            std::lock_guard lock(mutex);
+            error_str = std::move(producer_error);
+            done = true;
+            cond.notify_all();
+        });
+    }
+
+    void stop()
+    {
+        if(!producer.joinable()) { return; }
+        {
+            std::lock_guard lock(mutex);
+            cancelled = true;
+            cond.notify_all();
+        }
+        producer.join();
+    }
+
+    //! producer-side, blocks while the consumer is behind
+    void push(const uint8_t *data, size_t num_bytes)
+    {
+        std::unique_lock lock(mutex);
+        cond.wait(lock, [this] { return cancelled || chunks.size() < max_chunks; });
+        if(cancelled) { throw std::runtime_error("stream_source: cancelled"); }
+        chunks.emplace_back(data, data + num_bytes);
+        cond.notify_all();
+    }
+
+    //! consumer-side, blocks until data is available or the producer is done
+    zip_int64_t read(uint8_t *data, uint64_t len)
+    {
+        std::unique_lock lock(mutex);
+        cond.wait(lock, [this] { return done || !chunks.empty(); });
+
+        if(!error_str.empty())
+        {
+            zip_error_set(&error, ZIP_ER_INTERNAL, 0);
+            return -1;
+        }
+        uint64_t num_bytes = 0;
+
+        while(num_bytes < len && !chunks.empty())
+        {
+            const auto &chunk = chunks.front();
+            auto n = std::min<uint64_t>(len - num_bytes, chunk.size() - chunk_offset);
+            std::memcpy(data + num_bytes, chunk.data() + chunk_offset, n);
+            num_bytes += n;
+            chunk_offset += n;
+
+            if(chunk_offset == chunk.size())
+            {
+                chunks.pop_front();
+                chunk_offset = 0;
+            }
+        }
+        cond.notify_all();
+        return static_cast<zip_int64_t>(num_bytes);
+    }
+};
+
+static zip_int64_t stream_source_callback(void *userdata, void *data, zip_uint64_t len, zip_source_cmd_t cmd)
+{
+    auto *src = static_cast<stream_source_t *>(userdata);
+
+    switch(cmd)
+    {
+        case ZIP_SOURCE_OPEN: src->start(); return 0;
+
+        case ZIP_SOURCE_READ: return src->read(static_cast<uint8_t *>(data), len);
+
+        case ZIP_SOURCE_CLOSE: src->stop(); return 0;
+
+        case ZIP_SOURCE_STAT:
+        {
+            // size and crc are only known after the producer is done, libzip re-stats and patches the local header
+            auto *st = static_cast<zip_stat_t *>(data);
+            zip_stat_init(st);
+            st->valid = ZIP_STAT_COMP_METHOD | ZIP_STAT_MTIME;
+            st->comp_method = src->level ? ZIP_CM_ZSTD : ZIP_CM_STORE;
+            st->mtime = src->mtime;
+
+            std::lock_guard lock(src->mutex);
+            if(src->done && src->error_str.empty())
+            {
+                st->valid |= ZIP_STAT_SIZE | ZIP_STAT_CRC;
+                st->size = src->size;
+                st->crc = src->crc;
+            }
+            return sizeof(zip_stat_t);
+        }
+
+        case ZIP_SOURCE_ERROR: return zip_error_to_data(&src->error, data, len);
+
+        case ZIP_SOURCE_FREE: delete src; return 0;
+
+        case ZIP_SOURCE_SUPPORTS:
+            return zip_source_make_command_bitmap(ZIP_SOURCE_OPEN, ZIP_SOURCE_READ, ZIP_SOURCE_CLOSE, ZIP_SOURCE_STAT,
+                                                  ZIP_SOURCE_ERROR, ZIP_SOURCE_FREE, -1);
+
+        default: zip_error_set(&src->error, ZIP_ER_OPNOTSUPP, 0); return -1;
+    }
+}
+
+//! buffered std::streambuf for a contained file, supporting seeks
+class zipstreambuffer : public std::streambuf
+{
+public:
+    zipstreambuffer(zip_t *archive, const std::filesystem::path &file_path, size_t buffer_size)
+        : m_archive(archive), m_buffer(std::max<size_t>(buffer_size, 1))
+    {
+        zip_stat_t entry_stat;
+        if(zip_stat(m_archive, file_path.generic_string().c_str(), 0, &entry_stat) == 0)
+        {
+            m_index = entry_stat.index;
+            if(entry_stat.valid & ZIP_STAT_SIZE) { m_size = entry_stat.size; }
+            m_stored = (entry_stat.valid & ZIP_STAT_COMP_METHOD) && entry_stat.comp_method == ZIP_CM_STORE;
+            open();
+        }
+        setg(m_buffer.data(), m_buffer.data(), m_buffer.data());
+    }
+
+protected:
+    int_type underflow() override
+    {
+        if(gptr() < egptr()) { return traits_type::to_int_type(*gptr()); }
+        auto num_bytes = read(m_buffer.data(), m_buffer.size());
+        setg(m_buffer.data(), m_buffer.data(), m_buffer.data() + num_bytes);
+        return num_bytes ? traits_type::to_int_type(*gptr()) : traits_type::eof();
+    }
 
     std::streamsize xsgetn(char *s, std::streamsize n) override
     {
-        if(zip_file) { return zip_fread(zip_file.get(), s, n); }
-        return EOF;
+        // drain buffered data first
+        std::streamsize num_bytes = std::min<std::streamsize>(n, egptr() - gptr());
+        std::memcpy(s, gptr(), num_bytes);
+        setg(eback(), gptr() + num_bytes, egptr());
+
+        // large reads bypass the buffer, small reads refill it
+        while(num_bytes < n)
+        {
+            auto remaining = static_cast<size_t>(n - num_bytes);
+            if(remaining >= m_buffer.size())
+            {
+                // the buffer no longer ends at the read-offset, seeks must not be served from it
+                setg(m_buffer.data(), m_buffer.data(), m_buffer.data());
+                auto num_read = read(s + num_bytes, remaining);
+                if(!num_read) { break; }
+                num_bytes += static_cast<std::streamsize>(num_read);
+            }
+            else
+            {
+                if(traits_type::eq_int_type(underflow(), traits_type::eof())) { break; }
+                auto num_copy = std::min<std::streamsize>(n - num_bytes, egptr() - gptr());
+                std::memcpy(s + num_bytes, gptr(), num_copy);
+                setg(eback(), gptr() + num_copy, egptr());
+                num_bytes += num_copy;
+            }
+        }
+        return num_bytes;
+    }
+
+    std::streamsize showmanyc() override
+    {
+        if(!m_file || position() >= m_size) { return -1; }
+        return static_cast<std::streamsize>(m_size - position());
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+    {
+        off_type base = 0;
+        if(dir == std::ios_base::cur) { base = static_cast<off_type>(position()); }
+        else if(dir == std::ios_base::end) { base = static_cast<off_type>(m_size); }
+        return seekpos(base + off, which);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+    {
+        auto target = static_cast<off_type>(pos);
+        if(!(which & std::ios_base::in) || !m_file || target < 0 || static_cast<uint64_t>(target) > m_size)
+        {
+            return pos_type(off_type(-1));
+        }
+        auto offset = static_cast<uint64_t>(target);
+
+        // target within the current buffer
+        auto buffer_start = m_offset - static_cast<uint64_t>(egptr() - eback());
+        if(offset >= buffer_start && offset <= m_offset)
+        {
+            setg(eback(), eback() + (offset - buffer_start), egptr());
+            return pos;
+        }
+        setg(m_buffer.data(), m_buffer.data(), m_buffer.data());
+
+        // stored entries seek directly, compressed entries are decoded up to the offset
+        if(m_stored && zip_fseek(m_file.get(), static_cast<zip_int64_t>(offset), SEEK_SET) == 0) { m_offset = offset; }
+        else
+        {
+            if(offset < m_offset && !open()) { return pos_type(off_type(-1)); }
+            while(m_offset < offset)
+            {
+                if(!read(m_buffer.data(), std::min<uint64_t>(m_buffer.size(), offset - m_offset)))
+                {
+                    return pos_type(off_type(-1));
+                }
+            }
+        }
+        return pos;
+    }
+
+private:
+    bool open()
+    {
+        m_file = {zip_fopen_index(m_archive, m_index, 0), zip_fclose};
+        m_offset = 0;
+        return m_file != nullptr;
+    }
+
+    size_t read(char *dst, size_t num_bytes)
+    {
+        if(!m_file) { return 0; }
+        auto num_read = zip_fread(m_file.get(), dst, num_bytes);
+        if(num_read <= 0) { return 0; }
+        m_offset += static_cast<uint64_t>(num_read);
+        return static_cast<size_t>(num_read);
     }
 
-    zip_t *archive = nullptr;
-    std::unique_ptr<struct zip_file, std::function<int(struct zip_file *)>> zip_file;
+    //! logical read-position
+    [[nodiscard]] uint64_t position() const { return m_offset - static_cast<uint64_t>(egptr() - gptr()); }
+
+    zip_t *m_archive = nullptr;
+    std::unique_ptr<zip_file_t, decltype(&zip_fclose)> m_file = {nullptr, zip_fclose};
+    zip_uint64_t m_index = 0;
+    uint64_t m_size = 0;
+    bool m_stored = false;
+
+    //! offset of the underlying zip_file (end of buffered data)
+    uint64_t m_offset = 0;
+
+    std::vector<char> m_buffer;
 };
 
-ziparchive::istream::istream(std::shared_ptr<zip_t> _archive, const std::filesystem::path &file_path)
-    : std::istream(new zipstreambuffer(_archive.get(), file_path)), m_archive(std::move(_archive))
+ziparchive::istream::istream(std::shared_ptr<zip_t> _archive, const std::filesystem::path &file_path,
+                             size_t buffer_size)
+    : std::istream(new zipstreambuffer(_archive.get(), file_path, buffer_size)), m_archive(std::move(_archive))
 {}
 
 ziparchive::istream::~istream() { delete rdbuf(); }
@@ -44,7 +459,7 @@ ziparchive::ziparchive(const std::filesystem::path &archive_path)
     int errorp;
 
     int flags = std::filesystem::exists(archive_path) ? 0 : ZIP_EXCL | ZIP_CREATE;
-    m_archive = {zip_open(archive_path.string().c_str(), flags, &errorp), zip_close};
+    m_archive = {zip_open(archive_path.string().c_str(), flags, &errorp), std::function<int(zip_t *)>(zip_close)};
 
     if(!m_archive)
     {
@@ -55,21 +470,161 @@ ziparchive::ziparchive(const std::filesystem::path &archive_path)
     }
 }
 
+ziparchive::compressed_entry_t ziparchive::compress(const void *data, size_t num_bytes, int level)
+{
+    compressed_entry_t ret;
+    ret.size = num_bytes;
+    ret.crc = crc32_z(crc32_z(0L, Z_NULL, 0), static_cast<const Bytef *>(data), num_bytes);
+    ret.data.resize(ZSTD_compressBound(num_bytes));
+    auto num_compressed = ZSTD_compress(ret.data.data(), ret.data.size(), data, num_bytes, level);
+    if(ZSTD_isError(num_compressed))
+    {
+        throw std::runtime_error(std::string("ziparchive::compress: ") + ZSTD_getErrorName(num_compressed));
+    }
+    ret.data.resize(num_compressed);
+    ret.data.shrink_to_fit();
+    return ret;
+}
+
+ziparchive::compressed_entry_t ziparchive::compress(const std::function<void(std::ostream &)> &writer,
+                                                    std::optional<int> level)
+{
+    compressed_entry_t ret;
+    ret.stored = !level;
+    entry_streambuf streambuf(
+            [&ret](const uint8_t *data, size_t num_bytes) { ret.data.insert(ret.data.end(), data, data + num_bytes); },
+            level);
+    std::ostream os(&streambuf);
+    os.exceptions(std::ios_base::badbit);
+    writer(os);
+    os.flush();
+    streambuf.finish();
+    ret.size = streambuf.size();
+    ret.crc = streambuf.crc();
+    ret.data.shrink_to_fit();
+    return ret;
+}
+
+//! add a zip_source_function to an archive, 'state' is owned by the source and freed via ZIP_SOURCE_FREE
+template<typename State>
+static void add_source_function(zip_t *archive, zip_source_callback callback, State *state,
+                                const std::filesystem::path &entry_path, bool stored)
+{
+    zip_error_init(&state->error);
+
+    zip_source_t *source = zip_source_function(archive, callback, state);
+    if(!source)
+    {
+        delete state;
+        throw std::runtime_error(std::string("ziparchive: could not create source: ") + zip_strerror(archive));
+    }
+
+    // on success the archive owns the source
+    auto index = zip_file_add(archive, entry_path.generic_string().c_str(), source, ZIP_FL_OVERWRITE);
+    if(index < 0)
+    {
+        zip_source_free(source);
+        throw std::runtime_error(std::string("ziparchive: could not add entry: ") + zip_strerror(archive));
+    }
+
+    // libzip would otherwise deflate uncompressed sources
+    if(stored) { zip_set_file_compression(archive, static_cast<zip_uint64_t>(index), ZIP_CM_STORE, 0); }
+}
+
+void ziparchive::add_compressed(std::shared_ptr<const compressed_entry_t> entry,
+                                const std::filesystem::path &entry_path)
+{
+    bool stored = entry->stored;
+    auto *state = new compressed_source_t{.entry = std::move(entry), .mtime = time(nullptr)};
+    add_source_function(m_archive.get(), compressed_source_callback, state, entry_path, stored);
+}
+
+void ziparchive::add_stream(std::function<void(std::ostream &)> writer, const std::filesystem::path &entry_path,
+                            std::optional<int> level)
+{
+    auto *state = new stream_source_t;
+    state->writer = std::move(writer);
+    state->level = level;
+    state->mtime = time(nullptr);
+    add_source_function(m_archive.get(), stream_source_callback, state, entry_path, !level);
+}
+
 void ziparchive::add_file(const std::filesystem::path &file_path, const std::filesystem::path &entry_path)
 {
     std::unique_ptr<zip_source_t, std::function<void(zip_source_t *)>> source;
     source = {zip_source_file(m_archive.get(), file_path.string().c_str(), 0, -1), zip_source_close};
     auto entry_name = (entry_path.empty() ? file_path : entry_path).generic_string();
     auto file_index = zip_file_add(m_archive.get(), entry_name.c_str(), source.get(), ZIP_FL_OVERWRITE);
-    constexpr uint32_t zstd_lvl = 10;// 1-22
-    zip_set_file_compression(m_archive.get(), file_index, ZIP_CM_ZSTD, zstd_lvl);
+    zip_set_file_compression(m_archive.get(), file_index, ZIP_CM_ZSTD, compression_level);
+}
+
+void ziparchive::commit()
+{
+    if(!m_archive) { return; }
+    if(m_archive.use_count() > 1) { throw std::logic_error("ziparchive::commit: archive has open streams"); }
+
+    // zip_close frees the archive on success, make sure it's not closed again by the shared_ptr
+    auto *archive = m_archive.get();
+    std::string error_str;
+    if(zip_close(archive) != 0)
+    {
+        error_str = zip_strerror(archive);
+        zip_discard(archive);
+    }
+    if(auto *deleter = std::get_deleter<std::function<int(zip_t *)>>(m_archive))
+    {
+        *deleter = [](zip_t *) { return 0; };
+    }
+    m_archive.reset();
+    m_sources.clear();
+
+    if(!error_str.empty()) { throw std::runtime_error("Failed to write archive: " + error_str); }
 }
 
 bool ziparchive::has_file(const std::filesystem::path &file_path) const
 { return m_archive && zip_name_locate(m_archive.get(), file_path.string().c_str(), 0) != -1; }
 
-ziparchive::istream ziparchive::open_file(const std::filesystem::path &file_path) const
-{ return {m_archive, file_path}; }
+size_t ziparchive::add_archive(const ziparchive &source)
+{
+    if(!m_archive || !source.m_archive) { return 0; }
+
+    // added sources read from 'source' until committed, also if adding fails midway
+    m_sources.push_back(source.m_archive);
+    auto *src = source.m_archive.get();
+    auto num_entries = zip_get_num_entries(src, 0);
+    size_t ret = 0;
+
+    for(zip_int64_t i = 0; i < num_entries; ++i)
+    {
+        auto index = static_cast<zip_uint64_t>(i);
+        const char *name = zip_get_name(src, index, 0);
+        if(!name || std::string_view(name).ends_with('/')) { continue; }
+
+        // raw copy, keeping the entry's compression-method and crc
+        zip_source_t *entry_source = zip_source_zip_file(m_archive.get(), src, index, ZIP_FL_COMPRESSED, 0, -1, nullptr);
+        if(!entry_source)
+        {
+            throw std::runtime_error(std::string("ziparchive: could not read entry: ") + zip_strerror(m_archive.get()));
+        }
+        if(zip_file_add(m_archive.get(), name, entry_source, ZIP_FL_OVERWRITE) < 0)
+        {
+            zip_source_free(entry_source);
+            throw std::runtime_error(std::string("ziparchive: could not add entry: ") + zip_strerror(m_archive.get()));
+        }
+        ++ret;
+    }
+    return ret;
+}
+
+bool ziparchive::remove_file(const std::filesystem::path &file_path)
+{
+    if(!m_archive) { return false; }
+    auto index = zip_name_locate(m_archive.get(), file_path.generic_string().c_str(), 0);
+    return index >= 0 && zip_delete(m_archive.get(), static_cast<zip_uint64_t>(index)) == 0;
+}
+
+ziparchive::istream ziparchive::open_file(const std::filesystem::path &file_path, size_t buffer_size) const
+{ return {m_archive, file_path, buffer_size}; }
 
 std::vector<std::filesystem::path> ziparchive::contents() const
 {
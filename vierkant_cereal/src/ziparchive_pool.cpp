@@ -0,0 +1,196 @@
+#include <vector>
+#include <zip.h>
+
+#include <vierkant_cereal/ziparchive_pool.h>
+
+namespace vierkant
+{
+
+struct ziparchive_pool::generation_t
+{
+    std::filesystem::path path;
+    std::filesystem::file_time_type mtime;
+    uintmax_t size = 0;
+    size_t max_idle_handles = 0;
+
+    //! shared central-directory index, built once per generation
+    std::shared_ptr<const index_t> index;
+
+    std::mutex mutex;
+    std::vector<zip_t *> idle_handles;
+
+    ~generation_t()
+    {
+        for(auto *handle: idle_handles) { zip_discard(handle); }
+    }
+};
+
+//! pool-key for an archive-path, avoiding filesystem-access
+static std::string archive_key(const std::filesystem::path &archive_path)
+{ return std::filesystem::absolute(archive_path).lexically_normal().generic_string(); }
+
+static zip_t *open_handle(const std::filesystem::path &archive_path, int *errorp)
+{ return zip_open(archive_path.string().c_str(), ZIP_RDONLY, errorp); }
+
+std::shared_ptr<zip_t> ziparchive_pool::acquire(const std::shared_ptr<generation_t> &generation)
+{
+    zip_t *handle = nullptr;
+    {
+        std::lock_guard lock(generation->mutex);
+        if(!generation->idle_handles.empty())
+        {
+            handle = generation->idle_handles.back();
+            generation->idle_handles.pop_back();
+        }
+    }
+
+    if(!handle)
+    {
+        int errorp = 0;
+        handle = open_handle(generation->path, &errorp);
+
+        if(!handle)
+        {
+            zip_error_t ziperror;
+            zip_error_init_with_code(&ziperror, errorp);
+            throw std::runtime_error("Failed to open archive: " + generation->path.string() + ": " +
+                                     zip_error_strerror(&ziperror));
+        }
+    }
+
+    std::weak_ptr<generation_t> weak_generation = generation;
+    return {handle, [weak_generation](zip_t *released) {
+                if(auto generation = weak_generation.lock())
+                {
+                    std::lock_guard lock(generation->mutex);
+                    if(generation->idle_handles.size() < generation->max_idle_handles)
+                    {
+                        generation->idle_handles.push_back(released);
+                        return;
+                    }
+                }
+                zip_discard(released);
+            }};
+}
+
+ziparchive_pool &ziparchive_pool::global()
+{
+    static ziparchive_pool pool;
+    return pool;
+}
+
+ziparchive_pool::ziparchive_pool(size_t max_idle_handles) : m_max_idle_handles(max_idle_handles) {}
+
+std::shared_ptr<ziparchive_pool::generation_t> ziparchive_pool::generation(const std::filesystem::path &archive_path)
+{
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(archive_path, ec);
+    if(ec) { return nullptr; }
+    auto size = std::filesystem::file_size(archive_path, ec);
+    if(ec) { return nullptr; }
+
+    auto key = archive_key(archive_path);
+
+    // held while building a new generation, so concurrent first-time readers parse the directory only once
+    std::lock_guard lock(m_mutex);
+
+    auto &current = m_generations[key];
+    if(current && current->mtime == mtime && current->size == size) { return current; }
+
+    int errorp = 0;
+    zip_t *handle = open_handle(archive_path, &errorp);
+    if(!handle)
+    {
+        m_generations.erase(key);
+        return nullptr;
+    }
+
+    auto new_generation = std::make_shared<generation_t>();
+    new_generation->path = archive_path;
+    new_generation->mtime = mtime;
+    new_generation->size = size;
+    new_generation->max_idle_handles = m_max_idle_handles;
+
+    auto new_index = std::make_shared<index_t>();
+    auto num_entries = zip_get_num_entries(handle, 0);
+    new_index->reserve(num_entries);
+    zip_stat_t zip_stat;
+
+    for(zip_int64_t i = 0; i < num_entries; ++i)
+    {
+        if(zip_stat_index(handle, i, 0, &zip_stat) == 0 && (zip_stat.valid & ZIP_STAT_NAME))
+        {
+            (*new_index)[zip_stat.name] = {static_cast<uint64_t>(i), zip_stat.size, zip_stat.comp_size,
+                                       zip_stat.comp_method};
+        }
+    }
+    new_generation->index = std::move(new_index);
+
+    // the handle used for indexing is the first pooled one
+    new_generation->idle_handles.push_back(handle);
+
+    // replaced generations stay alive for readers still holding their handles
+    current = std::move(new_generation);
+    return current;
+}
+
+std::shared_ptr<const ziparchive_pool::index_t> ziparchive_pool::index(const std::filesystem::path &archive_path)
+{
+    auto gen = generation(archive_path);
+    return gen ? gen->index : nullptr;
+}
+
+bool ziparchive_pool::has_file(const std::filesystem::path &archive_path, const std::filesystem::path &entry_path)
+{
+    auto index_ptr = index(archive_path);
+    return index_ptr && index_ptr->contains(entry_path.generic_string());
+}
+
+ziparchive::istream ziparchive_pool::open_file(const std::filesystem::path &archive_path,
+                                               const std::filesystem::path &entry_path, size_t buffer_size)
+{
+    auto gen = generation(archive_path);
+    if(!gen) { throw std::runtime_error("Failed to open archive: " + archive_path.string()); }
+    return {acquire(gen), entry_path, buffer_size};
+}
+
+void ziparchive_pool::invalidate(const std::filesystem::path &archive_path)
+{
+    std::lock_guard lock(m_mutex);
+    m_generations.erase(archive_key(archive_path));
+}
+
+void ziparchive_pool::clear()
+{
+    std::lock_guard lock(m_mutex);
+    m_generations.clear();
+}
+
+ziparchive_pool::archive_locks_t &ziparchive_pool::locks(const std::filesystem::path &archive_path)
+{
+    std::lock_guard lock(m_locks_mutex);
+    auto &ret = m_locks[archive_key(archive_path)];
+    if(!ret) { ret = std::make_unique<archive_locks_t>(); }
+    return *ret;
+}
+
+void ziparchive_pool::modify(const std::filesystem::path &archive_path, const std::function<void(ziparchive &)> &fn)
+{
+    auto &archive_locks = locks(archive_path);
+    std::lock_guard write_lock(archive_locks.write_mutex);
+
+    ziparchive archive(archive_path);
+    fn(archive);
+
+    // without snapshot-reads, pooled handles would keep the archive from being replaced
+    std::unique_lock commit_lock(archive_locks.commit_mutex, std::defer_lock);
+    if(!snapshot_reads)
+    {
+        invalidate(archive_path);
+        commit_lock.lock();
+    }
+    archive.commit();
+    invalidate(archive_path);
+}
+
+}// namespace vierkant